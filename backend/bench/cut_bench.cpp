@@ -0,0 +1,241 @@
+// Clean cut benchmark: what a destination's output looks like around a take,
+// on the in-process mock backend with every source live and every destination
+// switched at once.
+//
+//   cut_bench [takes] [destinations] [ms between takes]
+//
+// Eight 1080p mock sources feed the destinations; each take is one salvo that
+// moves every destination to another source. The mock stamps every audio
+// sample with its source and gives audio the timestamp of the video frame it
+// belongs to, so each sender's log shows where its video and audio changed
+// source. For every cut from source A to source B, with A's last video frame
+// ending at E and B's first one starting at T:
+//
+//   stale      A video frames sent after B's first one
+//   late       A samples stamped at or after E (audio running past A's picture)
+//   early      B samples stamped before T (audio ahead of B's picture)
+//   missing    A samples short of E plus B samples short of T
+//   gap ms     T - E. Positive: the destination went that long without a new
+//              frame. Negative: A's last frame was still on air when B's
+//              first one started; sources are not genlocked, so up to a frame
+//              of overlap is expected and is not a glitch.
+//   frames     frame periods from the take to T: how long the take took to show
+//   counted    cuts the router counted, including each destination's first feed
+//
+// A clean cut has zero stale, late, early and missing, and no positive gap.
+// Linux only.
+//
+// Build with -DNDI_ROUTER_BUILD_BENCHMARKS=ON; does not need the NDI SDK.
+
+#include "logger.h"
+#include "mock_ndi_backend.h"
+#include "ndi_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSources = 8;
+constexpr int64_t kTicksPerSecond = 10000000;   // NDI timestamps count 100 ns units
+constexpr auto kSettle = std::chrono::milliseconds(500);
+
+void Require(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s failed\n", what);
+        std::exit(1);
+    }
+}
+
+int64_t NdiNow() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() / 100;
+}
+
+// Samples of an audio event stamped before `time`
+int64_t SamplesBefore(const MockFrameEvent& event, int64_t time) {
+    if (time <= event.timestamp) {
+        return 0;
+    }
+    int64_t samples = ((time - event.timestamp) * event.sample_rate + kTicksPerSecond - 1) / kTicksPerSecond;
+    return std::min<int64_t>(samples, event.samples);
+}
+
+int64_t AudioEnd(const MockFrameEvent& event) {
+    return event.timestamp + static_cast<int64_t>(event.samples) * kTicksPerSecond / event.sample_rate;
+}
+
+struct CutStats {
+    int cuts = 0;
+    uint64_t stale_frames = 0;
+    int64_t late_samples = 0;
+    int64_t early_samples = 0;
+    int64_t missing_samples = 0;
+    double min_gap_ms = 0.0;
+    double max_gap_ms = 0.0;
+    std::vector<double> take_frames;
+};
+
+// Finds the video cuts in one sender's log and measures the audio around each
+void AnalyzeSender(const std::vector<MockFrameEvent>& frames, const std::vector<int64_t>& take_times,
+                   int64_t period, int sample_rate, CutStats& stats) {
+    std::vector<size_t> cut_at;
+    int current = -1;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        const MockFrameEvent& event = frames[i];
+        if (event.audio || event.source_index < 0) {
+            continue;
+        }
+        if (current >= 0 && event.source_index != current) {
+            cut_at.push_back(i);
+        }
+        current = event.source_index;
+    }
+
+    for (size_t c = 0; c < cut_at.size(); ++c) {
+        size_t begin = c == 0 ? 0 : cut_at[c - 1];
+        size_t end = c + 1 < cut_at.size() ? cut_at[c + 1] : frames.size();
+        int to = frames[cut_at[c]].source_index;
+        int64_t start = frames[cut_at[c]].timestamp;
+
+        int from = -1;
+        int64_t from_end = 0;
+        for (size_t i = cut_at[c]; i-- > begin;) {
+            if (!frames[i].audio && frames[i].source_index >= 0) {
+                from = frames[i].source_index;
+                from_end = frames[i].timestamp + period;
+                break;
+            }
+        }
+        // B may also be the source before A, whose audio runs on for a moment
+        // after the previous cut; that tail is not B arriving early
+        int64_t from_start = from_end;
+        for (size_t i = begin; i < cut_at[c]; ++i) {
+            if (!frames[i].audio && frames[i].source_index == from) {
+                from_start = frames[i].timestamp;
+                break;
+            }
+        }
+        int64_t earlier_stint_end = c == 0 ? 0 : from_start + 2 * period;
+
+        int64_t from_audio_end = 0;
+        int64_t to_audio_start = 0;
+        bool to_audio = false;
+        for (size_t i = begin; i < end; ++i) {
+            const MockFrameEvent& event = frames[i];
+            if (!event.audio) {
+                if (i > cut_at[c] && event.source_index == from) {
+                    stats.stale_frames++;
+                }
+                continue;
+            }
+            if (event.source_index == from) {
+                stats.late_samples += event.samples - SamplesBefore(event, from_end);
+                from_audio_end = std::max(from_audio_end, AudioEnd(event));
+            } else if (event.source_index == to && event.timestamp >= earlier_stint_end) {
+                stats.early_samples += SamplesBefore(event, start);
+                if (!to_audio || event.timestamp < to_audio_start) {
+                    to_audio_start = event.timestamp;
+                    to_audio = true;
+                }
+            }
+        }
+        if (from_audio_end < from_end) {
+            stats.missing_samples += (from_end - from_audio_end) * sample_rate / kTicksPerSecond;
+        }
+        if (to_audio && to_audio_start > start) {
+            stats.missing_samples += (to_audio_start - start) * sample_rate / kTicksPerSecond;
+        }
+
+        double gap_ms = (start - from_end) / 1e4;
+        stats.min_gap_ms = stats.cuts == 0 ? gap_ms : std::min(stats.min_gap_ms, gap_ms);
+        stats.max_gap_ms = stats.cuts == 0 ? gap_ms : std::max(stats.max_gap_ms, gap_ms);
+        stats.cuts++;
+
+        auto take = std::upper_bound(take_times.begin(), take_times.end(), start);
+        if (take != take_times.begin()) {
+            stats.take_frames.push_back(static_cast<double>(start - *(take - 1)) / period);
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int takes = argc > 1 ? std::max(1, std::atoi(argv[1])) : 40;
+    int destinations = argc > 2 ? std::max(1, std::atoi(argv[2])) : 64;
+    int interval_ms = argc > 3 ? std::max(1, std::atoi(argv[3])) : 250;
+
+    // Routing events at Info would swamp the table
+    Logger::SetLevel(LogLevel::Warn);
+
+    MockSourceOptions options;
+    options.source_count = kSources;
+    options.log_frames = true;
+    auto backend_owner = std::make_unique<MockNDIBackend>(options);
+    MockNDIBackend* backend = backend_owner.get();
+    int64_t period = kTicksPerSecond * options.frame_rate_D / options.frame_rate_N;
+
+    NDIManager manager(std::move(backend_owner));
+    manager.SetIdleSlateRate(0.0);
+    Require(manager.SetMatrixSize(std::max(kSources, 16), destinations), "SetMatrixSize");
+    Require(manager.Initialize(), "Initialize");
+    for (int s = 1; s <= kSources; ++s) {
+        Require(manager.AssignSourceToSlot(s, backend->SourceName(s - 1), ""), "AssignSourceToSlot");
+    }
+    for (int d = 1; d <= destinations; ++d) {
+        Require(manager.CreateMatrixDestination("BENCH Output " + std::to_string(d), ""), "CreateMatrixDestination");
+        Require(manager.CreateMatrixRoute((d - 1) % kSources + 1, d), "CreateMatrixRoute");
+    }
+    std::this_thread::sleep_for(kSettle);
+
+    // Each take moves every destination on by a different number of sources
+    std::vector<int64_t> take_times;
+    std::vector<CrosspointResult> results;
+    int shift = 0;
+    for (int t = 1; t <= takes; ++t) {
+        shift += t % (kSources - 1) + 1;
+        std::vector<Crosspoint> salvo;
+        for (int d = 1; d <= destinations; ++d) {
+            salvo.push_back({(d - 1 + shift) % kSources + 1, d});
+        }
+        take_times.push_back(NdiNow());
+        Require(manager.ApplySalvo(salvo, results), "ApplySalvo");
+        std::this_thread::sleep_for(std::chrono::milliseconds(interval_ms));
+    }
+    std::this_thread::sleep_for(kSettle);
+
+    uint64_t cut_count = 0;
+    for (const auto& metrics : manager.GetDestinationMetrics()) {
+        cut_count += metrics.cuts;
+    }
+    auto records = backend->GetSenderRecords();
+    manager.Shutdown();
+
+    CutStats stats;
+    for (const auto& record : records) {
+        AnalyzeSender(record.frames, take_times, period, options.audio_sample_rate, stats);
+    }
+    std::sort(stats.take_frames.begin(), stats.take_frames.end());
+    double take_p50 = stats.take_frames.empty() ? 0.0 : stats.take_frames[stats.take_frames.size() / 2];
+    double take_max = stats.take_frames.empty() ? 0.0 : stats.take_frames.back();
+
+    std::printf("%d mock 1080p sources, %d destinations, %d salvo takes every %d ms\n\n",
+                kSources, destinations, takes, interval_ms);
+    std::printf("%6s %8s %7s %7s %7s %8s %11s %11s %11s %11s\n",
+                "cuts", "counted", "stale", "late", "early", "missing",
+                "gap min ms", "gap max ms", "frames p50", "frames max");
+    std::printf("%6d %8llu %7llu %7lld %7lld %8lld %11.2f %11.2f %11.2f %11.2f\n",
+                stats.cuts, static_cast<unsigned long long>(cut_count),
+                static_cast<unsigned long long>(stats.stale_frames),
+                static_cast<long long>(stats.late_samples), static_cast<long long>(stats.early_samples),
+                static_cast<long long>(stats.missing_samples),
+                stats.min_gap_ms, stats.max_gap_ms, take_p50, take_max);
+    Logger::Instance().Flush();
+    return 0;
+}
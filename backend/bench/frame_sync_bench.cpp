@@ -0,0 +1,170 @@
+// Frame synchronizer benchmark: output cadence of a free-running destination
+// and of a clocked one fed the same jittery sources, on the in-process mock
+// backend.
+//
+//   frame_sync_bench [seconds per source] [jitter ms]
+//
+// Two mock sources: one at 25 fps, one at 29.97 fps whose clock runs 200 ppm
+// fast. Every frame arrives up to the jitter late. Both destinations are
+// routed to the 25 fps source, then switched to the 29.97 fps one; the clocked
+// destination runs at 29.97 fps throughout. For each destination and source,
+// from what its sender was handed after the first second:
+//
+//   fps        video frames per second sent
+//   mean ms    mean interval between video sends
+//   sd ms      standard deviation of that interval (the output's jitter)
+//   worst ms   largest distance of an interval from the mean
+//   audio Hz   audio samples per channel sent per second of wall time
+//
+// Then the clocked destination's synchronizer counters over the whole run.
+// Linux only.
+//
+// Build with -DNDI_ROUTER_BUILD_BENCHMARKS=ON; does not need the NDI SDK.
+
+#include "logger.h"
+#include "mock_ndi_backend.h"
+#include "ndi_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSkewPpm = 200;
+constexpr int64_t kSettleNs = 1000000000;
+
+void Require(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s failed\n", what);
+        std::exit(1);
+    }
+}
+
+int64_t SteadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Cadence {
+    double fps = 0.0;
+    double mean_ms = 0.0;
+    double sd_ms = 0.0;
+    double worst_ms = 0.0;
+    double audio_hz = 0.0;
+};
+
+// What a sender was handed between two steady-clock times
+Cadence Measure(const std::vector<MockFrameEvent>& frames, int64_t from_ns, int64_t to_ns) {
+    std::vector<int64_t> video;
+    uint64_t samples = 0;
+    for (const auto& event : frames) {
+        if (event.sent_ns < from_ns || event.sent_ns >= to_ns) {
+            continue;
+        }
+        if (event.audio) {
+            samples += static_cast<uint64_t>(event.samples);
+        } else {
+            video.push_back(event.sent_ns);
+        }
+    }
+    Cadence cadence;
+    double seconds = (to_ns - from_ns) / 1e9;
+    cadence.fps = video.size() / seconds;
+    cadence.audio_hz = samples / seconds;
+    if (video.size() < 2) {
+        return cadence;
+    }
+    std::vector<double> intervals;
+    for (size_t i = 1; i < video.size(); ++i) {
+        intervals.push_back((video[i] - video[i - 1]) / 1e6);
+    }
+    double sum = 0.0;
+    for (double interval : intervals) sum += interval;
+    cadence.mean_ms = sum / intervals.size();
+    double squares = 0.0;
+    for (double interval : intervals) {
+        squares += (interval - cadence.mean_ms) * (interval - cadence.mean_ms);
+        cadence.worst_ms = std::max(cadence.worst_ms, std::fabs(interval - cadence.mean_ms));
+    }
+    cadence.sd_ms = std::sqrt(squares / intervals.size());
+    return cadence;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::max(2, std::atoi(argv[1])) : 5;
+    double jitter_ms = argc > 2 ? std::max(0.0, std::atof(argv[2])) : 8.0;
+
+    // Routing events at Info would swamp the table
+    Logger::SetLevel(LogLevel::Warn);
+
+    MockSourceOptions options;
+    options.source_count = 2;
+    options.log_frames = true;
+    options.jitter_us = static_cast<int>(jitter_ms * 1000.0);
+    options.source_timing.resize(2);
+    options.source_timing[0].frame_rate_N = 25;
+    options.source_timing[0].frame_rate_D = 1;
+    options.source_timing[1].frame_rate_N = 30000;
+    options.source_timing[1].frame_rate_D = 1001;
+    options.source_timing[1].clock_skew_ppm = kSkewPpm;
+    auto backend_owner = std::make_unique<MockNDIBackend>(options);
+    MockNDIBackend* backend = backend_owner.get();
+
+    NDIManager manager(std::move(backend_owner));
+    manager.SetIdleSlateRate(0.0);
+    Require(manager.Initialize(), "Initialize");
+    Require(manager.AssignSourceToSlot(1, backend->SourceName(0), "25 fps"), "AssignSourceToSlot");
+    Require(manager.AssignSourceToSlot(2, backend->SourceName(1), "29.97 fps"), "AssignSourceToSlot");
+    OutputClock clock;
+    clock.enabled = true;
+    Require(manager.CreateMatrixDestination("BENCH Free", ""), "CreateMatrixDestination");
+    Require(manager.CreateMatrixDestination("BENCH Clocked", "", clock), "CreateMatrixDestination");
+
+    const char* source_names[] = {"25 fps", "29.97 fps +200 ppm"};
+    int64_t phase_start[2];
+    int64_t phase_end[2];
+    for (int source = 1; source <= 2; ++source) {
+        std::vector<CrosspointResult> results;
+        Require(manager.ApplySalvo({{source, 1}, {source, 2}}, results), "ApplySalvo");
+        phase_start[source - 1] = SteadyNs() + kSettleNs;
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        phase_end[source - 1] = SteadyNs();
+    }
+
+    auto records = backend->GetSenderRecords();
+    DestinationMetrics sync{};
+    for (const auto& metrics : manager.GetDestinationMetrics()) {
+        if (metrics.frame_sync) {
+            sync = metrics;
+        }
+    }
+    manager.Shutdown();
+
+    std::printf("2 mock sources, up to %.1f ms arrival jitter, %d s per source; clocked output at %d/%d fps, %d Hz\n\n",
+                jitter_ms, seconds, clock.frame_rate_N, clock.frame_rate_D, clock.audio_sample_rate);
+    std::printf("%-8s %-20s %8s %9s %7s %9s %10s\n", "output", "source", "fps", "mean ms", "sd ms", "worst ms", "audio Hz");
+    for (const auto& record : records) {
+        const char* mode = record.name == "BENCH Clocked" ? "clocked" : "free";
+        for (int phase = 0; phase < 2; ++phase) {
+            Cadence c = Measure(record.frames, phase_start[phase], phase_end[phase]);
+            std::printf("%-8s %-20s %8.2f %9.2f %7.2f %9.2f %10.0f\n",
+                        mode, source_names[phase], c.fps, c.mean_ms, c.sd_ms, c.worst_ms, c.audio_hz);
+        }
+    }
+    std::printf("\nclocked: %llu repeated, %llu dropped, %llu late ticks, %llu samples of silence, %llu samples dropped\n",
+                static_cast<unsigned long long>(sync.repeated_frames),
+                static_cast<unsigned long long>(sync.dropped_frames),
+                static_cast<unsigned long long>(sync.late_ticks),
+                static_cast<unsigned long long>(sync.audio_fill_samples),
+                static_cast<unsigned long long>(sync.audio_dropped_samples));
+    Logger::Instance().Flush();
+    return 0;
+}
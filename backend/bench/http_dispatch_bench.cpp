@@ -0,0 +1,134 @@
+// HTTP dispatch microbenchmark: cost of mapping a parsed request to its
+// handler. Compares the legacy chain of request.find() checks (first match
+// wins, slot numbers re-parsed with std::stoi) with the HttpRouter trie used
+// by WebServer today, for endpoints early, late and parameterised in the table.
+//
+// Build with -DNDI_ROUTER_BUILD_BENCHMARKS=ON; does not need the NDI SDK.
+
+#include "http_parser.h"
+#include "http_router.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+struct Endpoint {
+    const char* method;
+    const char* pattern;   // Router pattern
+    const char* legacy;    // Substring the old chain searched for
+};
+
+// Same order as the former WebServer::ProcessRequest chain
+const Endpoint kEndpoints[] = {
+    {"GET", "/api/health", "GET /api/health"},
+    {"GET", "/api/sources", "GET /api/sources"},
+    {"GET", "/api/studio-monitors", "GET /api/studio-monitors"},
+    {"POST", "/api/studio-monitors/reset", "POST /api/studio-monitors/reset"},
+    {"GET", "/api/matrix/source-slots", "GET /api/matrix/source-slots"},
+    {"GET", "/api/matrix/destinations", "GET /api/matrix/destinations"},
+    {"GET", "/api/matrix/routes", "GET /api/matrix/routes"},
+    {"POST", "/api/matrix/source-slots/assign", "POST /api/matrix/source-slots/assign"},
+    {"DELETE", "/api/matrix/source-slots/{slot}", "DELETE /api/matrix/source-slots/"},
+    {"POST", "/api/matrix/destinations/{slot}/unassign", "POST /api/matrix/destinations/"},
+    {"POST", "/api/matrix/destinations", "POST /api/matrix/destinations"},
+    {"DELETE", "/api/matrix/destinations/{slot}", "DELETE /api/matrix/destinations/"},
+    {"POST", "/api/matrix/routes/multiple", "POST /api/matrix/routes/multiple"},
+    {"POST", "/api/matrix/routes", "POST /api/matrix/routes"},
+    {"DELETE", "/api/matrix/routes/source/{slot}", "DELETE /api/matrix/routes/source/"},
+    {"GET", "/api/matrix/routes/source/{slot}", "GET /api/matrix/routes/source/"},
+    {"DELETE", "/api/matrix/routes", "DELETE /api/matrix/routes"},
+    {"POST", "/api/studio-monitors/set-source", "POST /api/studio-monitors/set-source"},
+    {"GET", "/api/studio-monitors/current-source", "GET /api/studio-monitors/current-source"},
+    {"POST", "/api/preview/set-source", "POST /api/preview/set-source"},
+    {"GET", "/api/preview/current-source", "GET /api/preview/current-source"},
+    {"GET", "/api/preview/image", "GET /api/preview/image"},
+    {"POST", "/api/preview/clear", "POST /api/preview/clear"},
+    {"GET", "/api/routing/receive-mode", "GET /api/routing/receive-mode"},
+    {"POST", "/api/routing/receive-mode", "POST /api/routing/receive-mode"},
+    {"GET", "/api/routing/workers", "GET /api/routing/workers"},
+};
+constexpr int kEndpointCount = static_cast<int>(sizeof(kEndpoints) / sizeof(kEndpoints[0]));
+
+// Returns the matched endpoint index plus any parsed slot, or -1
+int LegacyDispatch(const HttpRequest& http_request) {
+    std::string request;
+    request.reserve(http_request.method.size() + http_request.path.size() + 2);
+    request.append(http_request.method).append(" ").append(http_request.path).append(" ");
+
+    for (int i = 0; i < kEndpointCount; ++i) {
+        const char* legacy = kEndpoints[i].legacy;
+        size_t position = request.find(legacy);
+        if (position == std::string::npos) continue;
+        size_t length = std::strlen(legacy);
+        if (legacy[length - 1] == '/') {
+            size_t start = position + length;
+            size_t end = request.find_first_of("/ ", start);
+            return i + std::stoi(request.substr(start, end - start));
+        }
+        return i;
+    }
+    return -1;
+}
+
+int RouterDispatch(const HttpRouter& router, const HttpRequest& request, RouteParams& params) {
+    const RouteHandler* handler = nullptr;
+    if (router.Find(request.method, request.path, handler, params) != HttpRouter::Result::Found) {
+        return -1;
+    }
+    return static_cast<int>(reinterpret_cast<uintptr_t>(handler) & 0xff) + params.Get("slot");
+}
+
+template <typename F>
+double NanosPerCall(F&& fn, int iterations) {
+    volatile int sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < iterations; ++i) {
+        sink = sink + fn();
+    }
+    auto elapsed = std::chrono::steady_clock::now() - start;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / iterations;
+}
+
+} // namespace
+
+int main() {
+    HttpRouter router;
+    for (const auto& endpoint : kEndpoints) {
+        router.Add(endpoint.method, endpoint.pattern, [](const HttpRequest&, const RouteParams&) {
+            return std::string();
+        });
+    }
+
+    struct Case {
+        const char* label;
+        const char* method;
+        const char* path;
+    };
+    const Case cases[] = {
+        {"first entry", "GET", "/api/health"},
+        {"last entry", "GET", "/api/routing/workers"},
+        {"slot parameter", "POST", "/api/matrix/destinations/12/unassign"},
+        {"not found", "GET", "/api/does/not/exist"},
+    };
+
+    const int iterations = 2000000;
+    std::printf("%d routes\n", static_cast<int>(router.route_count()));
+    std::printf("%-16s %-40s %12s %12s %10s\n", "case", "request", "legacy ns", "router ns", "speedup");
+    for (const auto& c : cases) {
+        HttpRequest request;
+        request.method = c.method;
+        request.path = c.path;
+        RouteParams params;
+
+        double legacy = NanosPerCall([&request] { return LegacyDispatch(request); }, iterations);
+        double routed = NanosPerCall([&] { return RouterDispatch(router, request, params); }, iterations);
+
+        std::string label = std::string(c.method) + " " + c.path;
+        std::printf("%-16s %-40s %12.1f %12.1f %9.1fx\n", c.label, label.c_str(), legacy, routed, legacy / routed);
+    }
+    return 0;
+}
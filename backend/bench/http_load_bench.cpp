@@ -0,0 +1,157 @@
+// HTTP load test for the control API: N concurrent clients hammer one endpoint
+// for a fixed time and report requests/second and latency percentiles.
+//
+//   http_load_bench [host] [port] [connections] [seconds] [path] [keepalive|close]
+//   http_load_bench 127.0.0.1 8080 32 10 /api/matrix/routes close
+//
+// Run it against a live router. keepalive (the default) reuses one connection
+// per client; close opens a new TCP connection for every request. Linux only.
+//
+// Build with -DNDI_ROUTER_BUILD_BENCHMARKS=ON; does not need the NDI SDK.
+
+#include <algorithm>
+#include <arpa/inet.h>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace {
+
+struct ClientResult {
+    std::vector<double> latencies_us;
+    uint64_t errors = 0;
+};
+
+int Connect(const sockaddr_in& address) {
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) return -1;
+    int no_delay = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+    if (connect(fd, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0) {
+        close(fd);
+        return -1;
+    }
+    return fd;
+}
+
+// Reads one response framed by Content-Length (or by close when absent)
+bool ReadResponse(int fd, std::string& response) {
+    response.clear();
+    char buffer[16384];
+    size_t expected = std::string::npos;
+    while (expected == std::string::npos || response.size() < expected) {
+        ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+        if (received <= 0) {
+            return expected == std::string::npos && !response.empty();
+        }
+        response.append(buffer, static_cast<size_t>(received));
+
+        size_t header_end = response.find("\r\n\r\n");
+        if (expected == std::string::npos && header_end != std::string::npos) {
+            const char* length = strcasestr(response.c_str(), "\r\nContent-Length:");
+            if (length && static_cast<size_t>(length - response.c_str()) < header_end) {
+                expected = header_end + 4 + std::strtoul(length + 17, nullptr, 10);
+            }
+        }
+    }
+    return true;
+}
+
+// One request/response round trip; false on any socket error or non-200 reply.
+// fd is reused across calls in keep-alive mode and reopened when needed.
+bool RoundTrip(const sockaddr_in& address, const std::string& request, bool keep_alive,
+               int& fd, std::string& response) {
+    if (fd < 0) {
+        fd = Connect(address);
+        if (fd < 0) return false;
+    }
+
+    bool ok = send(fd, request.data(), request.size(), MSG_NOSIGNAL) == static_cast<ssize_t>(request.size()) &&
+              ReadResponse(fd, response);
+    if (!ok || !keep_alive) {
+        close(fd);
+        fd = -1;
+    }
+    return ok && response.compare(0, 12, "HTTP/1.1 200") == 0;
+}
+
+double Percentile(const std::vector<double>& sorted, double p) {
+    if (sorted.empty()) return 0.0;
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    return sorted[index];
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    const char* host = argc > 1 ? argv[1] : "127.0.0.1";
+    int port = argc > 2 ? std::atoi(argv[2]) : 8080;
+    int connections = argc > 3 ? std::max(1, std::atoi(argv[3])) : 16;
+    int seconds = argc > 4 ? std::max(1, std::atoi(argv[4])) : 5;
+    std::string path = argc > 5 ? argv[5] : "/api/health";
+    bool keep_alive = argc > 6 ? std::strcmp(argv[6], "close") != 0 : true;
+
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_port = htons(static_cast<uint16_t>(port));
+    if (inet_pton(AF_INET, host, &address.sin_addr) != 1) {
+        std::fprintf(stderr, "Invalid IPv4 address: %s\n", host);
+        return 1;
+    }
+
+    std::string request = "GET " + path + " HTTP/1.1\r\nHost: " + host +
+                          (keep_alive ? "\r\n\r\n" : "\r\nConnection: close\r\n\r\n");
+    std::atomic<bool> stop(false);
+    std::vector<ClientResult> results(connections);
+    std::vector<std::thread> clients;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int c = 0; c < connections; ++c) {
+        clients.emplace_back([&, c] {
+            std::string response;
+            int fd = -1;
+            while (!stop.load(std::memory_order_relaxed)) {
+                auto begin = std::chrono::steady_clock::now();
+                bool ok = RoundTrip(address, request, keep_alive, fd, response);
+                auto end = std::chrono::steady_clock::now();
+                if (ok) {
+                    results[c].latencies_us.push_back(std::chrono::duration<double, std::micro>(end - begin).count());
+                } else {
+                    results[c].errors++;
+                }
+            }
+            if (fd >= 0) close(fd);
+        });
+    }
+
+    std::this_thread::sleep_for(std::chrono::seconds(seconds));
+    stop = true;
+    for (auto& client : clients) client.join();
+    double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::vector<double> latencies;
+    uint64_t errors = 0;
+    for (const auto& result : results) {
+        latencies.insert(latencies.end(), result.latencies_us.begin(), result.latencies_us.end());
+        errors += result.errors;
+    }
+    std::sort(latencies.begin(), latencies.end());
+
+    std::printf("GET %s, %d connections (%s), %.1f s\n", path.c_str(), connections,
+                keep_alive ? "keep-alive" : "new connection per request", elapsed);
+    std::printf("requests: %zu ok, %llu errors\n", latencies.size(), static_cast<unsigned long long>(errors));
+    std::printf("throughput: %.0f req/s\n", latencies.size() / elapsed);
+    std::printf("latency us: p50 %.0f  p90 %.0f  p99 %.0f  max %.0f\n",
+                Percentile(latencies, 0.50), Percentile(latencies, 0.90),
+                Percentile(latencies, 0.99), latencies.empty() ? 0.0 : latencies.back());
+    return errors > 0 && latencies.empty() ? 1 : 0;
+}
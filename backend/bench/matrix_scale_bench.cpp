@@ -0,0 +1,215 @@
+// Matrix scale benchmark: control-plane and routing-loop cost as the matrix
+// grows from 16x16 to 4096x4096 on the in-process mock backend.
+//
+//   matrix_scale_bench [seconds per routing run]
+//
+// Control plane (no capture running): every size gets N source slots and N
+// destinations, each routed. Reported per operation: creating a destination,
+// creating a route, re-taking a routed destination from another source at
+// full size, a salvo of 40 takes, and listing routes and the whole matrix
+// state per entry.
+//
+// Routing loop: four live mock sources fan out to N destinations between them
+// while the rest of the N x N crosspoints stay unrouted. Reported per send
+// (fan-out time per frame over destinations fed) and as a share of the frames
+// the sources produced that reached every destination.
+//
+// Build with -DNDI_ROUTER_BUILD_BENCHMARKS=ON; does not need the NDI SDK.
+
+#include "logger.h"
+#include "mock_ndi_backend.h"
+#include "ndi_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kLiveSources = 4;
+constexpr int kTakes = 2000;
+constexpr int kSalvoSize = 40;
+constexpr int kSalvos = 200;
+constexpr auto kWarmup = std::chrono::seconds(1);
+
+using Clock = std::chrono::steady_clock;
+
+double MicrosSince(Clock::time_point start, size_t operations) {
+    return std::chrono::duration<double, std::micro>(Clock::now() - start).count() / std::max<size_t>(operations, 1);
+}
+
+void Require(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s failed\n", what);
+        std::exit(1);
+    }
+}
+
+struct ControlResult {
+    double destination_us = 0.0;
+    double route_us = 0.0;
+    double take_us = 0.0;
+    double salvo_us = 0.0;
+    double list_routes_ns = 0.0;   // Per route
+    double state_ns = 0.0;         // Per destination
+};
+
+ControlResult RunControlPlane(int size) {
+    MockSourceOptions options;
+    options.source_count = 0;
+    NDIManager manager(std::make_unique<MockNDIBackend>(options));
+    Require(manager.SetMatrixSize(size, size), "SetMatrixSize");
+    manager.InitializeDefaultMatrix();
+
+    for (int s = 1; s <= size; ++s) {
+        Require(manager.AssignSourceToSlot(s, "BENCH (Source " + std::to_string(s) + ")", ""), "AssignSourceToSlot");
+    }
+
+    ControlResult result;
+    auto start = Clock::now();
+    for (int d = 1; d <= size; ++d) {
+        Require(manager.CreateMatrixDestination("BENCH Output " + std::to_string(d), ""), "CreateMatrixDestination");
+    }
+    result.destination_us = MicrosSince(start, size);
+
+    start = Clock::now();
+    for (int d = 1; d <= size; ++d) {
+        Require(manager.CreateMatrixRoute(d, d), "CreateMatrixRoute");
+    }
+    result.route_us = MicrosSince(start, size);
+
+    // Takes at full size: every destination already has a route to replace
+    uint64_t state = 12345;
+    auto next = [&state, size] {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return static_cast<int>((state >> 33) % static_cast<uint64_t>(size)) + 1;
+    };
+    start = Clock::now();
+    for (int i = 0; i < kTakes; ++i) {
+        manager.CreateMatrixRoute(next(), next());
+    }
+    result.take_us = MicrosSince(start, kTakes);
+
+    // Salvos of distinct destinations (consecutive, so they never repeat)
+    std::vector<std::vector<Crosspoint>> salvos(kSalvos);
+    for (auto& salvo : salvos) {
+        int first = next() - 1;
+        for (int i = 0; i < std::min(kSalvoSize, size); ++i) {
+            salvo.push_back({next(), (first + i) % size + 1});
+        }
+    }
+    std::vector<CrosspointResult> results;
+    start = Clock::now();
+    for (const auto& salvo : salvos) {
+        Require(manager.ApplySalvo(salvo, results), "ApplySalvo");
+    }
+    result.salvo_us = MicrosSince(start, kSalvos);
+
+    int repeats = std::max(1, 65536 / size);
+    start = Clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        Require(manager.GetMatrixRoutes().size() == static_cast<size_t>(size), "GetMatrixRoutes");
+    }
+    result.list_routes_ns = MicrosSince(start, static_cast<size_t>(repeats) * size) * 1000.0;
+
+    start = Clock::now();
+    for (int i = 0; i < repeats; ++i) {
+        Require(manager.GetMatrixState().destinations.size() == static_cast<size_t>(size), "GetMatrixState");
+    }
+    result.state_ns = MicrosSince(start, static_cast<size_t>(repeats) * size) * 1000.0;
+    return result;
+}
+
+struct LoopResult {
+    double send_ns = 0.0;
+    double delivered = 0.0;
+};
+
+LoopResult RunRoutingLoop(int size, std::chrono::seconds duration) {
+    MockSourceOptions options;
+    options.source_count = kLiveSources;
+    options.width = 640;
+    options.height = 360;
+    auto backend_owner = std::make_unique<MockNDIBackend>(options);
+    MockNDIBackend* backend = backend_owner.get();
+
+    LoopResult result;
+    NDIManager manager(std::move(backend_owner));
+    manager.SetIdleSlateRate(0.0);
+    Require(manager.SetMatrixSize(size, size), "SetMatrixSize");
+    Require(manager.Initialize(), "Initialize");
+
+    // Every slot carries a source, but only the live ones are routed
+    for (int s = 1; s <= size; ++s) {
+        std::string name = s <= kLiveSources ? backend->SourceName(s - 1) : "BENCH (Source " + std::to_string(s) + ")";
+        Require(manager.AssignSourceToSlot(s, name, ""), "AssignSourceToSlot");
+    }
+    for (int d = 1; d <= size; ++d) {
+        Require(manager.CreateMatrixDestination("BENCH Output " + std::to_string(d), ""), "CreateMatrixDestination");
+        Require(manager.CreateMatrixRoute((d - 1) % kLiveSources + 1, d), "CreateMatrixRoute");
+    }
+
+    std::this_thread::sleep_for(kWarmup);
+    auto sum_video = [backend] {
+        uint64_t frames = 0;
+        for (const auto& record : backend->GetSenderRecords()) frames += record.video_frames;
+        return frames;
+    };
+    auto sum_loop = [&manager] {
+        double loop_ms = 0.0, sends = 0.0;
+        for (const auto& worker : manager.GetRoutingWorkerStats()) {
+            loop_ms += worker.total_loop_ms;
+            sends += static_cast<double>(worker.frames_forwarded) * worker.destination_count;
+        }
+        return std::make_pair(loop_ms, sends);
+    };
+    uint64_t video_before = sum_video();
+    auto loop_before = sum_loop();
+    auto start = Clock::now();
+
+    std::this_thread::sleep_for(duration);
+
+    double wall = std::chrono::duration<double>(Clock::now() - start).count();
+    uint64_t video = sum_video() - video_before;
+    auto loop_after = sum_loop();
+    double sends = loop_after.second - loop_before.second;
+    double fps = static_cast<double>(options.frame_rate_N) / options.frame_rate_D;
+
+    result.send_ns = sends > 0 ? (loop_after.first - loop_before.first) * 1e6 / sends : 0.0;
+    result.delivered = video / (fps * wall * size);
+    manager.Shutdown();
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int seconds = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2;
+
+    // Routing events at Info would dominate the control-plane timings
+    Logger::SetLevel(LogLevel::Warn);
+
+    std::printf("control plane: N source slots x N destinations, every destination routed\n\n");
+    std::printf("%6s %10s %14s %10s %9s %12s %16s %14s\n",
+                "N", "crosspts", "create dest us", "route us", "take us", "salvo40 us", "list ns/route", "state ns/dest");
+    for (int size : {16, 64, 256, 1024, 4096}) {
+        ControlResult r = RunControlPlane(size);
+        std::printf("%6d %10lld %14.2f %10.2f %9.2f %12.2f %16.1f %14.1f\n",
+                    size, static_cast<long long>(size) * size, r.destination_us, r.route_us, r.take_us,
+                    r.salvo_us, r.list_routes_ns, r.state_ns);
+    }
+
+    std::printf("\nrouting loop: %d live sources fanned out to N destinations, %d s per run\n\n", kLiveSources, seconds);
+    std::printf("%6s %10s %12s %10s\n", "N", "crosspts", "ns/send", "delivered");
+    for (int size : {16, 256, 1024, 4096}) {
+        LoopResult r = RunRoutingLoop(size, std::chrono::seconds(seconds));
+        std::printf("%6d %10lld %12.1f %9.1f%%\n",
+                    size, static_cast<long long>(size) * size, r.send_ns, r.delivered * 100.0);
+    }
+    Logger::Instance().Flush();
+    return 0;
+}
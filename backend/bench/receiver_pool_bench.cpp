@@ -0,0 +1,147 @@
+// Take latency benchmark: how long after a take a destination shows the new
+// source, with and without the warm receiver pool, on the in-process mock
+// backend with a simulated NDI connection delay.
+//
+//   receiver_pool_bench [connect delay ms] [takes]
+//
+// Eight sources sit in slots 1-8 and one destination is switched between them
+// in a fixed pseudo-random order. Latency runs from the take call until the
+// destination's sender is handed a video frame from the new source. The cold
+// run has a budget of 0, so every take connects a receiver; the warm run uses
+// the default budget, so every assigned source is already connected. CPU is
+// user + system time of the whole process over the takes, in cores. Linux only.
+//
+// Build with -DNDI_ROUTER_BUILD_BENCHMARKS=ON; does not need the NDI SDK.
+
+#include "logger.h"
+#include "mock_ndi_backend.h"
+#include "ndi_manager.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <string>
+#include <sys/resource.h>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int kSources = 8;
+constexpr auto kPollInterval = std::chrono::microseconds(200);
+constexpr auto kTakeTimeout = std::chrono::seconds(5);
+
+using Clock = std::chrono::steady_clock;
+
+double CpuSeconds() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_utime.tv_sec + usage.ru_stime.tv_sec +
+           (usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) / 1e6;
+}
+
+void Require(bool ok, const char* what) {
+    if (!ok) {
+        std::fprintf(stderr, "%s failed\n", what);
+        std::exit(1);
+    }
+}
+
+struct Result {
+    double p50_ms = 0.0;
+    double max_ms = 0.0;
+    size_t warm_receivers = 0;
+    double cpu_cores = 0.0;
+    int timeouts = 0;
+};
+
+Result Run(size_t budget, int connect_delay_ms, int takes) {
+    MockSourceOptions options;
+    options.source_count = kSources;
+    options.width = 640;
+    options.height = 360;
+    options.connect_delay_ms = connect_delay_ms;
+    auto backend_owner = std::make_unique<MockNDIBackend>(options);
+    MockNDIBackend* backend = backend_owner.get();
+
+    Result result;
+    NDIManager manager(std::move(backend_owner));
+    manager.SetIdleSlateRate(0.0);
+    manager.SetWarmReceiverBudget(budget);
+    Require(manager.Initialize(), "Initialize");
+    for (int s = 1; s <= kSources; ++s) {
+        Require(manager.AssignSourceToSlot(s, backend->SourceName(s - 1), ""), "AssignSourceToSlot");
+    }
+    Require(manager.CreateMatrixDestination("BENCH Output", ""), "CreateMatrixDestination");
+
+    // Give the pool time to connect what it pre-warms
+    std::this_thread::sleep_for(std::chrono::milliseconds(connect_delay_ms) + std::chrono::milliseconds(200));
+
+    uint64_t state = 12345;
+    int current = 0;
+    std::vector<double> latencies;
+    double cpu_before = CpuSeconds();
+    auto run_start = Clock::now();
+    for (int i = 0; i < takes; ++i) {
+        int source_slot = current;
+        while (source_slot == current) {
+            state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+            source_slot = static_cast<int>((state >> 33) % kSources) + 1;
+        }
+        current = source_slot;
+
+        auto start = Clock::now();
+        Require(manager.CreateMatrixRoute(source_slot, 1), "CreateMatrixRoute");
+        bool switched = false;
+        while (!switched && Clock::now() - start < kTakeTimeout) {
+            auto records = backend->GetSenderRecords();
+            switched = !records.empty() && records[0].last_source_index == source_slot - 1;
+            if (!switched) {
+                std::this_thread::sleep_for(kPollInterval);
+            }
+        }
+        if (!switched) {
+            result.timeouts++;
+            continue;
+        }
+        latencies.push_back(std::chrono::duration<double, std::milli>(Clock::now() - start).count());
+    }
+    double wall = std::chrono::duration<double>(Clock::now() - run_start).count();
+    result.cpu_cores = (CpuSeconds() - cpu_before) / wall;
+    result.warm_receivers = manager.GetWarmReceiverCount();
+
+    if (!latencies.empty()) {
+        std::sort(latencies.begin(), latencies.end());
+        result.p50_ms = latencies[latencies.size() / 2];
+        result.max_ms = latencies.back();
+    }
+    manager.Shutdown();
+    return result;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    int connect_delay_ms = argc > 1 ? std::max(0, std::atoi(argv[1])) : 300;
+    int takes = argc > 2 ? std::max(1, std::atoi(argv[2])) : 20;
+
+    // Routing events at Info would swamp the table
+    Logger::SetLevel(LogLevel::Warn);
+
+    NDIManager defaults(std::make_unique<MockNDIBackend>());
+    size_t default_budget = defaults.GetWarmReceiverBudget();
+
+    std::printf("%d mock sources, one destination, %d takes, %d ms connection delay\n\n",
+                kSources, takes, connect_delay_ms);
+    std::printf("%6s %8s %10s %13s %13s %7s %9s\n",
+                "pool", "budget", "warm rcv", "take p50 ms", "take max ms", "cores", "timeouts");
+    for (size_t budget : {size_t(0), default_budget}) {
+        Result r = Run(budget, connect_delay_ms, takes);
+        std::printf("%6s %8zu %10zu %13.1f %13.1f %7.2f %9d\n",
+                    budget == 0 ? "cold" : "warm", budget, r.warm_receivers, r.p50_ms, r.max_ms,
+                    r.cpu_cores, r.timeouts);
+    }
+    Logger::Instance().Flush();
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Fan-out of Server-Sent Events to many subscribers without a thread each.
+// Publish() formats one frame, appends it to a bounded history and calls
+// every registered wake function; each I/O thread registers one and, when
+// woken, copies the frames its subscribers have not seen yet into their
+// output buffers with AppendSince().
+class EventBroadcaster {
+public:
+    explicit EventBroadcaster(size_t history_size = 256);
+
+    // Queues "event: <event>\ndata: <data>\n\n"; data may span lines
+    void Publish(const std::string& event, const std::string& data);
+    // Queues an SSE comment line; clients ignore it, proxies see traffic
+    void PublishComment(const std::string& comment);
+
+    // Sequence number of the newest frame; a new subscriber starts here
+    uint64_t LatestSequence() const;
+
+    // Appends every frame newer than last_sequence to out and advances it.
+    // Returns false if some of those frames already fell out of the history.
+    bool AppendSince(uint64_t& last_sequence, std::string& out) const;
+
+    // wake is called after every publish, from the publishing thread
+    int AddListener(std::function<void()> wake);
+    void RemoveListener(int listener_id);
+
+private:
+    void Push(std::string frame);
+
+    mutable std::mutex mutex_;
+    size_t history_size_;
+    std::deque<std::string> history_;   // Frames latest_sequence_ - size() + 1 .. latest_sequence_
+    uint64_t latest_sequence_ = 0;
+    std::vector<std::pair<int, std::function<void()>>> listeners_;
+    int next_listener_id_ = 1;
+};
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+#include <vector>
+#include "ndi_backend.h"
+
+class SharedFrame;
+
+// Output timing of a destination. Free-running (the default), every frame goes
+// out as its source delivers it, so the output inherits the source's cadence
+// and jitter. Clocked, a frame synchronizer re-times video and audio to a
+// fixed rate whatever the source does.
+struct OutputClock {
+    bool enabled = false;
+    int frame_rate_N = 30000;
+    int frame_rate_D = 1001;
+    int audio_sample_rate = 48000;
+};
+
+// Time-base corrector in front of one clocked destination, the router's
+// equivalent of NDIlib_framesync. Capture workers push what they would have
+// sent; the destination's output thread takes one video frame and one frame's
+// worth of audio per tick of the output clock.
+//
+// Video keeps only the newest frame, so a source faster than the clock loses
+// frames and a slower one has frames repeated. Audio is resampled to the
+// output rate into a FIFO kept about two ticks deep. The ratio leans on the
+// FIFO level, by at most 0.5%, so a source clock that drifts from ours is
+// absorbed without clicks. An underrun is filled with silence and the FIFO
+// refills before audio resumes; an overflow drops the oldest samples.
+//
+// Not thread-safe: every call except the counters is made under the
+// destination's send_mutex.
+class FrameSync {
+public:
+    explicit FrameSync(const OutputClock& clock);
+
+    const OutputClock& clock() const { return clock_; }
+    // When tick n is due, from the first tick
+    std::chrono::nanoseconds TickTime(uint64_t tick) const;
+
+    // Makes frame the one to show (taking a reference) and returns the one it
+    // replaces, for the caller to release once it has let go of the lock
+    SharedFrame* PushVideo(SharedFrame* frame, const VideoFrame& descriptor);
+    // The frame to show this tick, with the output rate filled into out; null
+    // if none is held. The caller adds its own reference to send it.
+    SharedFrame* VideoForTick(VideoFrame* out);
+    // Gives up the held frame if it came from owner (any owner if null); the
+    // caller releases it
+    SharedFrame* ReleaseVideo(const void* owner);
+
+    void PushAudio(const AudioFrame& frame);
+    // This tick's audio at the output rate; null until audio has been pushed
+    const AudioFrame* AudioForTick();
+
+    // Set by the owner to stop the output thread
+    std::thread thread;
+    std::atomic<bool> should_stop{false};
+
+    // Read without the lock
+    std::atomic<uint64_t> repeated_frames{0};       // Ticks that showed the previous frame again
+    std::atomic<uint64_t> dropped_frames{0};        // Frames replaced before any tick showed them
+    std::atomic<uint64_t> late_ticks{0};            // Ticks skipped because the output thread overslept
+    std::atomic<uint64_t> audio_fill_samples{0};    // Silence inserted on underrun, per channel
+    std::atomic<uint64_t> audio_dropped_samples{0}; // Dropped on overflow, per channel
+
+private:
+    size_t FifoLevel() const { return fifo_.empty() ? 0 : fifo_[0].size() - fifo_read_; }
+    int SamplesInTick(uint64_t tick) const;
+    void Resample(const AudioFrame& frame, double step);
+
+    const OutputClock clock_;
+
+    SharedFrame* video_ = nullptr;   // Held frame, one reference
+    VideoFrame video_descriptor_;
+    bool video_shown_ = false;       // The held frame has gone out at least once
+
+    int max_tick_samples_ = 0;
+    int channels_ = 0;                         // Output channels: the first source audio's; 0 until then
+    bool primed_ = false;                      // The FIFO has reached its target since the last underrun
+    std::vector<std::vector<float>> fifo_;     // Planar, at the output rate
+    size_t fifo_read_ = 0;                     // Consumed prefix of every channel
+    int input_rate_ = 0;                       // Resampler state, reset when the input format changes
+    int input_channels_ = 0;
+    double position_ = 0.0;                    // Next output sample, in input samples from the current frame's first
+    std::vector<float> last_input_;            // Last sample of the previous frame, per channel
+    uint64_t audio_tick_ = 0;
+    std::vector<float> audio_out_;             // Planar, one tick at most
+    AudioFrame audio_frame_;
+};
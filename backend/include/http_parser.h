@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <string_view>
+#include <vector>
+
+struct HttpHeader {
+    std::string_view name;
+    std::string_view value;
+};
+
+// A parsed request. Every view points into the connection's receive buffer and
+// is only valid until that buffer is compacted or appended to.
+struct HttpRequest {
+    std::string_view method;
+    std::string_view target;    // Path plus query string, as sent
+    std::string_view path;
+    std::string_view query;     // Without the leading '?'
+    std::string_view version;
+    std::vector<HttpHeader> headers;
+    std::string_view body;
+    bool keep_alive = true;
+
+    // Case-insensitive lookup; empty if the header is absent
+    std::string_view Header(std::string_view name) const;
+    void Clear();
+};
+
+// Incremental HTTP/1.1 request parser. Feed it the unconsumed part of a
+// connection's buffer each time more bytes arrive; it resumes the header scan
+// where it stopped and completes once exactly Content-Length body bytes are
+// present. Pipelined requests are parsed one at a time: advance the buffer by
+// consumed() and Reset() before the next.
+class HttpRequestParser {
+public:
+    enum class Result {
+        Incomplete,
+        Complete,
+        Error
+    };
+
+    HttpRequestParser(size_t max_header_bytes = 64 * 1024, size_t max_body_bytes = 1024 * 1024);
+
+    Result Parse(const char* data, size_t size, HttpRequest& request);
+
+    size_t consumed() const { return consumed_; }
+    int error_status() const { return error_status_; }   // HTTP status to answer an Error with
+    const char* error() const { return error_; }
+
+    void Reset();
+
+private:
+    Result Fail(int status, const char* message);
+    bool ParseHead(const char* data, HttpRequest& request);
+
+    size_t max_header_bytes_;
+    size_t max_body_bytes_;
+    size_t scan_offset_ = 0;      // Header terminator search resumes here
+    size_t header_length_ = 0;    // Including the blank line; 0 until the head is complete
+    size_t content_length_ = 0;
+    size_t consumed_ = 0;
+    int error_status_ = 0;
+    const char* error_ = "";
+};
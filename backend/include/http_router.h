@@ -0,0 +1,69 @@
+#pragma once
+
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "http_parser.h"
+
+// Integer path parameters captured while matching, e.g. {slot} in
+// /api/matrix/destinations/{slot}/unassign. Parsed once during dispatch.
+class RouteParams {
+public:
+    static constexpr size_t kMaxParams = 4;
+
+    int Get(std::string_view name) const;   // 0 if absent
+    bool valid() const { return valid_; }   // False if a segment was not an integer
+    std::string_view invalid_name() const { return invalid_name_; }
+
+private:
+    friend class HttpRouter;
+    void Clear();
+
+    std::string_view names_[kMaxParams];
+    int values_[kMaxParams] = {};
+    size_t count_ = 0;
+    bool valid_ = true;
+    std::string_view invalid_name_;
+};
+
+// Returns the complete HTTP response for a matched request
+using RouteHandler = std::function<std::string(const HttpRequest&, const RouteParams&)>;
+
+// Method + path trie. Each path segment is either a literal or a {name}
+// integer parameter; literals win over parameters at the same position.
+// Lookup walks the path once, so dispatch is O(path length) regardless of
+// how many routes are registered or in which order.
+class HttpRouter {
+public:
+    enum class Result {
+        Found,
+        NotFound,
+        MethodNotAllowed
+    };
+
+    HttpRouter();
+
+    void Add(std::string_view method, std::string_view pattern, RouteHandler handler);
+
+    Result Find(std::string_view method, std::string_view path,
+                const RouteHandler*& handler, RouteParams& params) const;
+
+    size_t route_count() const { return handlers_.size(); }
+
+private:
+    enum Method { kGet, kPost, kPut, kDelete, kPatch, kMethodCount };
+    static int MethodIndex(std::string_view method);
+
+    struct Node {
+        std::vector<std::pair<std::string, int>> literals;   // Segment -> child node
+        int param_child = -1;
+        std::string param_name;
+        int handlers[kMethodCount];
+    };
+
+    int AddNode();
+
+    std::vector<Node> nodes_;
+    std::vector<RouteHandler> handlers_;
+};
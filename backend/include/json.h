@@ -0,0 +1,77 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Streaming JSON builder over one reusable buffer. Commas between members
+// and elements are inserted automatically and strings are escaped per
+// RFC 8259. Clear() keeps the buffer, so a writer reused across responses
+// stops allocating once it has seen the largest payload.
+class JsonWriter {
+public:
+    explicit JsonWriter(size_t reserve = 0);
+
+    void Clear();
+    std::string_view view() const { return std::string_view(buffer_.data(), size_); }
+    std::string str() const { return std::string(buffer_.data(), size_); }
+
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+    JsonWriter& BeginArray();
+    JsonWriter& EndArray();
+
+    // Member name; the next value call supplies its value
+    JsonWriter& Key(std::string_view key);
+
+    JsonWriter& String(std::string_view value);
+    JsonWriter& StringOrNull(std::string_view value);   // null when empty
+    JsonWriter& Int(int64_t value);
+    JsonWriter& UInt(uint64_t value);
+    JsonWriter& Double(double value);                  // null when not finite
+    JsonWriter& Bool(bool value);
+    JsonWriter& Null();
+
+    // Appends value with JSON string escaping, without the surrounding quotes
+    static void AppendEscaped(std::string& out, std::string_view value);
+
+private:
+    // True if a comma must precede the next value; records that one follows
+    bool TakeSeparator();
+    // Grows the written region by bytes and returns where they go
+    char* Extend(size_t bytes);
+    void Write(bool comma, std::string_view text);
+    // "value" with escaping, followed by suffix
+    void WriteQuoted(bool comma, std::string_view value, std::string_view suffix);
+
+    std::vector<char> buffer_;   // Only the first size_ bytes are written
+    size_t size_ = 0;
+    uint64_t has_elements_ = 0;   // Bit n: container at depth n already has a member
+    int depth_ = 0;
+    bool after_key_ = false;
+};
+
+// Zero-copy reader for request bodies. Parse() validates the whole document
+// once; lookups then walk the top-level object's members in place and only
+// copy what they return. The parsed text must outlive the reader.
+class JsonReader {
+public:
+    // False unless json is a well-formed JSON object
+    bool Parse(std::string_view json);
+
+    bool Has(std::string_view key) const;
+    // False if the key is absent or its value has the wrong type
+    bool GetInt(std::string_view key, int& value) const;
+    bool GetString(std::string_view key, std::string& value) const;
+    bool GetIntArray(std::string_view key, std::vector<int>& values) const;
+    // Readers over each element of an array of objects; they read this reader's text
+    bool GetObjectArray(std::string_view key, std::vector<JsonReader>& objects) const;
+
+private:
+    // Raw text of the first member named key, or empty if there is none
+    std::string_view Find(std::string_view key) const;
+
+    std::string_view json_;
+    bool valid_ = false;
+};
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+// Log-linear latency histogram in the style of HdrHistogram: 32 sub-buckets
+// per power of two, so any recorded value is reported within about 3%, from
+// 1 ns up to kMaxValueNs (larger values land in the last bucket). Recording
+// is a few relaxed loads and stores with no allocation or locked
+// instructions, so each histogram must have a single writer (the capture
+// worker feeding its route); any thread may read it or request a reset.
+class LatencyHistogram {
+public:
+    static constexpr int kMaxValueBits = 36;
+    static constexpr uint64_t kMaxValueNs = uint64_t(1) << kMaxValueBits;   // About 68 s
+
+    struct Summary {
+        uint64_t count = 0;
+        double mean_ms = 0.0;
+        double p50_ms = 0.0;
+        double p99_ms = 0.0;
+        double p999_ms = 0.0;
+        double max_ms = 0.0;
+        double sum_ms = 0.0;
+    };
+
+    LatencyHistogram();
+
+    void Record(uint64_t value_ns);
+
+    // Asks the writer to zero the histogram before its next sample; until it
+    // has, readers see it empty. Nothing recorded before the reset is reported
+    // after it, including a sample being recorded as Reset is called.
+    void Reset();
+
+    Summary Summarize() const;
+
+    // Value below which fraction (0..1] of the samples fall, in nanoseconds;
+    // reported as the top of the bucket it lands in
+    uint64_t ValueAtQuantile(double fraction) const;
+
+private:
+    static constexpr int kSubBucketBits = 5;
+    static constexpr uint64_t kSubBucketCount = uint64_t(1) << kSubBucketBits;
+    static constexpr size_t kBucketCount = (kMaxValueBits - kSubBucketBits + 1) * kSubBucketCount;
+
+    static size_t BucketIndex(uint64_t value_ns);
+    static uint64_t BucketUpperBound(size_t index);
+    void Clear();                     // Writer only
+    bool ResetPending() const;
+
+    std::unique_ptr<std::atomic<uint64_t>[]> buckets_;
+    std::atomic<uint64_t> sum_ns_{0};
+    std::atomic<uint64_t> max_ns_{0};
+    // Resets are counted by readers and applied by the writer, so a reset
+    // never races the writer's load + store
+    std::atomic<uint64_t> resets_requested_{0};
+    std::atomic<uint64_t> resets_applied_{0};
+};
@@ -0,0 +1,186 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <type_traits>
+
+// Asynchronous logging. A LOG_* statement formats into a stack buffer and
+// pushes one fixed-size record into a lock-free ring; a background thread
+// drains the ring and writes whole batches, so routing and I/O threads never
+// block on console I/O. When the ring is full the record is dropped and
+// counted, never waited for.
+//
+//   LOG_INFO("Created route " << source_slot << " -> " << destination_slot);
+//   LOG_EVERY(LogLevel::Warn, 5000, "Worker limit reached");   // At most once per 5 s per call site
+//
+// LOG_DEBUG statements compile to nothing in release builds (NDEBUG) unless
+// NDI_ROUTER_DEBUG_LOG is defined, and are filtered at runtime otherwise.
+
+enum class LogLevel : uint8_t {
+    Debug,
+    Info,
+    Warn,
+    Error,
+    Off
+};
+
+class Logger {
+public:
+    static constexpr size_t kMaxMessageLength = 240;   // Longer messages are truncated
+
+    static Logger& Instance();
+
+    // One relaxed load; checked before any formatting happens
+    static bool Enabled(LogLevel level) {
+        return static_cast<uint8_t>(level) >= min_level_.load(std::memory_order_relaxed);
+    }
+    static void SetLevel(LogLevel level);
+    static LogLevel GetLevel();
+    static bool ParseLevel(std::string_view name, LogLevel& level);   // debug, info, warn, error, off
+
+    // Info and Debug go to info_out, Warn and Error to error_out (stdout and stderr by default)
+    void SetOutputs(FILE* info_out, FILE* error_out);
+
+    // Queues one line; returns false if the ring was full and it was dropped
+    bool Submit(LogLevel level, const char* file, int line, std::string_view text);
+
+    // Blocks until every line queued before the call has been written
+    void Flush();
+
+    uint64_t dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+private:
+    // Never destroyed, so objects torn down at exit can still log
+    Logger();
+    Logger(const Logger&) = delete;
+    Logger& operator=(const Logger&) = delete;
+
+    static constexpr size_t kCapacity = 1024;   // Records; power of two
+
+    struct Record {
+        std::atomic<uint64_t> sequence;
+        int64_t timestamp_us;   // system_clock
+        const char* file;
+        int line;
+        LogLevel level;
+        uint16_t length;
+        char text[kMaxMessageLength];
+    };
+
+    void WriterThread();
+    bool DrainOnce(std::string& info_batch, std::string& error_batch);
+
+    static std::atomic<uint8_t> min_level_;
+
+    std::unique_ptr<Record[]> records_;
+    std::atomic<uint64_t> enqueue_position_{0};
+    uint64_t dequeue_position_ = 0;              // Writer thread only
+    std::atomic<uint64_t> written_position_{0};  // Everything below has been written
+    std::atomic<uint64_t> dropped_{0};
+    uint64_t reported_dropped_ = 0;              // Writer thread only
+
+    std::atomic<FILE*> info_out_;
+    std::atomic<FILE*> error_out_;
+
+    std::mutex wake_mutex_;
+    std::condition_variable wake_;
+    std::condition_variable written_;
+    std::thread writer_thread_;
+};
+
+// One log line under construction; submitted when it goes out of scope.
+// Formatting never allocates: text that does not fit is cut off.
+class LogMessage {
+public:
+    LogMessage(LogLevel level, const char* file, int line) : level_(level), file_(file), line_(line) {}
+    ~LogMessage() { Logger::Instance().Submit(level_, file_, line_, std::string_view(text_, length_)); }
+
+    LogMessage& operator<<(std::string_view text);
+    LogMessage& operator<<(const char* text) { return *this << std::string_view(text ? text : "(null)"); }
+    LogMessage& operator<<(const std::string& text) { return *this << std::string_view(text); }
+    LogMessage& operator<<(char c) { return *this << std::string_view(&c, 1); }
+    LogMessage& operator<<(bool value) { return *this << (value ? "true" : "false"); }
+    LogMessage& operator<<(double value);
+    LogMessage& operator<<(const void* pointer);
+
+    template <typename T, typename = std::enable_if_t<std::is_integral_v<T>>>
+    LogMessage& operator<<(T value) {
+        if constexpr (std::is_signed_v<T>) {
+            return AppendSigned(static_cast<long long>(value));
+        } else {
+            return AppendUnsigned(static_cast<unsigned long long>(value));
+        }
+    }
+
+private:
+    LogMessage& AppendSigned(long long value);
+    LogMessage& AppendUnsigned(unsigned long long value);
+
+    LogLevel level_;
+    const char* file_;
+    int line_;
+    size_t length_ = 0;
+    char text_[Logger::kMaxMessageLength];
+};
+
+// Per-call-site limiter behind LOG_EVERY
+class LogRateLimiter {
+public:
+    explicit LogRateLimiter(std::chrono::milliseconds period) : period_ns_(period.count() * 1000000) {}
+
+    // True if the caller may log now; suppressed is set to the number of
+    // calls dropped since the last one that was allowed
+    bool Allow(uint32_t& suppressed);
+
+private:
+    const int64_t period_ns_;
+    std::atomic<int64_t> next_allowed_ns_{0};
+    std::atomic<uint32_t> suppressed_{0};
+};
+
+#if defined(NDEBUG) && !defined(NDI_ROUTER_DEBUG_LOG)
+#define NDI_ROUTER_LOG_DEBUG_COMPILED false
+#else
+#define NDI_ROUTER_LOG_DEBUG_COMPILED true
+#endif
+
+#define LOG_AT(level, message)                                   \
+    do {                                                         \
+        if (::Logger::Enabled(level)) {                          \
+            ::LogMessage log_message_(level, __FILE__, __LINE__); \
+            log_message_ << message;                             \
+        }                                                        \
+    } while (0)
+
+#define LOG_DEBUG(message)                                                              \
+    do {                                                                                \
+        if (NDI_ROUTER_LOG_DEBUG_COMPILED && ::Logger::Enabled(::LogLevel::Debug)) {    \
+            ::LogMessage log_message_(::LogLevel::Debug, __FILE__, __LINE__);           \
+            log_message_ << message;                                                    \
+        }                                                                               \
+    } while (0)
+#define LOG_INFO(message) LOG_AT(::LogLevel::Info, message)
+#define LOG_WARN(message) LOG_AT(::LogLevel::Warn, message)
+#define LOG_ERROR(message) LOG_AT(::LogLevel::Error, message)
+
+// Logs at most once per period_ms from this call site, noting how many were skipped
+#define LOG_EVERY(level, period_ms, message)                                                  \
+    do {                                                                                      \
+        if (::Logger::Enabled(level)) {                                                       \
+            static ::LogRateLimiter log_limiter_{std::chrono::milliseconds(period_ms)};       \
+            uint32_t log_suppressed_ = 0;                                                     \
+            if (log_limiter_.Allow(log_suppressed_)) {                                        \
+                ::LogMessage log_message_(level, __FILE__, __LINE__);                         \
+                log_message_ << message;                                                      \
+                if (log_suppressed_ > 0) log_message_ << " (" << log_suppressed_ << " more suppressed)"; \
+            }                                                                                 \
+        }                                                                                     \
+    } while (0)
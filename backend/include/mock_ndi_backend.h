@@ -0,0 +1,118 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "ndi_backend.h"
+
+// Per-source overrides of MockSourceOptions, by source index
+struct MockSourceTiming {
+    int frame_rate_N = 0;       // 0 = the options' rate
+    int frame_rate_D = 0;
+    int clock_skew_ppm = 0;     // The source's clock runs this much fast (negative: slow) against ours
+};
+
+struct MockSourceOptions {
+    int source_count = 4;
+    int width = 1920;
+    int height = 1080;
+    int frame_rate_N = 30000;
+    int frame_rate_D = 1001;
+    int audio_sample_rate = 48000;
+    int audio_channels = 2;     // 0 = video only
+    int queue_depth = 4;        // Frames a slow receiver buffers before the oldest are dropped
+    int connect_delay_ms = 0;   // Time a new receiver takes to deliver its first frame, like NDI connection setup
+    bool log_frames = false;    // Keep every frame each sender is handed in MockSenderRecord::frames
+    int jitter_us = 0;          // Each frame arrives up to this late, at random, like a congested network
+    std::vector<MockSourceTiming> source_timing;
+    std::string host_name = "MOCK";
+};
+
+// One frame a sender was handed, when MockSourceOptions::log_frames is set
+struct MockFrameEvent {
+    bool audio = false;
+    int source_index = -1;     // -1 for foreign frames (the slate)
+    int64_t timestamp = kNDITimestampUndefined;
+    int samples = 0;           // Audio samples per channel
+    int sample_rate = 0;
+    int64_t sent_ns = 0;       // Steady clock when the sender was handed it
+};
+
+// What one sender was handed, for checking and reporting
+struct MockSenderRecord {
+    std::string name;
+    uint64_t video_frames = 0;          // Sync and async
+    uint64_t async_video_frames = 0;
+    uint64_t audio_frames = 0;
+    uint64_t audio_samples = 0;         // Per channel
+    uint64_t source_switches = 0;       // Video frames whose source differed from the previous one
+    int last_xres = 0;
+    int last_yres = 0;
+    int last_source_index = -1;         // Mock source of the last video frame; -1 for foreign frames (the slate)
+    uint64_t last_frame_sequence = 0;
+    std::vector<MockFrameEvent> frames;  // In send order; empty unless log_frames is set
+};
+
+// In-process NDI stand-in. Announces source_count sources named
+// "<host_name> (Source N)" and delivers UYVY video at the configured size and
+// rate, each frame followed by one frame's worth of planar audio stamped with
+// the same time. Every video frame carries its source and sequence number in
+// its first bytes, and every audio sample is the source's number (index + 1),
+// so senders can tell what they were given; the rest of the picture is left
+// as allocated. Capture paces itself against the steady clock like a live
+// receiver: it blocks until the next frame is due and drops the oldest when
+// the caller falls more than queue_depth frames behind. Frames are stamped
+// with when they were due, however late jitter_us makes them arrive.
+class MockNDIBackend : public NDIBackend {
+public:
+    explicit MockNDIBackend(const MockSourceOptions& options = MockSourceOptions());
+    ~MockNDIBackend() override;
+
+    std::string SourceName(int index) const;   // index 0 is "Source 1"
+    const MockSourceOptions& options() const { return options_; }
+
+    // Records of the senders that currently exist, in creation order
+    std::vector<MockSenderRecord> GetSenderRecords() const;
+    // Video frames captured and not yet freed; zero once the router is idle
+    uint64_t outstanding_video_frames() const { return outstanding_video_.load(std::memory_order_relaxed); }
+    uint64_t dropped_video_frames() const { return dropped_video_.load(std::memory_order_relaxed); }
+
+    const char* name() const override { return "mock"; }
+    bool Initialize() override { return true; }
+    void Shutdown() override {}
+
+    NDIFinder CreateFinder() override;
+    void DestroyFinder(NDIFinder finder) override;
+    bool WaitForSources(NDIFinder finder, uint32_t timeout_ms) override;
+    std::vector<NDISource> GetCurrentSources(NDIFinder finder) override;
+
+    NDIReceiver CreateReceiver(const ReceiverSettings& settings) override;
+    void DestroyReceiver(NDIReceiver receiver) override;
+    CaptureResult Capture(NDIReceiver receiver, VideoFrame* video, AudioFrame* audio, uint32_t timeout_ms) override;
+    void FreeVideo(NDIReceiver receiver, const VideoFrame& frame) override;
+    void FreeAudio(NDIReceiver receiver, const AudioFrame& frame) override;
+    ReceiverPerformance GetPerformance(NDIReceiver receiver) override;
+
+    NDISender CreateSender(const std::string& name, bool clock_video, bool clock_audio) override;
+    void DestroySender(NDISender sender) override;
+    void SendVideo(NDISender sender, const VideoFrame& frame) override;
+    void SendVideoAsync(NDISender sender, const VideoFrame* frame) override;
+    void SendAudio(NDISender sender, const AudioFrame& frame) override;
+    int GetConnectionCount(NDISender sender, uint32_t timeout_ms) override;
+
+private:
+    struct Receiver;
+    struct Sender;
+
+    void RecordVideo(Sender& sender, const VideoFrame& frame, bool async);
+
+    const MockSourceOptions options_;
+    std::unordered_map<std::string, int> source_indexes_;   // Name -> index; immutable after construction
+    std::atomic<uint64_t> outstanding_video_{0};
+    std::atomic<uint64_t> dropped_video_{0};
+    mutable std::mutex senders_mutex_;
+    std::vector<Sender*> senders_;   // Guarded by senders_mutex_
+};
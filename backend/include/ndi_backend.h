@@ -0,0 +1,143 @@
+#pragma once
+
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <string>
+#include <vector>
+#include "source_table.h"
+
+// The find/receive/send operations the router needs from NDI, behind an
+// interface so the routing engine builds and runs without the SDK. The SDK
+// backend (ndi_sdk_backend.cpp) is the only code that includes the NDI
+// headers; MockNDIBackend synthesizes sources in-process for benchmarks.
+//
+// Frames mirror the SDK's v2 frame descriptors field for field, so the SDK
+// backend converts them with plain copies and no pixel data is touched.
+
+// Opaque handles; each backend defines what they point to
+struct NDIFinderInstance;
+struct NDIReceiverInstance;
+struct NDISenderInstance;
+using NDIFinder = NDIFinderInstance*;
+using NDIReceiver = NDIReceiverInstance*;
+using NDISender = NDISenderInstance*;
+
+// Same values as NDIlib_send_timecode_synthesize and NDIlib_recv_timestamp_undefined
+constexpr int64_t kNDITimecodeSynthesize = std::numeric_limits<int64_t>::max();
+constexpr int64_t kNDITimestampUndefined = std::numeric_limits<int64_t>::max();
+
+// Pixel layouts the router receives and forwards (what the two receive
+// color formats below can produce)
+enum class VideoFourCC : uint8_t {
+    UYVY,
+    UYVA,
+    BGRA,
+    BGRX,
+    RGBA,
+    RGBX,
+    Unsupported   // Any other layout; Capture() never returns one
+};
+
+enum class VideoFrameFormat : uint8_t {
+    Progressive,
+    Interleaved
+};
+
+struct VideoFrame {
+    int xres = 0;
+    int yres = 0;
+    VideoFourCC fourcc = VideoFourCC::UYVY;
+    int frame_rate_N = 0;
+    int frame_rate_D = 0;
+    float picture_aspect_ratio = 0.0f;
+    VideoFrameFormat frame_format = VideoFrameFormat::Progressive;
+    int64_t timecode = kNDITimecodeSynthesize;
+    uint8_t* data = nullptr;
+    int line_stride_in_bytes = 0;
+    const char* metadata = nullptr;
+    int64_t timestamp = kNDITimestampUndefined;   // 100 ns units since the Unix epoch
+};
+
+// Planar 32-bit float audio
+struct AudioFrame {
+    int sample_rate = 0;
+    int channels = 0;
+    int samples = 0;                 // Per channel
+    int64_t timecode = kNDITimecodeSynthesize;
+    float* data = nullptr;
+    int channel_stride_in_bytes = 0;
+    const char* metadata = nullptr;
+    int64_t timestamp = kNDITimestampUndefined;
+};
+
+enum class CaptureResult : uint8_t {
+    None,    // Timed out, or something other than video or audio arrived
+    Video,
+    Audio,
+    Error    // Lost the connection
+};
+
+// NDIlib_recv_color_format_UYVY_BGRA / BGRX_BGRA
+enum class ReceiveColorFormat : uint8_t {
+    UYVY_BGRA,
+    BGRX_BGRA
+};
+
+enum class ReceiveBandwidth : uint8_t {
+    Highest,
+    Lowest
+};
+
+struct ReceiverSettings {
+    std::string source_name;
+    std::string receiver_name;
+    ReceiveColorFormat color_format = ReceiveColorFormat::UYVY_BGRA;
+    ReceiveBandwidth bandwidth = ReceiveBandwidth::Highest;
+};
+
+struct ReceiverPerformance {
+    uint64_t dropped_video_frames = 0;
+    uint64_t dropped_audio_frames = 0;
+    uint32_t queued_video_frames = 0;
+    uint32_t queued_audio_frames = 0;
+};
+
+// All methods may be called from any thread; a receiver is only captured from
+// by one thread at a time, as with the SDK.
+class NDIBackend {
+public:
+    virtual ~NDIBackend() = default;
+
+    virtual const char* name() const = 0;
+    virtual bool Initialize() = 0;
+    virtual void Shutdown() = 0;   // After every handle has been destroyed
+
+    // Discovery
+    virtual NDIFinder CreateFinder() = 0;
+    virtual void DestroyFinder(NDIFinder finder) = 0;
+    // Blocks for up to timeout_ms; true if the announced list changed
+    virtual bool WaitForSources(NDIFinder finder, uint32_t timeout_ms) = 0;
+    virtual std::vector<NDISource> GetCurrentSources(NDIFinder finder) = 0;
+
+    // Receive. Captured frames stay valid until handed back with Free*().
+    virtual NDIReceiver CreateReceiver(const ReceiverSettings& settings) = 0;
+    virtual void DestroyReceiver(NDIReceiver receiver) = 0;
+    virtual CaptureResult Capture(NDIReceiver receiver, VideoFrame* video, AudioFrame* audio, uint32_t timeout_ms) = 0;
+    virtual void FreeVideo(NDIReceiver receiver, const VideoFrame& frame) = 0;
+    virtual void FreeAudio(NDIReceiver receiver, const AudioFrame& frame) = 0;
+    virtual ReceiverPerformance GetPerformance(NDIReceiver receiver) = 0;
+
+    // Send. An async video frame's buffer must stay valid until the next
+    // video send on the same sender; SendVideoAsync(sender, nullptr) waits
+    // for the last one to finish.
+    virtual NDISender CreateSender(const std::string& name, bool clock_video, bool clock_audio) = 0;
+    virtual void DestroySender(NDISender sender) = 0;
+    virtual void SendVideo(NDISender sender, const VideoFrame& frame) = 0;
+    virtual void SendVideoAsync(NDISender sender, const VideoFrame* frame) = 0;
+    virtual void SendAudio(NDISender sender, const AudioFrame& frame) = 0;
+    virtual int GetConnectionCount(NDISender sender, uint32_t timeout_ms) = 0;
+};
+
+// Backend over the NDI SDK runtime (ndi_sdk_backend.cpp)
+std::unique_ptr<NDIBackend> CreateSDKBackend();
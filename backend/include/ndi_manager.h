@@ -7,49 +7,146 @@
 #include <thread>
 #include <atomic>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <deque>
 #include <mutex>
-#include <Processing.NDI.Lib.h>
+#include <condition_variable>
+#include <random>
+#include <chrono>
+#include "ndi_backend.h"
+#include "routing_table.h"
+#include "source_table.h"
 
-struct NDISource {
-    std::string name;
-    std::string url;
-    bool is_connected;
-    std::string group_name;
+// How route receivers ask NDI for video. Passthrough takes the decoder's
+// native UYVY (BGRA only when the source carries alpha) and hands it to the
+// senders unconverted; BGRA converts every frame to 32-bit on receive.
+enum class ReceiveMode {
+    Passthrough,
+    BGRA
 };
 
-struct MatrixSourceSlot {
-    int slot_number;
-    std::string assigned_ndi_source;  // Which NDI source is assigned to this slot
-    std::string display_name;         // User-friendly name for this slot
-    bool is_assigned;
+// Bit flags reported to the state change callback
+enum StateChange : uint32_t {
+    kSourcesChanged = 1u << 0,
+    kSourceSlotsChanged = 1u << 1,
+    kDestinationsChanged = 1u << 2,
+    kRoutesChanged = 1u << 3,
+    kStudioMonitorChanged = 1u << 4,
+    kPreviewChanged = 1u << 5
 };
 
-struct MatrixDestination {
-    int slot_number;
-    std::string name;
-    std::string description;
-    bool is_enabled;
-    int current_source_slot;          // Which source slot is routed to this destination (0 = none)
-    NDIlib_send_instance_t ndi_sender;
+// Everything a control panel shows, read under one lock
+struct MatrixStateSnapshot {
+    uint64_t version = 0;
+    std::vector<MatrixSourceSlot> source_slots;
+    std::vector<MatrixDestination> destinations;
+    std::vector<MatrixRoute> routes;
+    std::string studio_monitor_source;
+    std::string preview_source;
+};
+
+// Current value of every entity changed after a given version. Entities that
+// no longer exist are listed by slot number; routes are keyed by destination.
+struct MatrixChanges {
+    uint64_t version = 0;
+    bool resync = false;   // Too old for the change log; fetch the full state instead
+    std::vector<MatrixSourceSlot> source_slots;
+    std::vector<MatrixDestination> destinations;
+    std::vector<int> removed_destinations;
+    std::vector<MatrixRoute> routes;
+    std::vector<int> removed_routes;
+    bool studio_monitor_changed = false;
+    std::string studio_monitor_source;
+    bool preview_changed = false;
+    std::string preview_source;
+};
+
+// Source slots always exist (empty until assigned); destinations are created
+// on demand in slots 1..destination_slots
+struct MatrixSize {
+    int source_slots = 0;
+    int destination_slots = 0;
+};
+
+// One crosspoint of a salvo; source slot 0 clears the destination
+struct Crosspoint {
+    int source_slot = 0;
+    int destination_slot = 0;
 };
 
-struct MatrixRoute {
-    std::string id;
+struct CrosspointResult {
+    int source_slot = 0;
+    int destination_slot = 0;
+    bool changed = false;     // False if the destination already had that source
+    std::string error;        // Empty if the crosspoint is valid
+};
+
+struct RoutingWorkerStats {
+    std::string source_name;
+    bool warm;                        // Kept connected without a route (receiver pool)
+    size_t destination_count;
+    uint64_t loop_iterations;         // Capture calls made (including timeouts)
+    uint64_t frames_forwarded;        // Video + audio frames fanned out
+    uint64_t video_frames;
+    uint64_t audio_frames;
+    uint64_t audio_samples;           // Per channel
+    double last_loop_ms;              // Capture-return to fan-out-complete time of the last frame
+    double avg_loop_ms;
+    double max_loop_ms;
+    double total_loop_ms;             // Summed over frames_forwarded
+    double total_iteration_ms;        // Whole capture loop including the wait, summed over loop_iterations
+    // From the receiver (NDIBackend::GetPerformance)
+    uint64_t dropped_video_frames;
+    uint64_t dropped_audio_frames;
+    uint32_t queued_video_frames;
+    uint32_t queued_audio_frames;
+};
+
+struct RouteMetrics {
     int source_slot;
     int destination_slot;
-    bool is_active;
+    std::string source_name;          // NDI source carried by the source slot
+    std::string destination_name;
+    uint64_t video_frames;
+    uint64_t audio_frames;
+    uint64_t audio_samples;
+    LatencyHistogram::Summary send_latency;     // Capture return to send return
+    LatencyHistogram::Summary source_latency;   // Sender's NDI timestamp to send return, if frames carry one
+};
+
+struct DestinationMetrics {
+    int slot_number;
+    std::string name;
+    int connections;                  // Receivers connected to the output; -1 without a sender
+    uint64_t video_frames;            // Routed and slate
+    uint64_t audio_frames;
+    uint64_t slate_frames;
+    uint64_t cuts;                    // Times a source took the output over
+    // Frame synchronizer of a clocked destination; all zero when free-running
+    bool frame_sync;
+    uint64_t repeated_frames;         // Ticks that showed the previous frame again
+    uint64_t dropped_frames;          // Source frames no tick showed
+    uint64_t late_ticks;              // Ticks the output thread missed
+    uint64_t audio_fill_samples;      // Silence inserted on underrun, per channel
+    uint64_t audio_dropped_samples;   // Dropped on overflow, per channel
 };
 
 class NDIManager {
 public:
-    NDIManager();
+    // All NDI I/O goes through the backend: CreateSDKBackend() in the
+    // application, MockNDIBackend in benchmarks
+    explicit NDIManager(std::unique_ptr<NDIBackend> backend);
     ~NDIManager();
 
     bool Initialize();
     void Shutdown();
     
+    // Copies from the cached source table; never waits on the network
     std::vector<NDISource> DiscoverSources();
     std::vector<NDISource> DiscoverStudioMonitors();
+    // The table itself, for readers that only look at it
+    std::shared_ptr<const SourceTableSnapshot> GetSourceTable() const;
     
     // Matrix Source Slots Management
     std::vector<MatrixSourceSlot> GetSourceSlots();
@@ -58,7 +155,10 @@ public:
     
     // Matrix Destinations Management
     std::vector<MatrixDestination> GetMatrixDestinations();
-    bool CreateMatrixDestination(const std::string& name, const std::string& description);
+    // With output_clock enabled the destination gets a frame synchronizer and
+    // goes out at a fixed rate; false if the clock's rates are out of range
+    bool CreateMatrixDestination(const std::string& name, const std::string& description,
+                                 const OutputClock& output_clock = OutputClock());
     bool RemoveMatrixDestination(int slot_number);
     
     // Matrix Routing
@@ -67,21 +167,78 @@ public:
     bool UnassignDestination(int destination_slot);
     std::vector<MatrixRoute> GetMatrixRoutes();
     
+    // Applies every crosspoint in one routing table swap, or none if any
+    // crosspoint is invalid; workers never see half a salvo. Costs
+    // O(crosspoints), independent of how many routes exist. results gets one
+    // entry per crosspoint, in order.
+    bool ApplySalvo(const std::vector<Crosspoint>& crosspoints, std::vector<CrosspointResult>& results);
+    
     // Bulk Routing Operations
     bool CreateMultipleRoutes(int source_slot, const std::vector<int>& destination_slots);
     bool RemoveAllRoutesFromSource(int source_slot);
     std::vector<int> GetDestinationsForSource(int source_slot);
     
-    // Initialize default matrix (4 destinations, 16 source slots)
+    // Matrix size. Call before Initialize() to set the startup size, or at any
+    // time to resize; shrinking fails if a slot beyond the new size is in use.
+    bool SetMatrixSize(int source_slots, int destination_slots);
+    MatrixSize GetMatrixSize();
+    
+    // Initialize default matrix (empty source slots, no destinations)
     void InitializeDefaultMatrix();
     
-    void SetSourceUpdateCallback(std::function<void(const std::vector<NDISource>&)> callback);
+    // Called from the discovery thread when sources appear or go away. Like the
+    // state change callback it must not call back into NDIManager.
+    void SetSourceUpdateCallback(std::function<void(const SourceTableChanges&)> callback);
+    
+    // Called with StateChange flags after every control-plane mutation. It may run
+    // with internal locks held, so it must not call back into NDIManager.
+    void SetStateChangeCallback(std::function<void(uint32_t changes)> callback);
+    
+    // Incremented on every control-plane change. Read it before the state it
+    // versions: the data is then at least as new as the version.
+    uint64_t GetStateVersion() const;
+    
+    // Consistent snapshot of the whole matrix, and the delta since a version
+    MatrixStateSnapshot GetMatrixState();
+    MatrixChanges GetMatrixChangesSince(uint64_t since_version);
     
     // Studio Monitor Source Control
     bool SetStudioMonitorSource(const std::string& source_name);
     std::string GetStudioMonitorSource();
     void ClearStudioMonitorSource();
     
+    // Routing worker pool (one capture thread per routed source)
+    void SetMaxSourceWorkers(size_t max_workers);  // 0 = unlimited
+    size_t GetMaxSourceWorkers() const;
+    std::vector<RoutingWorkerStats> GetRoutingWorkerStats();
+    size_t GetPendingSourceCount() const;
+    
+    // Receiver pool. Sources assigned to a slot or routed recently keep a
+    // connected, drained receiver, so a take switches on the source's next
+    // frame instead of waiting for NDI to connect. At most budget unrouted
+    // sources stay warm, most recently used first; one that is in no slot is
+    // released once it has gone idle_timeout without a route. Budget 0
+    // releases a receiver as soon as its source is unrouted.
+    void SetWarmReceiverBudget(size_t budget);
+    size_t GetWarmReceiverBudget() const;
+    void SetWarmReceiverIdleTimeout(std::chrono::seconds idle_timeout);
+    size_t GetWarmReceiverCount() const;
+    
+    // Counters for GET /api/metrics; read without stopping any frame path
+    std::vector<RouteMetrics> GetRouteMetrics();
+    std::vector<DestinationMetrics> GetDestinationMetrics();
+    // Clears the latency histograms of the route to destination_slot (0 = every
+    // route); false if no route goes there
+    bool ResetRouteLatency(int destination_slot);
+    
+    // Receive format for routed sources; changing it reconnects every route receiver
+    void SetReceiveMode(ReceiveMode mode);
+    ReceiveMode GetReceiveMode() const;
+    
+    // Idle output slate, sent to destinations without a route (0 = disabled)
+    void SetIdleSlateRate(double frames_per_second);
+    double GetIdleSlateRate() const;
+    
     // Lightweight Preview System
     bool SetPreviewSource(const std::string& source_name);
     std::string GetPreviewSource();
@@ -89,36 +246,179 @@ public:
     void ClearPreviewSource();
 
 private:
-    NDIlib_find_instance_t ndi_find_;
-    std::vector<std::unique_ptr<NDIlib_recv_instance_t>> receivers_;
-    std::vector<std::unique_ptr<NDIlib_send_instance_t>> senders_;
+    std::unique_ptr<NDIBackend> backend_;   // Declared first: outlives every handle below
+    NDIFinder ndi_find_;
     std::vector<MatrixSourceSlot> matrix_source_slots_;
     std::vector<MatrixDestination> matrix_destinations_;
     std::vector<MatrixRoute> matrix_routes_;
-    std::function<void(const std::vector<NDISource>&)> source_update_callback_;
+    SlotIndex source_slot_index_;   // slot number -> position in matrix_source_slots_
+    SlotIndex destination_index_;   // slot number -> position in matrix_destinations_
+    SlotIndex route_index_;         // destination slot -> position in matrix_routes_
+    MatrixSize matrix_size_;
+    std::vector<int> free_destination_slots_;   // Freed slots, reused LIFO before next_destination_slot_
+    int next_destination_slot_ = 1;             // Lowest slot never handed out since the matrix was reset
+    std::function<void(const SourceTableChanges&)> source_update_callback_;   // Guarded by state_change_mutex_
+    std::function<void(uint32_t)> state_change_callback_;   // Guarded by state_change_mutex_
+    std::mutex state_change_mutex_;
+    std::atomic<uint64_t> state_version_;   // Only advanced under state_mutex_
+    void NotifyStateChange(uint32_t changes);   // Requires state_mutex_
+    
+    // Bounded log of which entity changed at which version, for GetMatrixChangesSince()
+    enum class ChangedEntity : uint8_t {
+        SourceSlot,
+        Destination,
+        Route,
+        StudioMonitor,
+        Preview
+    };
+    struct ChangeLogEntry {
+        uint64_t version;
+        ChangedEntity entity;
+        int slot_number;   // Source or destination slot; 0 for selections
+    };
+    std::deque<ChangeLogEntry> change_log_;    // Guarded by state_mutex_
+    uint64_t change_log_floor_ = 0;            // Deltas since older versions need a resync
+    void LogChange(ChangedEntity entity, int slot_number = 0);   // Requires state_mutex_
     
     // Map of source name to receiver for persistent connections
-    std::map<std::string, NDIlib_recv_instance_t> route_receivers_;
+    std::map<std::string, NDIReceiver> route_receivers_;
+    
+    // Receivers of stopped workers whose frames are still out with a sender
+    // (one waiting to be torn down, say). The supervisor destroys each once
+    // its frames are all back. Guarded by receivers_mutex_.
+    class VideoFramePool;
+    struct DrainingReceiver {
+        NDIReceiver receiver;
+        std::unique_ptr<VideoFramePool> frames;
+    };
+    std::vector<DrainingReceiver> draining_receivers_;
+    void ReclaimDrainingReceivers(bool force = false);   // force: at shutdown, whatever is still out
     
     // Studio monitor source tracking
     std::string current_studio_monitor_source_;
     
-    // Lightweight preview system
-    std::string current_preview_source_;
-    NDIlib_recv_instance_t preview_receiver_;
-    std::string cached_preview_image_;
+    // Lightweight preview system. The preview thread owns its own lowest-bandwidth
+    // receiver and publishes encoded JPEGs; requests only copy the cached image.
+    std::string current_preview_source_;     // Guarded by preview_mutex_
+    std::string cached_preview_image_;       // Guarded by preview_mutex_
+    NDIReceiver preview_receiver_;           // Preview thread only
     std::mutex preview_mutex_;
+    std::condition_variable preview_wakeup_;
+    std::unique_ptr<std::thread> preview_thread_;
+    std::atomic<bool> should_stop_preview_;
+    void PreviewThread();
     
+    std::mt19937 route_id_rng_;   // Seeded once; guarded by state_mutex_
     std::string GenerateDestinationId();
+    int AllocateDestinationSlot();   // 0 when every slot is taken
+    void ReleaseDestinationSlot(int slot_number);
     MatrixDestination* FindMatrixDestination(int slot_number);
     MatrixSourceSlot* FindMatrixSourceSlot(int slot_number);
-    NDIlib_recv_instance_t GetOrCreateReceiver(const std::string& source_name);
-    void CleanupUnusedReceivers();
-    void SendTestFramesToAllDestinations(); // Send test frames to make outputs visible
+    MatrixRoute* FindRouteForDestination(int destination_slot);
+    bool EraseRouteForDestination(int destination_slot);
+    NDIReceiver GetOrCreateReceiver(const std::string& source_name);
+    // Its worker must be stopped; frames is the worker's pool
+    void ReleaseReceiver(const std::string& source_name, std::unique_ptr<VideoFramePool> frames);
+    
+    // Pre-built slate frame shared by every idle destination; only the
+    // supervisor thread touches it after Initialize()
+    std::vector<uint8_t> slate_buffer_;
+    VideoFrame slate_frame_;
+    std::atomic<double> idle_slate_fps_;
+    void BuildIdleSlate();
+    void SendIdleSlate(std::chrono::steady_clock::duration period);
+    
+    // Capture worker dedicated to a single routed source. It blocks on its own
+    // receiver and fans frames out to the senders listed for it in the current
+    // routing snapshot.
+    struct SourceWorker {
+        std::string source_name;
+        std::atomic<uint32_t> source_id{RoutingSnapshot::kNoSource};   // Fan-out id in the routing snapshot; set by the supervisor
+        bool routed = false;   // False while it only keeps the receiver warm; guarded by workers_mutex_
+        uint64_t serial = 0;   // Identifies the worker as a destination's feed; never reused
+        NDIReceiver receiver = nullptr;
+        std::unique_ptr<VideoFramePool> frames;   // Frames captured from receiver, lent to destinations
+        std::unique_ptr<std::thread> thread;
+        std::atomic<bool> should_stop{false};
+        std::atomic<uint64_t> loop_iterations{0};
+        std::atomic<uint64_t> frames_forwarded{0};
+        std::atomic<uint64_t> video_frames{0};
+        std::atomic<uint64_t> audio_frames{0};
+        std::atomic<uint64_t> audio_samples{0};
+        std::atomic<uint64_t> last_loop_us{0};
+        std::atomic<uint64_t> total_loop_us{0};
+        std::atomic<uint64_t> total_iteration_us{0};
+        std::atomic<uint64_t> busy_iterations{0};
+        std::atomic<uint64_t> max_loop_us{0};
+    };
+    
+    std::map<std::string, std::unique_ptr<SourceWorker>> source_workers_;
+    uint64_t next_worker_serial_ = 1;   // Guarded by workers_mutex_
+    std::mutex workers_mutex_;
+    std::mutex receivers_mutex_;
+    std::atomic<size_t> max_source_workers_;
+    std::atomic<size_t> pending_source_count_;
+    std::atomic<ReceiveMode> receive_mode_;
+    std::atomic<bool> receivers_stale_;   // Set when receive_mode_ changes; the supervisor reconnects
+    
+    // Receiver pool bookkeeping. Last time each source was routed (or first
+    // assigned), guarded by workers_mutex_; assigned_sources_ is the
+    // supervisor's copy of the slot assignments, refreshed when they change.
+    std::unordered_map<std::string, std::chrono::steady_clock::time_point> receiver_last_used_;
+    std::unordered_set<std::string> assigned_sources_;
+    std::atomic<bool> assigned_sources_stale_;   // Set under state_mutex_ when a slot assignment changes
+    std::atomic<size_t> warm_receiver_budget_;
+    std::atomic<int64_t> warm_receiver_idle_timeout_s_;
+    std::atomic<size_t> warm_receiver_count_;
+    void RefreshAssignedSources();
+    std::unordered_set<std::string> SelectWarmSources(
+        const std::unordered_map<std::string, uint32_t>& routed, std::chrono::steady_clock::time_point now);
     
+    void SyncSourceWorkers(const RoutingSnapshot& snapshot);
+    bool StartSourceWorker(const std::string& source_name, uint32_t source_id);
+    void StopSourceWorker(SourceWorker& worker);
+    void StopAllSourceWorkers();   // And releases their receivers
+    void ResetRouteReceivers();
+    void SourceWorkerLoop(SourceWorker* worker);
+    
+    // Control-plane state (slots, destinations, routes, studio monitor) is only
+    // touched under state_mutex_. Routing workers never take it: they read the
+    // published snapshot instead.
+    std::mutex state_mutex_;
+    RoutingTableBuilder routing_table_;   // Fan-outs the next snapshot is built from
+    std::shared_ptr<const RoutingSnapshot> routing_snapshot_;  // Accessed with std::atomic_load/store
+    std::vector<std::shared_ptr<const RoutingSnapshot>> retired_snapshots_;
+    void PublishRoutingSnapshot();   // Requires state_mutex_
+    void RebuildRoutingTable();      // Requires state_mutex_; recomputes every fan-out
+    void ReclaimRetiredSnapshots();  // Requires state_mutex_; also reclaims retired senders
+    
+    // Destination senders whose last handle is gone. Any thread may drop it,
+    // a capture worker included, so the deleter only queues the sender here;
+    // the control plane stops its output thread, flushes and destroys it.
+    std::mutex retired_senders_mutex_;
+    std::vector<DestinationSender*> retired_senders_;   // Guarded by retired_senders_mutex_
+    std::atomic<bool> retired_senders_pending_;         // Wakes the supervisor to reclaim them
+    NDISenderHandle MakeSenderHandle(NDISender instance, const OutputClock& clock);
+    void RetireSender(DestinationSender* sender);
+    void ReclaimRetiredSenders();    // Not under a send_mutex
+    std::shared_ptr<const RoutingSnapshot> LoadRoutingSnapshot() const;
+    // False if either slot is missing; *changed is false when the route already existed
+    bool CreateMatrixRouteLocked(int source_slot, int destination_slot, bool* changed = nullptr);
+    bool RemoveRouteLocked(int destination_slot);   // Clears the destination; false if it had no route
+    
+    // Discovered sources. The discovery thread owns ndi_find_ once started and
+    // blocks in NDIBackend::WaitForSources until the network changes.
+    SourceTable source_table_;
+    std::unique_ptr<std::thread> discovery_thread_;
+    std::atomic<bool> should_stop_discovery_;
     void SourceDiscoveryThread();
-    void ProcessRoutes();  // Process all active routes
+    void RefreshSourceTable();
+    
+    void ProcessRoutes();  // Supervise per-source capture workers
+    void NotifyRoutingChange();  // Wake the supervisor after any control-plane mutation
     std::unique_ptr<std::thread> routing_thread_;
     std::atomic<bool> should_stop_routing_;
-    std::atomic<bool> is_updating_routes_;
+    std::atomic<uint64_t> routing_generation_;
+    std::mutex routing_wakeup_mutex_;
+    std::condition_variable routing_wakeup_;
 };
\ No newline at end of file
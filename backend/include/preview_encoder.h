@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+enum class PreviewPixelFormat {
+    UYVY,   // 4:2:2 video range, as delivered by NDI receivers
+    BGRA    // Also accepts BGRX
+};
+
+// Planar video-range YCbCr 4:4:4 image the preview is encoded from
+struct PreviewPlanes {
+    int width = 0;
+    int height = 0;
+    std::vector<uint8_t> y;
+    std::vector<uint8_t> cb;
+    std::vector<uint8_t> cr;
+
+    void Resize(int new_width, int new_height);
+};
+
+// Downscale kernels (SSE2 when available, scalar otherwise). Each halves both
+// dimensions with a 2x2 box filter; odd trailing rows/columns are replicated.
+void DownscaleUyvy2x(const uint8_t* src, int width, int height, int stride, PreviewPlanes& out);
+void DownscaleBgra2x(const uint8_t* src, int width, int height, int stride, PreviewPlanes& out);
+void DownscalePlanes2x(const PreviewPlanes& src, PreviewPlanes& out);
+
+std::string Base64Encode(const uint8_t* data, size_t size);
+
+// Turns video frames into small baseline JPEG previews. Not thread-safe: the
+// preview thread owns one and reuses its buffers from frame to frame.
+class PreviewEncoder {
+public:
+    PreviewEncoder(int max_width, int quality);
+
+    // Downscale until the width fits max_width, then JPEG-encode into a
+    // "data:image/jpeg;base64,..." URI
+    bool Encode(const uint8_t* data, int width, int height, int stride,
+                PreviewPixelFormat format, std::string& data_uri);
+
+    const std::vector<uint8_t>& jpeg() const { return jpeg_; }
+
+private:
+    void EncodeJpeg(const PreviewPlanes& planes);
+
+    int max_width_;
+    PreviewPlanes planes_;
+    PreviewPlanes scratch_;
+    std::vector<uint8_t> jpeg_;
+    uint8_t luma_quant_[64];      // Zigzag order, as written to the DQT segment
+    uint8_t chroma_quant_[64];
+    float luma_divisors_[64];     // Natural order reciprocals used while quantizing
+    float chroma_divisors_[64];
+    uint8_t luma_range_[256];     // Video range -> JFIF full range
+    uint8_t chroma_range_[256];
+};
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstdint>
+#include <initializer_list>
+#include <string>
+#include <string_view>
+#include <utility>
+
+// Builder for the Prometheus text exposition format (version 0.0.4). Label
+// values are escaped; metric and label names are taken as given and must
+// already be valid. Clear() keeps the buffer for the next scrape.
+class PrometheusWriter {
+public:
+    using Label = std::pair<std::string_view, std::string_view>;
+
+    void Clear() { text_.clear(); }
+    const std::string& str() const { return text_; }
+
+    // # HELP and # TYPE lines that precede a metric's samples;
+    // type is counter, gauge, summary or histogram
+    PrometheusWriter& Family(std::string_view name, std::string_view type, std::string_view help);
+
+    PrometheusWriter& Sample(std::string_view name, std::initializer_list<Label> labels, double value);
+    PrometheusWriter& SampleInt(std::string_view name, std::initializer_list<Label> labels, uint64_t value);
+
+private:
+    void AppendSeries(std::string_view name, std::initializer_list<Label> labels);
+
+    std::string text_;
+};
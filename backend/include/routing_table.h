@@ -0,0 +1,230 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "frame_sync.h"
+#include "latency_histogram.h"
+#include "ndi_backend.h"
+
+// Reference-counted captured frame. Each destination that async-sends it holds
+// a reference until the backend is done with the buffer; the last Release() hands
+// the frame back to the receiver that produced it.
+class SharedFrame {
+public:
+    explicit SharedFrame(const void* owner) : owner_(owner) {}
+    virtual ~SharedFrame() = default;
+
+    void AddRef() { refs_.fetch_add(1, std::memory_order_relaxed); }
+    void Release() {
+        if (refs_.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            Recycle();
+        }
+    }
+    const void* owner() const { return owner_; }
+
+protected:
+    virtual void Recycle() = 0;
+    std::atomic<int> refs_{0};
+
+private:
+    const void* owner_;
+};
+
+// An NDI sender plus the state needed to async-send to it. The SDK keeps reading
+// an async frame until the next send on the same sender, so the sender pins the
+// frame it last sent.
+struct DestinationSender {
+    NDIBackend* backend = nullptr;
+    NDISender instance = nullptr;
+    std::mutex send_mutex;                      // Only contended while a route switches sources
+    SharedFrame* in_flight_video = nullptr;     // Guarded by send_mutex
+    std::chrono::steady_clock::time_point last_routed_video;  // Guarded by send_mutex; idle slate backs off while recent
+    // Frame synchronizer of a clocked destination: workers hand it their frames
+    // and its output thread sends. Set before the sender is shared, then fixed.
+    std::unique_ptr<FrameSync> sync;
+
+    // Clean cuts, guarded by send_mutex. The destination carries one feed (a
+    // capture worker) at a time. A newly routed source takes over with its
+    // first video frame; until then the previous feed keeps going. Each side's
+    // audio is cut at the sample position where its own video changes hands.
+    uint64_t feed = 0;                                  // Worker serial; 0 = none yet
+    uint64_t feed_version = 0;                          // Routing snapshot version it took over under
+    int64_t feed_audio_start = kNDITimestampUndefined;  // Its first video frame's timestamp; earlier audio is cut
+    int64_t feed_video_end = kNDITimestampUndefined;    // End of its last video frame
+    uint64_t previous_feed = 0;                         // Feed it took over from, until that feed's audio catches up
+    int64_t previous_audio_end = kNDITimestampUndefined;
+
+    // Has a route in the control plane's routing table (RoutingTableBuilder
+    // sets it); a source switched away from stops feeding once it is cleared
+    std::atomic<bool> routed{false};
+
+    // Frames handed to the SDK, routed and slate; bumped under send_mutex, read without it
+    std::atomic<uint64_t> video_frames_sent{0};
+    std::atomic<uint64_t> audio_frames_sent{0};
+    std::atomic<uint64_t> slate_frames_sent{0};
+    std::atomic<uint64_t> cuts{0};   // Feed changes
+};
+
+// Shared ownership of a destination's sender. The last holder (a destination or
+// a routing snapshot a worker still reads) flushes and destroys it.
+using NDISenderHandle = std::shared_ptr<DestinationSender>;
+
+// Per-route counters and latency histograms. Created with the route and shared
+// with the routing snapshots; the capture worker feeding the route is the only
+// writer, so relaxed atomics cost the frame path no locks and no contended
+// cache lines.
+struct RouteStats {
+    std::atomic<uint64_t> video_frames{0};
+    std::atomic<uint64_t> audio_frames{0};
+    std::atomic<uint64_t> audio_samples{0};   // Per channel
+    LatencyHistogram send_latency;     // Capture call return to send call return
+    LatencyHistogram source_latency;   // Sender's NDI timestamp to send call return; frames that carry one
+};
+
+struct MatrixSourceSlot {
+    int slot_number;
+    std::string assigned_ndi_source;  // Which NDI source is assigned to this slot
+    std::string display_name;         // User-friendly name for this slot
+    bool is_assigned;
+};
+
+struct MatrixDestination {
+    int slot_number;
+    std::string name;
+    std::string description;
+    bool is_enabled;
+    int current_source_slot;          // Which source slot is routed to this destination (0 = none)
+    OutputClock output_clock;         // Fixed at creation
+    NDISenderHandle ndi_sender;
+};
+
+struct MatrixRoute {
+    std::string id;
+    int source_slot;
+    int destination_slot;
+    bool is_active;
+    std::shared_ptr<RouteStats> stats;   // New for every route, including a replaced one
+};
+
+// Dense slot-number -> vector-position index. Slot numbers are small positive
+// integers, so a flat array gives O(1) lookups without hashing.
+class SlotIndex {
+public:
+    static constexpr int kNone = -1;
+    static constexpr int kMaxSlotNumber = 1 << 16;
+
+    static bool IsValidSlot(int slot_number) { return slot_number > 0 && slot_number <= kMaxSlotNumber; }
+
+    int Find(int slot_number) const {
+        if (slot_number <= 0 || static_cast<size_t>(slot_number) >= positions_.size()) {
+            return kNone;
+        }
+        return positions_[slot_number];
+    }
+
+    void Set(int slot_number, int position);
+    void Erase(int slot_number);
+    void Clear() { positions_.clear(); }
+
+    template <typename T>
+    void Rebuild(const std::vector<T>& items, int T::*slot_member) {
+        positions_.clear();
+        for (size_t i = 0; i < items.size(); ++i) {
+            Set(items[i].*slot_member, static_cast<int>(i));
+        }
+    }
+
+private:
+    std::vector<int> positions_;
+};
+
+// Immutable view of the routing table consumed by the capture workers.
+// Published by the control plane on every change (read-copy-update); workers
+// read it without locks and keep it alive while they use it.
+//
+// Fan-outs are indexed by a source id that stays the same for as long as the
+// source is routed, and held in fixed-size chunks. A new snapshot shares every
+// chunk and fan-out it did not change with the previous one, so publishing a
+// route change costs one fan-out copy plus one pointer per chunk.
+struct RoutingSnapshot {
+    struct SourceFanout {
+        std::string source_name;
+        std::vector<NDISenderHandle> senders;
+        std::vector<int> destination_slots;   // Parallel to senders
+        std::vector<std::shared_ptr<RouteStats>> route_stats;   // Parallel to senders; entries may be null
+    };
+
+    static constexpr uint32_t kNoSource = UINT32_MAX;
+    static constexpr size_t kChunkSize = 64;
+    using Chunk = std::array<std::shared_ptr<const SourceFanout>, kChunkSize>;
+
+    uint64_t version = 0;
+    size_t source_count = 0;   // Routed NDI sources
+    std::vector<std::shared_ptr<const Chunk>> chunks;   // Indexed by source id / kChunkSize; may be null
+
+    // The fan-out for source_id, or null if the id is unused or now belongs to
+    // another source (ids are reused once a source loses its last route)
+    const SourceFanout* FindSource(uint32_t source_id, const std::string& source_name) const;
+
+    template <typename Fn>
+    void ForEachSource(Fn&& fn) const {
+        for (size_t c = 0; c < chunks.size(); ++c) {
+            if (!chunks[c]) continue;
+            for (size_t i = 0; i < kChunkSize; ++i) {
+                if (const SourceFanout* fanout = (*chunks[c])[i].get()) {
+                    fn(static_cast<uint32_t>(c * kChunkSize + i), *fanout);
+                }
+            }
+        }
+    }
+};
+
+// Control-plane side of the routing table. Keeps the source -> destination
+// fan-outs between publishes so a route change only touches the fan-out of
+// the source it concerns. Not thread-safe; NDIManager uses it under
+// state_mutex_.
+class RoutingTableBuilder {
+public:
+    // Recomputes every fan-out from the control-plane state in O(routes), for
+    // changes that can move many routes at once (slot assignment, resizing).
+    // Sources that stay routed keep their ids.
+    void Rebuild(const std::vector<MatrixSourceSlot>& source_slots, const SlotIndex& source_slot_index,
+                 const std::vector<MatrixDestination>& destinations, const SlotIndex& destination_index,
+                 const std::vector<MatrixRoute>& routes);
+
+    // O(destinations of the source); the route must not already be present
+    void AddRoute(const std::string& source_name, int destination_slot,
+                  const NDISenderHandle& sender, const std::shared_ptr<RouteStats>& stats);
+    // False if the source does not feed destination_slot
+    bool RemoveRoute(const std::string& source_name, int destination_slot);
+
+    void Clear();
+
+    // Snapshot of the current fan-outs in O(sources / kChunkSize); the caller
+    // sets the version
+    std::shared_ptr<RoutingSnapshot> Build();
+
+private:
+    using Fanout = RoutingSnapshot::SourceFanout;
+
+    uint32_t AcquireSourceId(const std::string& source_name);
+    void ReleaseSourceId(const std::string& source_name, uint32_t source_id);
+    const Fanout* GetFanout(uint32_t source_id) const;
+    void SetFanout(uint32_t source_id, std::shared_ptr<const Fanout> fanout);
+    RoutingSnapshot::Chunk& MutableChunk(size_t chunk);
+    void ClearRoutedFlags();
+
+    std::unordered_map<std::string, uint32_t> source_ids_;
+    std::vector<uint32_t> free_source_ids_;   // LIFO, so ids stay dense
+    uint32_t next_source_id_ = 0;
+    std::vector<std::shared_ptr<RoutingSnapshot::Chunk>> chunks_;
+    std::vector<bool> chunk_shared_;   // Chunk is referenced by a built snapshot; copy before writing
+    size_t source_count_ = 0;
+};
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+struct NDISource {
+    std::string name;
+    std::string url;
+    bool is_connected;
+    std::string group_name;
+};
+
+// Immutable view of the sources announced on the network. The discovery
+// thread publishes a new one only when something changed; HTTP handlers and
+// other readers load it without locks and keep it alive while they use it.
+struct SourceTableSnapshot {
+    uint64_t generation = 0;
+    std::vector<NDISource> sources;           // Announced sources except our own outputs, in discovery order
+    std::vector<NDISource> studio_monitors;   // Announced sources whose name contains "studio monitor"
+    std::unordered_map<std::string, uint32_t> source_positions;   // Name -> position in sources
+
+    const NDISource* FindSource(const std::string& name) const;
+};
+
+// Sources that appeared or went away in one discovery update. A source whose
+// URL changed is reported as added again.
+struct SourceTableChanges {
+    std::vector<NDISource> added;
+    std::vector<std::string> removed;
+    std::shared_ptr<const SourceTableSnapshot> snapshot;   // State after the update
+};
+
+// Cached, hash-indexed table of discovered NDI sources. Update() takes the
+// finder's full list and diffs it against the table in O(sources); studio
+// monitor classification is computed once per source, not per request.
+class SourceTable {
+public:
+    SourceTable();
+
+    // Applies the finder's current list. Returns false (and publishes
+    // nothing) if it matches the table.
+    bool Update(const std::vector<NDISource>& announced, SourceTableChanges& changes);
+
+    // Names of our own outputs, hidden from the source list. Republishes the
+    // snapshot if the visible list changes.
+    void SetOwnOutputs(const std::vector<std::string>& names);
+    // One output at a time; several outputs may share a name
+    void AddOwnOutput(const std::string& name);
+    void RemoveOwnOutput(const std::string& name);
+
+    std::shared_ptr<const SourceTableSnapshot> Load() const;
+
+    static bool IsStudioMonitorName(const std::string& name);
+
+private:
+    struct Entry {
+        std::string url;
+        bool is_studio_monitor;
+        uint64_t seen;   // Last update that listed it
+    };
+
+    void PublishLocked();   // Requires mutex_
+
+    mutable std::mutex mutex_;
+    std::vector<std::string> order_;   // Names in the finder's order
+    std::unordered_map<std::string, Entry> entries_;
+    std::unordered_map<std::string, uint32_t> own_outputs_;   // Name -> outputs using it
+    uint64_t update_count_ = 0;
+    uint64_t generation_ = 0;
+    std::shared_ptr<const SourceTableSnapshot> snapshot_;   // Accessed with std::atomic_load/store
+};
@@ -1,10 +1,18 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include <functional>
 #include <memory>
 #include <thread>
+#include <atomic>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
 #include "ndi_manager.h"
+#include "http_parser.h"
+#include "http_router.h"
+#include "event_broadcaster.h"
 // #include "auth_manager.h"  // Temporarily disabled for build
 
 class WebServer {
@@ -15,16 +23,62 @@ public:
     bool Start();
     void Stop();
     bool IsRunning() const { return is_running_; }
+    
+    // Number of epoll I/O threads on Linux; call before Start()
+    void SetIoThreadCount(size_t thread_count);
 
 private:
     int port_;
-    bool is_running_;
+    std::atomic<bool> is_running_;
     std::shared_ptr<NDIManager> ndi_manager_;
-    std::unique_ptr<std::thread> server_thread_;
+    size_t io_thread_count_;
+    HttpRouter router_;
     // std::unique_ptr<AuthManager> auth_manager_;  // Temporarily disabled for build
     
+#ifdef _WIN32
+    std::unique_ptr<std::thread> server_thread_;
     void ServerThreadFunction();
     void HandleRequest(int client_socket);
+#else
+    int listen_fd_ = -1;
+    int wake_fd_ = -1;
+    std::vector<std::unique_ptr<std::thread>> io_threads_;
+    void IoThreadFunction();
+#endif
+    
+    // Server-Sent Events on GET /api/events (Linux I/O threads). NDIManager state
+    // changes are coalesced here and serialized once by the event thread, then
+    // fanned out to every subscriber by the I/O thread that owns it.
+    EventBroadcaster events_;
+    std::atomic<size_t> event_subscribers_;
+    std::mutex event_mutex_;
+    std::condition_variable event_wakeup_;
+    uint32_t pending_changes_ = 0;   // StateChange flags, guarded by event_mutex_
+    std::unique_ptr<std::thread> event_thread_;
+    void QueueStateEvents(uint32_t changes);
+    void EventThreadFunction();
+    
+    // Full responses for GET endpoints whose content only changes with the
+    // NDIManager state version. Served with an ETag; a matching If-None-Match
+    // gets a 304 and an unchanged version is answered from the cache.
+    struct VersionedResponse {
+        std::mutex mutex;
+        bool valid = false;
+        uint64_t version = 0;
+        std::string response;
+    };
+    VersionedResponse source_slots_response_;
+    VersionedResponse destinations_response_;
+    VersionedResponse routes_response_;
+    VersionedResponse state_response_;
+    std::string etag_prefix_;
+    std::string ServeVersioned(const HttpRequest& request, VersionedResponse& cache,
+                               std::string (WebServer::*build_body)());
+    
+    // Builds the method + path table used by ProcessRequest
+    void RegisterRoutes();
+    // Routes a parsed request to its handler and returns the full response
+    std::string ProcessRequest(const HttpRequest& http_request);
     
     std::string HandleGetSources();
     std::string HandleGetStudioMonitors();
@@ -32,27 +86,40 @@ private:
     std::string HandleGetMatrixRoutes();
     std::string HandleGetMatrixSourceSlots();
     std::string HandleGetMatrixDestinations();
-    std::string HandleAssignSourceToSlot(const std::string& request_body);
+    std::string HandleGetMatrixState();
+    std::string HandleGetMatrixChanges(uint64_t since_version);
+    std::string HandleGetMatrixSize();
+    std::string HandleSetMatrixSize(std::string_view request_body);
+    std::string HandleAssignSourceToSlot(std::string_view request_body);
     std::string HandleUnassignSourceSlot(int slot_number);
-    std::string HandleCreateMatrixDestination(const std::string& request_body);
+    std::string HandleCreateMatrixDestination(std::string_view request_body);
     std::string HandleRemoveMatrixDestination(int slot_number);
-    std::string HandleCreateMatrixRoute(const std::string& request_body);
-    std::string HandleRemoveMatrixRoute(const std::string& request_body);
+    std::string HandleCreateMatrixRoute(std::string_view request_body);
+    std::string HandleRemoveMatrixRoute(std::string_view request_body);
     std::string HandleUnassignDestination(int destination_slot);
     
     // Bulk routing operations
-    std::string HandleCreateMultipleRoutes(const std::string& request_body);
+    std::string HandleCreateMultipleRoutes(std::string_view request_body);
+    std::string HandleApplySalvo(std::string_view request_body);
     std::string HandleRemoveAllRoutesFromSource(int source_slot);
     std::string HandleGetDestinationsForSource(int source_slot);
-    std::string HandleSetStudioMonitorSource(const std::string& request_body);
+    std::string HandleSetStudioMonitorSource(std::string_view request_body);
     std::string HandleGetStudioMonitorSource();
     
     // Preview API handlers
-    std::string HandleSetPreviewSource(const std::string& request_body);
+    std::string HandleSetPreviewSource(std::string_view request_body);
     std::string HandleGetPreviewSource();
     std::string HandleGetPreviewImage();
     std::string HandleClearPreview();
     
+    // Routing diagnostics
+    std::string HandleGetRoutingWorkers();
+    std::string HandleGetMetrics();   // Prometheus text format
+    std::string HandleGetRouteLatency();
+    std::string HandleResetRouteLatency(std::string_view request_body);
+    std::string HandleGetReceiveMode();
+    std::string HandleSetReceiveMode(std::string_view request_body);
+    
     std::string CreateJSONResponse(const std::string& data, int status_code = 200);
     std::string CreateErrorResponse(const std::string& error, int status_code = 400);
 };
\ No newline at end of file
@@ -0,0 +1,77 @@
+#include "event_broadcaster.h"
+#include <algorithm>
+
+EventBroadcaster::EventBroadcaster(size_t history_size)
+    : history_size_(std::max<size_t>(1, history_size)) {}
+
+void EventBroadcaster::Publish(const std::string& event, const std::string& data) {
+    std::string frame;
+    frame.reserve(event.size() + data.size() + 32);
+    frame += "event: ";
+    frame += event;
+    frame += '\n';
+
+    size_t position = 0;
+    do {
+        size_t end = data.find('\n', position);
+        if (end == std::string::npos) end = data.size();
+        frame += "data: ";
+        frame.append(data, position, end - position);
+        frame += '\n';
+        position = end + 1;
+    } while (position <= data.size());
+
+    frame += '\n';
+    Push(std::move(frame));
+}
+
+void EventBroadcaster::PublishComment(const std::string& comment) {
+    Push(": " + comment + "\n\n");
+}
+
+uint64_t EventBroadcaster::LatestSequence() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return latest_sequence_;
+}
+
+bool EventBroadcaster::AppendSince(uint64_t& last_sequence, std::string& out) const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (last_sequence >= latest_sequence_) {
+        return true;
+    }
+
+    uint64_t oldest = latest_sequence_ - history_.size() + 1;
+    bool complete = last_sequence + 1 >= oldest;
+    size_t start = complete ? static_cast<size_t>(last_sequence + 1 - oldest) : 0;
+    for (size_t i = start; i < history_.size(); ++i) {
+        out += history_[i];
+    }
+    last_sequence = latest_sequence_;
+    return complete;
+}
+
+int EventBroadcaster::AddListener(std::function<void()> wake) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    int id = next_listener_id_++;
+    listeners_.emplace_back(id, std::move(wake));
+    return id;
+}
+
+void EventBroadcaster::RemoveListener(int listener_id) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    listeners_.erase(std::remove_if(listeners_.begin(), listeners_.end(),
+                                    [listener_id](const auto& listener) { return listener.first == listener_id; }),
+                     listeners_.end());
+}
+
+void EventBroadcaster::Push(std::string frame) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    history_.push_back(std::move(frame));
+    ++latest_sequence_;
+    if (history_.size() > history_size_) {
+        history_.pop_front();
+    }
+    for (const auto& listener : listeners_) {
+        listener.second();
+    }
+}
@@ -0,0 +1,169 @@
+#include "frame_sync.h"
+#include "routing_table.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+namespace {
+// Audio FIFO depth the drift correction steers towards, and the most it may
+// hold before the oldest samples are dropped, in output ticks
+constexpr size_t kTargetFifoTicks = 2;
+constexpr size_t kMaxFifoTicks = 8;
+// Resampling ratio change per FIFO tick of error, and its limit (0.5%)
+constexpr double kDriftGain = 0.0025;
+constexpr double kMaxDriftCorrection = 0.005;
+}
+
+FrameSync::FrameSync(const OutputClock& clock) : clock_(clock), video_descriptor_(), audio_frame_() {
+    max_tick_samples_ = static_cast<int>(
+        (static_cast<int64_t>(clock_.audio_sample_rate) * clock_.frame_rate_D + clock_.frame_rate_N - 1) /
+        clock_.frame_rate_N) + 1;
+}
+
+std::chrono::nanoseconds FrameSync::TickTime(uint64_t tick) const {
+    // Whole seconds and remainder apart, so the product never overflows
+    uint64_t frames = tick * static_cast<uint64_t>(clock_.frame_rate_D);
+    uint64_t rate = static_cast<uint64_t>(clock_.frame_rate_N);
+    return std::chrono::seconds(frames / rate) + std::chrono::nanoseconds((frames % rate) * 1000000000ULL / rate);
+}
+
+int FrameSync::SamplesInTick(uint64_t tick) const {
+    // 29.97 fps at 48 kHz alternates 1601 and 1602 samples; the cadence never drifts
+    int64_t per_tick_D = static_cast<int64_t>(clock_.audio_sample_rate) * clock_.frame_rate_D;
+    int64_t n = static_cast<int64_t>(tick);
+    return static_cast<int>((n + 1) * per_tick_D / clock_.frame_rate_N - n * per_tick_D / clock_.frame_rate_N);
+}
+
+SharedFrame* FrameSync::PushVideo(SharedFrame* frame, const VideoFrame& descriptor) {
+    frame->AddRef();
+    SharedFrame* previous = video_;
+    if (previous && !video_shown_) {
+        dropped_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+    video_ = frame;
+    video_descriptor_ = descriptor;
+    video_shown_ = false;
+    return previous;
+}
+
+SharedFrame* FrameSync::VideoForTick(VideoFrame* out) {
+    if (!video_) {
+        return nullptr;
+    }
+    if (video_shown_) {
+        repeated_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+    video_shown_ = true;
+    *out = video_descriptor_;
+    out->frame_rate_N = clock_.frame_rate_N;
+    out->frame_rate_D = clock_.frame_rate_D;
+    out->timecode = kNDITimecodeSynthesize;
+    return video_;
+}
+
+SharedFrame* FrameSync::ReleaseVideo(const void* owner) {
+    if (!video_ || (owner && video_->owner() != owner)) {
+        return nullptr;
+    }
+    SharedFrame* held = video_;
+    video_ = nullptr;
+    return held;
+}
+
+void FrameSync::Resample(const AudioFrame& frame, double step) {
+    if (frame.sample_rate != input_rate_ || frame.channels != input_channels_) {
+        input_rate_ = frame.sample_rate;
+        input_channels_ = frame.channels;
+        position_ = 0.0;
+    }
+
+    // Linear interpolation; sample -1 is the previous frame's last. Channels
+    // beyond the source's repeat its last one.
+    const int samples = frame.samples;
+    double end_position = position_;
+    for (int c = 0; c < channels_; ++c) {
+        const float* input = reinterpret_cast<const float*>(
+            reinterpret_cast<const uint8_t*>(frame.data) +
+            static_cast<size_t>(std::min(c, frame.channels - 1)) * frame.channel_stride_in_bytes);
+        std::vector<float>& fifo = fifo_[c];
+        double position = position_;
+        while (position < samples - 1) {
+            int index = static_cast<int>(std::floor(position));
+            float fraction = static_cast<float>(position - index);
+            float a = index < 0 ? last_input_[c] : input[index];
+            float b = input[index + 1];
+            fifo.push_back(a + (b - a) * fraction);
+            position += step;
+        }
+        last_input_[c] = input[samples - 1];
+        end_position = position;
+    }
+    position_ = end_position - samples;
+}
+
+void FrameSync::PushAudio(const AudioFrame& frame) {
+    if (!frame.data || frame.samples <= 0 || frame.channels <= 0 || frame.sample_rate <= 0) {
+        return;
+    }
+    if (channels_ == 0) {
+        channels_ = frame.channels;
+        fifo_.assign(channels_, std::vector<float>());
+        last_input_.assign(channels_, 0.0f);
+        audio_out_.assign(static_cast<size_t>(channels_) * max_tick_samples_, 0.0f);
+    }
+
+    // Lean the ratio towards the target depth: a full FIFO means the source
+    // runs fast against our clock, so it is resampled to fewer samples
+    double nominal = static_cast<double>(clock_.audio_sample_rate) * clock_.frame_rate_D / clock_.frame_rate_N;
+    double error = (static_cast<double>(FifoLevel()) - kTargetFifoTicks * nominal) / nominal;
+    double correction = std::max(-kMaxDriftCorrection, std::min(kMaxDriftCorrection, error * kDriftGain));
+    Resample(frame, static_cast<double>(frame.sample_rate) / clock_.audio_sample_rate * (1.0 + correction));
+
+    size_t level = FifoLevel();
+    if (level > kMaxFifoTicks * static_cast<size_t>(nominal)) {
+        size_t drop = level - kTargetFifoTicks * static_cast<size_t>(nominal);
+        fifo_read_ += drop;
+        audio_dropped_samples.fetch_add(drop, std::memory_order_relaxed);
+    }
+}
+
+const AudioFrame* FrameSync::AudioForTick() {
+    if (channels_ == 0) {
+        return nullptr;
+    }
+    int samples = SamplesInTick(audio_tick_++);
+    size_t level = FifoLevel();
+
+    // After an underrun the FIFO refills to its target before audio resumes,
+    // so one late frame costs one gap instead of a gap every tick
+    if (!primed_ && level >= kTargetFifoTicks * static_cast<size_t>(samples)) {
+        primed_ = true;
+    }
+    int take = primed_ ? static_cast<int>(std::min<size_t>(level, samples)) : 0;
+    if (take < samples) {
+        primed_ = false;
+        audio_fill_samples.fetch_add(static_cast<uint64_t>(samples - take), std::memory_order_relaxed);
+    }
+    for (int c = 0; c < channels_; ++c) {
+        float* out = audio_out_.data() + static_cast<size_t>(c) * max_tick_samples_;
+        std::memcpy(out, fifo_[c].data() + fifo_read_, static_cast<size_t>(take) * sizeof(float));
+        std::fill(out + take, out + samples, 0.0f);
+    }
+    fifo_read_ += take;
+
+    // Drop the consumed prefix once it is most of the buffer
+    if (fifo_read_ > 0 && fifo_read_ * 2 >= fifo_[0].size()) {
+        for (auto& fifo : fifo_) {
+            fifo.erase(fifo.begin(), fifo.begin() + static_cast<std::ptrdiff_t>(fifo_read_));
+        }
+        fifo_read_ = 0;
+    }
+
+    audio_frame_ = AudioFrame();
+    audio_frame_.sample_rate = clock_.audio_sample_rate;
+    audio_frame_.channels = channels_;
+    audio_frame_.samples = samples;
+    audio_frame_.data = audio_out_.data();
+    audio_frame_.channel_stride_in_bytes = max_tick_samples_ * static_cast<int>(sizeof(float));
+    return &audio_frame_;
+}
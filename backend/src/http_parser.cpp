@@ -0,0 +1,175 @@
+#include "http_parser.h"
+
+namespace {
+
+bool EqualsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) return false;
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i];
+        char y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) return false;
+    }
+    return true;
+}
+
+std::string_view Trim(std::string_view value) {
+    while (!value.empty() && (value.front() == ' ' || value.front() == '\t')) value.remove_prefix(1);
+    while (!value.empty() && (value.back() == ' ' || value.back() == '\t')) value.remove_suffix(1);
+    return value;
+}
+
+bool ContainsTokenIgnoreCase(std::string_view list, std::string_view token) {
+    while (!list.empty()) {
+        size_t comma = list.find(',');
+        if (EqualsIgnoreCase(Trim(list.substr(0, comma)), token)) return true;
+        if (comma == std::string_view::npos) break;
+        list.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+} // namespace
+
+std::string_view HttpRequest::Header(std::string_view name) const {
+    for (const auto& header : headers) {
+        if (EqualsIgnoreCase(header.name, name)) {
+            return header.value;
+        }
+    }
+    return {};
+}
+
+void HttpRequest::Clear() {
+    method = target = path = query = version = body = {};
+    headers.clear();
+    keep_alive = true;
+}
+
+HttpRequestParser::HttpRequestParser(size_t max_header_bytes, size_t max_body_bytes)
+    : max_header_bytes_(max_header_bytes), max_body_bytes_(max_body_bytes) {}
+
+void HttpRequestParser::Reset() {
+    scan_offset_ = 0;
+    header_length_ = 0;
+    content_length_ = 0;
+    consumed_ = 0;
+    error_status_ = 0;
+    error_ = "";
+}
+
+HttpRequestParser::Result HttpRequestParser::Fail(int status, const char* message) {
+    error_status_ = status;
+    error_ = message;
+    return Result::Error;
+}
+
+HttpRequestParser::Result HttpRequestParser::Parse(const char* data, size_t size, HttpRequest& request) {
+    bool head_parsed = false;
+
+    if (header_length_ == 0) {
+        // Resume the terminator search a few bytes back in case it straddled reads
+        size_t start = scan_offset_ > 3 ? scan_offset_ - 3 : 0;
+        size_t end = std::string_view(data, size).find("\r\n\r\n", start);
+        if (end == std::string_view::npos) {
+            scan_offset_ = size;
+            if (size > max_header_bytes_) {
+                return Fail(431, "Request headers too large");
+            }
+            return Result::Incomplete;
+        }
+        // A head that arrived whole in one read is held to the same limit
+        if (end + 4 > max_header_bytes_) {
+            return Fail(431, "Request headers too large");
+        }
+        header_length_ = end + 4;
+
+        request.Clear();
+        if (!ParseHead(data, request)) {
+            return Result::Error;
+        }
+        head_parsed = true;
+    }
+
+    if (size < header_length_ + content_length_) {
+        return Result::Incomplete;
+    }
+
+    // The buffer may have moved since the head was parsed; re-point the views
+    if (!head_parsed) {
+        request.Clear();
+        ParseHead(data, request);
+    }
+    request.body = std::string_view(data + header_length_, content_length_);
+    consumed_ = header_length_ + content_length_;
+    return Result::Complete;
+}
+
+bool HttpRequestParser::ParseHead(const char* data, HttpRequest& request) {
+    std::string_view head(data, header_length_ - 2);   // Keep each line's CRLF, drop the blank line
+
+    // Request line: METHOD SP target SP version
+    size_t line_end = head.find("\r\n");
+    std::string_view line = head.substr(0, line_end);
+    size_t first_space = line.find(' ');
+    size_t second_space = first_space == std::string_view::npos ? first_space : line.find(' ', first_space + 1);
+    if (first_space == 0 || second_space == std::string_view::npos || second_space == first_space + 1) {
+        Fail(400, "Malformed request line");
+        return false;
+    }
+    request.method = line.substr(0, first_space);
+    request.target = line.substr(first_space + 1, second_space - first_space - 1);
+    request.version = line.substr(second_space + 1);
+    if (request.version.substr(0, 5) != "HTTP/") {
+        Fail(400, "Malformed request line");
+        return false;
+    }
+
+    size_t query_start = request.target.find('?');
+    request.path = request.target.substr(0, query_start);
+    if (query_start != std::string_view::npos) {
+        request.query = request.target.substr(query_start + 1);
+    }
+
+    // Header fields
+    size_t position = line_end + 2;
+    while (position < head.size()) {
+        size_t next = head.find("\r\n", position);
+        std::string_view field = head.substr(position, next - position);
+        size_t colon = field.find(':');
+        if (colon == std::string_view::npos || colon == 0) {
+            Fail(400, "Malformed header field");
+            return false;
+        }
+        request.headers.push_back({field.substr(0, colon), Trim(field.substr(colon + 1))});
+        position = next + 2;
+    }
+
+    if (!request.Header("Transfer-Encoding").empty()) {
+        Fail(501, "Chunked request bodies are not supported");
+        return false;
+    }
+
+    content_length_ = 0;
+    std::string_view length = request.Header("Content-Length");
+    for (char c : length) {
+        if (c < '0' || c > '9') {
+            Fail(400, "Invalid Content-Length");
+            return false;
+        }
+        content_length_ = content_length_ * 10 + static_cast<size_t>(c - '0');
+        if (content_length_ > max_body_bytes_) {
+            Fail(413, "Request body too large");
+            return false;
+        }
+    }
+
+    std::string_view connection = request.Header("Connection");
+    if (request.version == "HTTP/1.1") {
+        request.keep_alive = !ContainsTokenIgnoreCase(connection, "close");
+    } else {
+        request.keep_alive = ContainsTokenIgnoreCase(connection, "keep-alive");
+    }
+    return true;
+}
@@ -0,0 +1,152 @@
+#include "http_router.h"
+
+namespace {
+
+// Splits "/a/b/c" into segments; repeated and trailing slashes are ignored
+template <typename F>
+void ForEachSegment(std::string_view path, F&& fn) {
+    size_t position = 0;
+    while (position < path.size()) {
+        if (path[position] == '/') {
+            ++position;
+            continue;
+        }
+        size_t end = path.find('/', position);
+        if (end == std::string_view::npos) end = path.size();
+        if (!fn(path.substr(position, end - position))) {
+            return;
+        }
+        position = end;
+    }
+}
+
+bool ParseInt(std::string_view text, int& value) {
+    if (text.empty() || text.size() > 9) {
+        return false;
+    }
+    int result = 0;
+    for (char c : text) {
+        if (c < '0' || c > '9') return false;
+        result = result * 10 + (c - '0');
+    }
+    value = result;
+    return true;
+}
+
+} // namespace
+
+int RouteParams::Get(std::string_view name) const {
+    for (size_t i = 0; i < count_; ++i) {
+        if (names_[i] == name) return values_[i];
+    }
+    return 0;
+}
+
+void RouteParams::Clear() {
+    count_ = 0;
+    valid_ = true;
+    invalid_name_ = {};
+}
+
+HttpRouter::HttpRouter() {
+    AddNode();   // Root
+}
+
+int HttpRouter::AddNode() {
+    nodes_.emplace_back();
+    for (int& handler : nodes_.back().handlers) {
+        handler = -1;
+    }
+    return static_cast<int>(nodes_.size() - 1);
+}
+
+int HttpRouter::MethodIndex(std::string_view method) {
+    if (method == "GET") return kGet;
+    if (method == "POST") return kPost;
+    if (method == "PUT") return kPut;
+    if (method == "DELETE") return kDelete;
+    if (method == "PATCH") return kPatch;
+    return -1;
+}
+
+void HttpRouter::Add(std::string_view method, std::string_view pattern, RouteHandler handler) {
+    int method_index = MethodIndex(method);
+    if (method_index < 0) {
+        return;
+    }
+
+    int node = 0;
+    ForEachSegment(pattern, [this, &node](std::string_view segment) {
+        if (segment.size() > 2 && segment.front() == '{' && segment.back() == '}') {
+            if (nodes_[node].param_child < 0) {
+                int child = AddNode();
+                nodes_[node].param_child = child;
+                nodes_[node].param_name = std::string(segment.substr(1, segment.size() - 2));
+            }
+            node = nodes_[node].param_child;
+            return true;
+        }
+
+        for (const auto& literal : nodes_[node].literals) {
+            if (literal.first == segment) {
+                node = literal.second;
+                return true;
+            }
+        }
+        int child = AddNode();
+        nodes_[node].literals.emplace_back(std::string(segment), child);
+        node = child;
+        return true;
+    });
+
+    nodes_[node].handlers[method_index] = static_cast<int>(handlers_.size());
+    handlers_.push_back(std::move(handler));
+}
+
+HttpRouter::Result HttpRouter::Find(std::string_view method, std::string_view path,
+                                    const RouteHandler*& handler, RouteParams& params) const {
+    handler = nullptr;
+    params.Clear();
+
+    int node = 0;
+    ForEachSegment(path, [this, &node, &params](std::string_view segment) {
+        const Node& current = nodes_[node];
+        for (const auto& literal : current.literals) {
+            if (literal.first == segment) {
+                node = literal.second;
+                return true;
+            }
+        }
+        if (current.param_child < 0 || params.count_ == RouteParams::kMaxParams) {
+            node = -1;
+            return false;
+        }
+
+        int value = 0;
+        if (!ParseInt(segment, value) && params.valid_) {
+            params.valid_ = false;
+            params.invalid_name_ = current.param_name;
+        }
+        params.names_[params.count_] = current.param_name;
+        params.values_[params.count_] = value;
+        params.count_++;
+        node = current.param_child;
+        return true;
+    });
+
+    if (node < 0) {
+        return Result::NotFound;
+    }
+
+    const Node& match = nodes_[node];
+    int method_index = MethodIndex(method);
+    if (method_index < 0 || match.handlers[method_index] < 0) {
+        for (int index : match.handlers) {
+            if (index >= 0) return Result::MethodNotAllowed;
+        }
+        return Result::NotFound;
+    }
+
+    handler = &handlers_[match.handlers[method_index]];
+    return Result::Found;
+}
@@ -0,0 +1,591 @@
+#include "json.h"
+#include <algorithm>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define JSON_USE_SSE2 1
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+#endif
+
+namespace {
+
+// Deeper documents are rejected rather than risking the stack
+constexpr int kMaxReadDepth = 32;
+
+#ifdef JSON_USE_SSE2
+int LowestSetBit(int mask) {
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward(&index, static_cast<unsigned long>(mask));
+    return static_cast<int>(index);
+#else
+    return __builtin_ctz(static_cast<unsigned>(mask));
+#endif
+}
+#endif
+
+// Bytes that must be escaped inside a JSON string
+struct EscapeTable {
+    bool needs_escape[256] = {};
+    constexpr EscapeTable() {
+        for (int c = 0; c < 0x20; ++c) needs_escape[c] = true;
+        needs_escape[static_cast<unsigned char>('"')] = true;
+        needs_escape[static_cast<unsigned char>('\\')] = true;
+    }
+};
+constexpr EscapeTable kEscapeTable;
+
+#ifdef JSON_USE_SSE2
+// Bit n set if byte n of the 16 at data needs escaping
+int EscapeMask16(const char* data) {
+    const __m128i quote = _mm_set1_epi8('"');
+    const __m128i backslash = _mm_set1_epi8('\\');
+    const __m128i control_max = _mm_set1_epi8(0x1F);
+    __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(data));
+    // Unsigned c <= 0x1F exactly when max(c, 0x1F) == 0x1F
+    __m128i control = _mm_cmpeq_epi8(_mm_max_epu8(chunk, control_max), control_max);
+    __m128i special = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                                                _mm_cmpeq_epi8(chunk, backslash)),
+                                   control);
+    return _mm_movemask_epi8(special);
+}
+#endif
+
+// Offset of the first byte that needs escaping (quote, backslash or a
+// control character), or size if the whole run can be copied verbatim
+size_t FindEscape(const char* data, size_t size) {
+#ifdef JSON_USE_SSE2
+    if (size >= 16) {
+        for (size_t i = 0; i + 16 <= size; i += 16) {
+            int mask = EscapeMask16(data + i);
+            if (mask != 0) return i + LowestSetBit(mask);
+        }
+        // The last 16 bytes overlap ones already found clean, so any hit is new
+        int mask = EscapeMask16(data + size - 16);
+        return mask != 0 ? size - 16 + LowestSetBit(mask) : size;
+    }
+#endif
+    for (size_t i = 0; i < size; ++i) {
+        if (kEscapeTable.needs_escape[static_cast<unsigned char>(data[i])]) return i;
+    }
+    return size;
+}
+
+// Writes the escape sequence for c to out and returns its length (2 or 6)
+size_t EscapeSequence(unsigned char c, char* out) {
+    static const char kHex[] = "0123456789abcdef";
+    char short_form = 0;
+    switch (c) {
+        case '"': short_form = '"'; break;
+        case '\\': short_form = '\\'; break;
+        case '\b': short_form = 'b'; break;
+        case '\f': short_form = 'f'; break;
+        case '\n': short_form = 'n'; break;
+        case '\r': short_form = 'r'; break;
+        case '\t': short_form = 't'; break;
+    }
+    out[0] = '\\';
+    if (short_form) {
+        out[1] = short_form;
+        return 2;
+    }
+    out[1] = 'u';
+    out[2] = '0';
+    out[3] = '0';
+    out[4] = kHex[c >> 4];
+    out[5] = kHex[c & 0xF];
+    return 6;
+}
+
+void AppendUtf8(std::string& out, uint32_t code_point) {
+    if (code_point < 0x80) {
+        out += static_cast<char>(code_point);
+    } else if (code_point < 0x800) {
+        out += static_cast<char>(0xC0 | (code_point >> 6));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else if (code_point < 0x10000) {
+        out += static_cast<char>(0xE0 | (code_point >> 12));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    } else {
+        out += static_cast<char>(0xF0 | (code_point >> 18));
+        out += static_cast<char>(0x80 | ((code_point >> 12) & 0x3F));
+        out += static_cast<char>(0x80 | ((code_point >> 6) & 0x3F));
+        out += static_cast<char>(0x80 | (code_point & 0x3F));
+    }
+}
+
+int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+}
+
+bool ParseHex4(const char* p, uint32_t& value) {
+    value = 0;
+    for (int i = 0; i < 4; ++i) {
+        int digit = HexValue(p[i]);
+        if (digit < 0) return false;
+        value = (value << 4) | static_cast<uint32_t>(digit);
+    }
+    return true;
+}
+
+// Position in a document being read; every Skip* leaves p just past what it consumed
+struct Cursor {
+    const char* p;
+    const char* end;
+};
+
+void SkipWhitespace(Cursor& cursor) {
+    while (cursor.p < cursor.end &&
+           (*cursor.p == ' ' || *cursor.p == '\t' || *cursor.p == '\n' || *cursor.p == '\r')) {
+        ++cursor.p;
+    }
+}
+
+bool Consume(Cursor& cursor, char c) {
+    SkipWhitespace(cursor);
+    if (cursor.p == cursor.end || *cursor.p != c) return false;
+    ++cursor.p;
+    return true;
+}
+
+// Expects p at the opening quote; contents is the raw text between the quotes
+bool SkipString(Cursor& cursor, std::string_view& contents, bool& escaped) {
+    if (cursor.p == cursor.end || *cursor.p != '"') return false;
+    const char* start = ++cursor.p;
+    escaped = false;
+    while (cursor.p < cursor.end) {
+        unsigned char c = static_cast<unsigned char>(*cursor.p);
+        if (c == '"') {
+            contents = std::string_view(start, static_cast<size_t>(cursor.p - start));
+            ++cursor.p;
+            return true;
+        }
+        if (c < 0x20) return false;
+        if (c == '\\') {
+            escaped = true;
+            if (++cursor.p == cursor.end) return false;
+            switch (*cursor.p) {
+                case '"': case '\\': case '/': case 'b': case 'f': case 'n': case 'r': case 't':
+                    break;
+                case 'u': {
+                    uint32_t unit;
+                    if (cursor.end - cursor.p < 5 || !ParseHex4(cursor.p + 1, unit)) return false;
+                    cursor.p += 4;
+                    break;
+                }
+                default:
+                    return false;
+            }
+        }
+        ++cursor.p;
+    }
+    return false;
+}
+
+bool SkipDigits(Cursor& cursor) {
+    const char* start = cursor.p;
+    while (cursor.p < cursor.end && *cursor.p >= '0' && *cursor.p <= '9') ++cursor.p;
+    return cursor.p != start;
+}
+
+bool SkipNumber(Cursor& cursor) {
+    if (cursor.p < cursor.end && *cursor.p == '-') ++cursor.p;
+    if (cursor.p < cursor.end && *cursor.p == '0') {
+        ++cursor.p;
+    } else if (!SkipDigits(cursor)) {
+        return false;
+    }
+    if (cursor.p < cursor.end && *cursor.p == '.') {
+        ++cursor.p;
+        if (!SkipDigits(cursor)) return false;
+    }
+    if (cursor.p < cursor.end && (*cursor.p == 'e' || *cursor.p == 'E')) {
+        ++cursor.p;
+        if (cursor.p < cursor.end && (*cursor.p == '+' || *cursor.p == '-')) ++cursor.p;
+        if (!SkipDigits(cursor)) return false;
+    }
+    return true;
+}
+
+bool SkipLiteral(Cursor& cursor, std::string_view literal) {
+    if (static_cast<size_t>(cursor.end - cursor.p) < literal.size() ||
+        std::string_view(cursor.p, literal.size()) != literal) {
+        return false;
+    }
+    cursor.p += literal.size();
+    return true;
+}
+
+bool SkipValue(Cursor& cursor, int depth);
+
+bool SkipContainer(Cursor& cursor, int depth, bool object) {
+    if (depth > kMaxReadDepth) return false;
+    char close = object ? '}' : ']';
+    ++cursor.p;
+    SkipWhitespace(cursor);
+    if (cursor.p < cursor.end && *cursor.p == close) {
+        ++cursor.p;
+        return true;
+    }
+    while (true) {
+        if (object) {
+            std::string_view key;
+            bool escaped;
+            SkipWhitespace(cursor);
+            if (!SkipString(cursor, key, escaped) || !Consume(cursor, ':')) return false;
+        }
+        if (!SkipValue(cursor, depth + 1)) return false;
+        SkipWhitespace(cursor);
+        if (cursor.p == cursor.end) return false;
+        if (*cursor.p == close) {
+            ++cursor.p;
+            return true;
+        }
+        if (*cursor.p != ',') return false;
+        ++cursor.p;
+    }
+}
+
+bool SkipValue(Cursor& cursor, int depth) {
+    SkipWhitespace(cursor);
+    if (cursor.p == cursor.end) return false;
+    switch (*cursor.p) {
+        case '{': return SkipContainer(cursor, depth, true);
+        case '[': return SkipContainer(cursor, depth, false);
+        case '"': {
+            std::string_view contents;
+            bool escaped;
+            return SkipString(cursor, contents, escaped);
+        }
+        case 't': return SkipLiteral(cursor, "true");
+        case 'f': return SkipLiteral(cursor, "false");
+        case 'n': return SkipLiteral(cursor, "null");
+        default: return SkipNumber(cursor);
+    }
+}
+
+// contents is the raw text of an already validated string
+void Unescape(std::string_view contents, std::string& out) {
+    out.clear();
+    out.reserve(contents.size());
+    for (size_t i = 0; i < contents.size(); ++i) {
+        char c = contents[i];
+        if (c != '\\') {
+            out += c;
+            continue;
+        }
+        c = contents[++i];
+        switch (c) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t unit;
+                ParseHex4(contents.data() + i + 1, unit);
+                i += 4;
+                if (unit >= 0xD800 && unit <= 0xDBFF && i + 6 < contents.size() &&
+                    contents[i + 1] == '\\' && contents[i + 2] == 'u') {
+                    uint32_t low;
+                    if (ParseHex4(contents.data() + i + 3, low) && low >= 0xDC00 && low <= 0xDFFF) {
+                        unit = 0x10000 + ((unit - 0xD800) << 10) + (low - 0xDC00);
+                        i += 6;
+                    }
+                }
+                if (unit >= 0xD800 && unit <= 0xDFFF) {
+                    unit = 0xFFFD;   // Unpaired surrogate
+                }
+                AppendUtf8(out, unit);
+                break;
+            }
+            default: out += c; break;   // '"', '\\' and '/'
+        }
+    }
+}
+
+bool ParseIntValue(std::string_view text, int& value) {
+    int result = 0;
+    auto parsed = std::from_chars(text.data(), text.data() + text.size(), result);
+    if (parsed.ec != std::errc() || parsed.ptr != text.data() + text.size()) {
+        return false;
+    }
+    value = result;
+    return true;
+}
+
+} // namespace
+
+JsonWriter::JsonWriter(size_t reserve) : buffer_(std::max<size_t>(reserve, 256)) {}
+
+void JsonWriter::Clear() {
+    size_ = 0;
+    has_elements_ = 0;
+    depth_ = 0;
+    after_key_ = false;
+}
+
+bool JsonWriter::TakeSeparator() {
+    if (after_key_) {
+        after_key_ = false;
+        return false;
+    }
+    uint64_t bit = uint64_t(1) << depth_;
+    bool comma = (has_elements_ & bit) != 0;
+    has_elements_ |= bit;
+    return comma;
+}
+
+char* JsonWriter::Extend(size_t bytes) {
+    if (size_ + bytes > buffer_.size()) {
+        buffer_.resize(std::max(buffer_.size() * 2, size_ + bytes));
+    }
+    char* out = buffer_.data() + size_;
+    size_ += bytes;
+    return out;
+}
+
+void JsonWriter::Write(bool comma, std::string_view text) {
+    char* out = Extend(text.size() + comma);
+    if (comma) *out++ = ',';
+    std::memcpy(out, text.data(), text.size());
+}
+
+void JsonWriter::WriteQuoted(bool comma, std::string_view value, std::string_view suffix) {
+    size_t run = FindEscape(value.data(), value.size());
+    if (run == value.size()) {
+        // Common case, nothing to escape: one bounds check and straight copies
+        char* out = Extend(comma + value.size() + 2 + suffix.size());
+        if (comma) *out++ = ',';
+        *out++ = '"';
+        std::memcpy(out, value.data(), value.size());
+        out += value.size();
+        *out++ = '"';
+        std::memcpy(out, suffix.data(), suffix.size());
+        return;
+    }
+
+    Write(comma, "\"");
+    while (true) {
+        std::memcpy(Extend(run), value.data(), run);
+        if (run == value.size()) break;
+        char escape[6];
+        size_t length = EscapeSequence(static_cast<unsigned char>(value[run]), escape);
+        std::memcpy(Extend(length), escape, length);
+        value.remove_prefix(run + 1);
+        run = FindEscape(value.data(), value.size());
+    }
+    Write(false, "\"");
+    Write(false, suffix);
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+    Write(TakeSeparator(), "{");
+    ++depth_;
+    has_elements_ &= ~(uint64_t(1) << depth_);
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+    --depth_;
+    Write(false, "}");
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginArray() {
+    Write(TakeSeparator(), "[");
+    ++depth_;
+    has_elements_ &= ~(uint64_t(1) << depth_);
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndArray() {
+    --depth_;
+    Write(false, "]");
+    return *this;
+}
+
+JsonWriter& JsonWriter::Key(std::string_view key) {
+    WriteQuoted(TakeSeparator(), key, ":");
+    after_key_ = true;
+    return *this;
+}
+
+JsonWriter& JsonWriter::String(std::string_view value) {
+    WriteQuoted(TakeSeparator(), value, {});
+    return *this;
+}
+
+JsonWriter& JsonWriter::StringOrNull(std::string_view value) {
+    return value.empty() ? Null() : String(value);
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    Write(TakeSeparator(), std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::UInt(uint64_t value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    Write(TakeSeparator(), std::string_view(digits, static_cast<size_t>(result.ptr - digits)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::Double(double value) {
+    if (!std::isfinite(value)) {
+        return Null();
+    }
+    // Same six significant digits the ostream-based handlers produced
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%.6g", value);
+    Write(TakeSeparator(), std::string_view(digits, static_cast<size_t>(length)));
+    return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+    Write(TakeSeparator(), value ? "true" : "false");
+    return *this;
+}
+
+JsonWriter& JsonWriter::Null() {
+    Write(TakeSeparator(), "null");
+    return *this;
+}
+
+void JsonWriter::AppendEscaped(std::string& out, std::string_view value) {
+    while (!value.empty()) {
+        size_t run = FindEscape(value.data(), value.size());
+        out.append(value.data(), run);
+        if (run == value.size()) {
+            break;
+        }
+        char escape[6];
+        out.append(escape, EscapeSequence(static_cast<unsigned char>(value[run]), escape));
+        value.remove_prefix(run + 1);
+    }
+}
+
+bool JsonReader::Parse(std::string_view json) {
+    json_ = json;
+    Cursor cursor{json.data(), json.data() + json.size()};
+    SkipWhitespace(cursor);
+    valid_ = cursor.p < cursor.end && *cursor.p == '{' && SkipValue(cursor, 0);
+    SkipWhitespace(cursor);
+    valid_ = valid_ && cursor.p == cursor.end;
+    return valid_;
+}
+
+std::string_view JsonReader::Find(std::string_view key) const {
+    if (!valid_) {
+        return {};
+    }
+
+    // The document was validated by Parse(), so only the structure is walked here
+    Cursor cursor{json_.data(), json_.data() + json_.size()};
+    Consume(cursor, '{');
+    SkipWhitespace(cursor);
+    std::string unescaped;
+    while (cursor.p < cursor.end && *cursor.p == '"') {
+        std::string_view name;
+        bool escaped;
+        SkipString(cursor, name, escaped);
+        Consume(cursor, ':');
+        SkipWhitespace(cursor);
+        const char* value_start = cursor.p;
+        SkipValue(cursor, 1);
+
+        bool match = name == key;
+        if (escaped) {
+            Unescape(name, unescaped);
+            match = unescaped == key;
+        }
+        if (match) {
+            return std::string_view(value_start, static_cast<size_t>(cursor.p - value_start));
+        }
+        Consume(cursor, ',');
+        SkipWhitespace(cursor);
+    }
+    return {};
+}
+
+bool JsonReader::Has(std::string_view key) const {
+    return !Find(key).empty();
+}
+
+bool JsonReader::GetInt(std::string_view key, int& value) const {
+    std::string_view text = Find(key);
+    return !text.empty() && ParseIntValue(text, value);
+}
+
+bool JsonReader::GetString(std::string_view key, std::string& value) const {
+    std::string_view text = Find(key);
+    if (text.empty() || text.front() != '"') {
+        return false;
+    }
+    std::string_view contents = text.substr(1, text.size() - 2);
+    if (contents.find('\\') == std::string_view::npos) {
+        value.assign(contents.data(), contents.size());
+    } else {
+        Unescape(contents, value);
+    }
+    return true;
+}
+
+bool JsonReader::GetIntArray(std::string_view key, std::vector<int>& values) const {
+    std::string_view text = Find(key);
+    if (text.empty() || text.front() != '[') {
+        return false;
+    }
+
+    values.clear();
+    Cursor cursor{text.data() + 1, text.data() + text.size()};
+    SkipWhitespace(cursor);
+    while (cursor.p < cursor.end && *cursor.p != ']') {
+        const char* start = cursor.p;
+        if (!SkipValue(cursor, 1)) return false;
+        int value;
+        if (!ParseIntValue(std::string_view(start, static_cast<size_t>(cursor.p - start)), value)) {
+            return false;
+        }
+        values.push_back(value);
+        Consume(cursor, ',');
+        SkipWhitespace(cursor);
+    }
+    return true;
+}
+
+bool JsonReader::GetObjectArray(std::string_view key, std::vector<JsonReader>& objects) const {
+    std::string_view text = Find(key);
+    if (text.empty() || text.front() != '[') {
+        return false;
+    }
+
+    objects.clear();
+    Cursor cursor{text.data() + 1, text.data() + text.size()};
+    SkipWhitespace(cursor);
+    while (cursor.p < cursor.end && *cursor.p != ']') {
+        const char* start = cursor.p;
+        if (*start != '{' || !SkipValue(cursor, 1)) return false;
+        // Already validated as part of this document
+        JsonReader object;
+        object.json_ = std::string_view(start, static_cast<size_t>(cursor.p - start));
+        object.valid_ = true;
+        objects.push_back(object);
+        Consume(cursor, ',');
+        SkipWhitespace(cursor);
+    }
+    return true;
+}
@@ -0,0 +1,124 @@
+#include "latency_histogram.h"
+#include <algorithm>
+#include <cmath>
+
+// Value-initialized, so the buckets are zeroed in bulk rather than one atomic
+// store at a time: every route change makes two of these
+LatencyHistogram::LatencyHistogram() : buckets_(new std::atomic<uint64_t>[kBucketCount]()) {}
+
+size_t LatencyHistogram::BucketIndex(uint64_t value_ns) {
+    value_ns = std::min(value_ns, kMaxValueNs - 1);
+    if (value_ns < 2 * kSubBucketCount) {
+        return static_cast<size_t>(value_ns);   // Exact below 64 ns
+    }
+#if defined(__GNUC__) || defined(__clang__)
+    int msb = 63 - __builtin_clzll(value_ns);
+#else
+    int msb = 63;
+    while (!(value_ns >> msb)) {
+        --msb;
+    }
+#endif
+    int shift = msb - kSubBucketBits;
+    return static_cast<size_t>((shift + 1) * kSubBucketCount + ((value_ns >> shift) - kSubBucketCount));
+}
+
+uint64_t LatencyHistogram::BucketUpperBound(size_t index) {
+    if (index < 2 * kSubBucketCount) {
+        return index;
+    }
+    uint64_t shift = index / kSubBucketCount - 1;
+    uint64_t sub_bucket = index % kSubBucketCount + kSubBucketCount;
+    return ((sub_bucket + 1) << shift) - 1;
+}
+
+void LatencyHistogram::Record(uint64_t value_ns) {
+    uint64_t resets = resets_requested_.load(std::memory_order_acquire);
+    if (resets != resets_applied_.load(std::memory_order_relaxed)) {
+        Clear();
+        resets_applied_.store(resets, std::memory_order_release);
+    }
+
+    // Single writer: plain load + store instead of locked read-modify-writes
+    std::atomic<uint64_t>& bucket = buckets_[BucketIndex(value_ns)];
+    bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    sum_ns_.store(sum_ns_.load(std::memory_order_relaxed) + value_ns, std::memory_order_relaxed);
+    if (value_ns > max_ns_.load(std::memory_order_relaxed)) {
+        max_ns_.store(value_ns, std::memory_order_relaxed);
+    }
+}
+
+void LatencyHistogram::Reset() {
+    resets_requested_.fetch_add(1, std::memory_order_release);
+}
+
+void LatencyHistogram::Clear() {
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        buckets_[i].store(0, std::memory_order_relaxed);
+    }
+    sum_ns_.store(0, std::memory_order_relaxed);
+    max_ns_.store(0, std::memory_order_relaxed);
+}
+
+bool LatencyHistogram::ResetPending() const {
+    return resets_requested_.load(std::memory_order_acquire) != resets_applied_.load(std::memory_order_acquire);
+}
+
+uint64_t LatencyHistogram::ValueAtQuantile(double fraction) const {
+    if (ResetPending()) {
+        return 0;
+    }
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        total += buckets_[i].load(std::memory_order_relaxed);
+    }
+    if (total == 0) {
+        return 0;
+    }
+
+    uint64_t target = std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(fraction * total)));
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        seen += buckets_[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(BucketUpperBound(i), max_ns_.load(std::memory_order_relaxed));
+        }
+    }
+    return max_ns_.load(std::memory_order_relaxed);
+}
+
+LatencyHistogram::Summary LatencyHistogram::Summarize() const {
+    // One pass over the buckets for every quantile
+    static constexpr double kQuantiles[] = {0.5, 0.99, 0.999};
+    if (ResetPending()) {
+        return Summary();
+    }
+    uint64_t counts[kBucketCount];
+    uint64_t total = 0;
+    for (size_t i = 0; i < kBucketCount; ++i) {
+        counts[i] = buckets_[i].load(std::memory_order_relaxed);
+        total += counts[i];
+    }
+
+    Summary summary;
+    summary.count = total;
+    uint64_t max_ns = max_ns_.load(std::memory_order_relaxed);
+    summary.max_ms = max_ns / 1e6;
+    summary.sum_ms = sum_ns_.load(std::memory_order_relaxed) / 1e6;
+    if (total == 0) {
+        return summary;
+    }
+    summary.mean_ms = summary.sum_ms / total;
+
+    double* outputs[] = {&summary.p50_ms, &summary.p99_ms, &summary.p999_ms};
+    size_t next = 0;
+    uint64_t seen = 0;
+    for (size_t i = 0; i < kBucketCount && next < 3; ++i) {
+        seen += counts[i];
+        while (next < 3 && seen >= std::max<uint64_t>(1, static_cast<uint64_t>(std::ceil(kQuantiles[next] * total)))) {
+            *outputs[next] = std::min(BucketUpperBound(i), max_ns) / 1e6;
+            ++next;
+        }
+    }
+    return summary;
+}
@@ -0,0 +1,250 @@
+#include "logger.h"
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <ctime>
+
+namespace {
+// Writer sleep when the ring is empty; Warn and Error wake it immediately
+constexpr auto kWriterIdleWait = std::chrono::milliseconds(20);
+// Records formatted per batch before the batch is written out
+constexpr size_t kMaxBatchRecords = 256;
+
+const char* LevelName(LogLevel level) {
+    switch (level) {
+        case LogLevel::Debug: return "DEBUG";
+        case LogLevel::Info: return "INFO ";
+        case LogLevel::Warn: return "WARN ";
+        case LogLevel::Error: return "ERROR";
+        default: return "     ";
+    }
+}
+
+const char* BaseName(const char* path) {
+    const char* base = path;
+    for (const char* p = path; *p; ++p) {
+        if (*p == '/' || *p == '\\') base = p + 1;
+    }
+    return base;
+}
+
+int64_t NowMicros() {
+    auto now = std::chrono::system_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+// "2026-01-31 12:00:00", cached per second since every line in a burst shares it
+void AppendTimestamp(std::string& out, int64_t timestamp_us) {
+    thread_local int64_t cached_second = -1;
+    thread_local char cached[32];
+    int64_t second = timestamp_us / 1000000;
+    if (second != cached_second) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm local{};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        std::strftime(cached, sizeof(cached), "%Y-%m-%d %H:%M:%S", &local);
+        cached_second = second;
+    }
+    char millis[8];
+    std::snprintf(millis, sizeof(millis), ".%03d", static_cast<int>((timestamp_us / 1000) % 1000));
+    out += cached;
+    out += millis;
+}
+}
+
+std::atomic<uint8_t> Logger::min_level_{static_cast<uint8_t>(LogLevel::Info)};
+
+Logger& Logger::Instance() {
+    static Logger* instance = new Logger();
+    return *instance;
+}
+
+Logger::Logger()
+    : records_(new Record[kCapacity]), info_out_(stdout), error_out_(stderr) {
+    for (size_t i = 0; i < kCapacity; ++i) {
+        records_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+    writer_thread_ = std::thread(&Logger::WriterThread, this);
+    writer_thread_.detach();
+}
+
+void Logger::SetLevel(LogLevel level) {
+    min_level_.store(static_cast<uint8_t>(level), std::memory_order_relaxed);
+}
+
+LogLevel Logger::GetLevel() {
+    return static_cast<LogLevel>(min_level_.load(std::memory_order_relaxed));
+}
+
+bool Logger::ParseLevel(std::string_view name, LogLevel& level) {
+    if (name == "debug") level = LogLevel::Debug;
+    else if (name == "info") level = LogLevel::Info;
+    else if (name == "warn" || name == "warning") level = LogLevel::Warn;
+    else if (name == "error") level = LogLevel::Error;
+    else if (name == "off") level = LogLevel::Off;
+    else return false;
+    return true;
+}
+
+void Logger::SetOutputs(FILE* info_out, FILE* error_out) {
+    Flush();
+    info_out_.store(info_out);
+    error_out_.store(error_out);
+}
+
+bool Logger::Submit(LogLevel level, const char* file, int line, std::string_view text) {
+    // Bounded MPMC ring (Vyukov): a producer claims a position with one CAS
+    // and publishes the record by advancing its sequence number
+    uint64_t position = enqueue_position_.load(std::memory_order_relaxed);
+    Record* record;
+    while (true) {
+        record = &records_[position & (kCapacity - 1)];
+        uint64_t sequence = record->sequence.load(std::memory_order_acquire);
+        int64_t lag = static_cast<int64_t>(sequence - position);
+        if (lag == 0) {
+            if (enqueue_position_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (lag < 0) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        } else {
+            position = enqueue_position_.load(std::memory_order_relaxed);
+        }
+    }
+
+    record->timestamp_us = NowMicros();
+    record->file = file;
+    record->line = line;
+    record->level = level;
+    record->length = static_cast<uint16_t>(std::min(text.size(), kMaxMessageLength));
+    std::memcpy(record->text, text.data(), record->length);
+    record->sequence.store(position + 1, std::memory_order_release);
+
+    if (level >= LogLevel::Warn) {
+        wake_.notify_one();
+    }
+    return true;
+}
+
+void Logger::Flush() {
+    uint64_t target = enqueue_position_.load(std::memory_order_acquire);
+    std::unique_lock<std::mutex> lock(wake_mutex_);
+    wake_.notify_one();
+    written_.wait(lock, [this, target] { return written_position_.load(std::memory_order_acquire) >= target; });
+}
+
+void Logger::WriterThread() {
+    std::string info_batch;
+    std::string error_batch;
+    while (true) {
+        if (!DrainOnce(info_batch, error_batch)) {
+            std::unique_lock<std::mutex> lock(wake_mutex_);
+            wake_.wait_for(lock, kWriterIdleWait);
+        }
+    }
+}
+
+bool Logger::DrainOnce(std::string& info_batch, std::string& error_batch) {
+    info_batch.clear();
+    error_batch.clear();
+
+    size_t drained = 0;
+    while (drained < kMaxBatchRecords) {
+        Record& record = records_[dequeue_position_ & (kCapacity - 1)];
+        if (record.sequence.load(std::memory_order_acquire) != dequeue_position_ + 1) {
+            break;
+        }
+
+        std::string& out = record.level >= LogLevel::Warn ? error_batch : info_batch;
+        AppendTimestamp(out, record.timestamp_us);
+        out += ' ';
+        out += LevelName(record.level);
+        out += ' ';
+        out += BaseName(record.file);
+        out += ':';
+        out += std::to_string(record.line);
+        out += ' ';
+        out.append(record.text, record.length);
+        out += '\n';
+
+        record.sequence.store(dequeue_position_ + kCapacity, std::memory_order_release);
+        ++dequeue_position_;
+        ++drained;
+    }
+
+    uint64_t dropped = dropped_.load(std::memory_order_relaxed);
+    if (dropped != reported_dropped_) {
+        AppendTimestamp(error_batch, NowMicros());
+        error_batch += " WARN  logger: " + std::to_string(dropped - reported_dropped_) +
+                       " messages dropped (queue full)\n";
+        reported_dropped_ = dropped;
+    }
+
+    if (!info_batch.empty()) {
+        FILE* out = info_out_.load();
+        std::fwrite(info_batch.data(), 1, info_batch.size(), out);
+        std::fflush(out);
+    }
+    if (!error_batch.empty()) {
+        FILE* out = error_out_.load();
+        std::fwrite(error_batch.data(), 1, error_batch.size(), out);
+        std::fflush(out);
+    }
+
+    if (drained > 0) {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex_);
+            written_position_.store(dequeue_position_, std::memory_order_release);
+        }
+        written_.notify_all();
+    }
+    return drained > 0;
+}
+
+LogMessage& LogMessage::operator<<(std::string_view text) {
+    size_t count = std::min(text.size(), sizeof(text_) - length_);
+    std::memcpy(text_ + length_, text.data(), count);
+    length_ += count;
+    return *this;
+}
+
+LogMessage& LogMessage::operator<<(double value) {
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%g", value);
+    return *this << std::string_view(digits, static_cast<size_t>(std::max(length, 0)));
+}
+
+LogMessage& LogMessage::operator<<(const void* pointer) {
+    char digits[32];
+    int length = std::snprintf(digits, sizeof(digits), "%p", pointer);
+    return *this << std::string_view(digits, static_cast<size_t>(std::max(length, 0)));
+}
+
+LogMessage& LogMessage::AppendSigned(long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+LogMessage& LogMessage::AppendUnsigned(unsigned long long value) {
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    return *this << std::string_view(digits, static_cast<size_t>(result.ptr - digits));
+}
+
+bool LogRateLimiter::Allow(uint32_t& suppressed) {
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t next = next_allowed_ns_.load(std::memory_order_relaxed);
+    if (now < next || !next_allowed_ns_.compare_exchange_strong(next, now + period_ns_, std::memory_order_relaxed)) {
+        suppressed_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    suppressed = suppressed_.exchange(0, std::memory_order_relaxed);
+    return true;
+}
@@ -1,19 +1,20 @@
-#include <iostream>
 #include <memory>
 #include <signal.h>
 #include <thread>
 #include <chrono>
 #include <cstdlib>
+#include "logger.h"
 #include "ndi_manager.h"
 #include "web_server.h"
 
 std::shared_ptr<WebServer> g_web_server;
 
 void SignalHandler(int signal) {
-    std::cout << "Received signal " << signal << ", shutting down..." << std::endl;
+    LOG_INFO("Received signal " << signal << ", shutting down...");
     if (g_web_server) {
         g_web_server->Stop();
     }
+    Logger::Instance().Flush();
     exit(0);
 }
 
@@ -21,11 +22,56 @@ int main(int argc, char* argv[]) {
     signal(SIGINT, SignalHandler);
     signal(SIGTERM, SignalHandler);
 
-    std::cout << "NDI Web Router starting..." << std::endl;
+    // Minimum log level: debug, info (default), warn, error or off
+    if (const char* log_level = std::getenv("NDI_ROUTER_LOG_LEVEL")) {
+        LogLevel level;
+        if (Logger::ParseLevel(log_level, level)) {
+            Logger::SetLevel(level);
+        }
+    }
+
+    LOG_INFO("NDI Web Router starting...");
 
-    auto ndi_manager = std::make_shared<NDIManager>();
+    auto ndi_manager = std::make_shared<NDIManager>(CreateSDKBackend());
+    
+    // Optional cap on capture worker threads (one per routed source, 0 = unlimited)
+    if (const char* max_workers = std::getenv("NDI_ROUTER_MAX_WORKERS")) {
+        ndi_manager->SetMaxSourceWorkers(static_cast<size_t>(std::atoi(max_workers)));
+    }
+    
+    // Receivers kept connected for unrouted sources so takes switch on the next frame
+    if (const char* warm_receivers = std::getenv("NDI_ROUTER_WARM_RECEIVERS")) {
+        ndi_manager->SetWarmReceiverBudget(static_cast<size_t>(std::atoi(warm_receivers)));
+    }
+    if (const char* warm_idle = std::getenv("NDI_ROUTER_WARM_RECEIVER_IDLE_SECONDS")) {
+        ndi_manager->SetWarmReceiverIdleTimeout(std::chrono::seconds(std::atoi(warm_idle)));
+    }
+    
+    // Route receive format: passthrough (native UYVY, default) or bgra
+    if (const char* receive_mode = std::getenv("NDI_ROUTER_RECEIVE_MODE")) {
+        ndi_manager->SetReceiveMode(std::string(receive_mode) == "bgra" ? ReceiveMode::BGRA : ReceiveMode::Passthrough);
+    }
+    
+    // Rate of the keep-alive slate sent to unrouted destinations (0 = off)
+    if (const char* slate_fps = std::getenv("NDI_ROUTER_SLATE_FPS")) {
+        ndi_manager->SetIdleSlateRate(std::atof(slate_fps));
+    }
+    
+    // Matrix size: source slots (default 16) and the destination slot limit
+    const char* source_slots = std::getenv("NDI_ROUTER_SOURCE_SLOTS");
+    const char* destination_slots = std::getenv("NDI_ROUTER_DESTINATION_SLOTS");
+    if (source_slots || destination_slots) {
+        MatrixSize size = ndi_manager->GetMatrixSize();
+        if (!ndi_manager->SetMatrixSize(source_slots ? std::atoi(source_slots) : size.source_slots,
+                                        destination_slots ? std::atoi(destination_slots) : size.destination_slots)) {
+            Logger::Instance().Flush();
+            return 1;
+        }
+    }
+    
     if (!ndi_manager->Initialize()) {
-        std::cerr << "Failed to initialize NDI Manager" << std::endl;
+        LOG_ERROR("Failed to initialize NDI Manager");
+        Logger::Instance().Flush();
         return 1;
     }
 
@@ -35,19 +81,27 @@ int main(int argc, char* argv[]) {
     }
 
     g_web_server = std::make_shared<WebServer>(port, ndi_manager);
+    
+    // HTTP I/O threads (Linux epoll backend)
+    if (const char* http_threads = std::getenv("NDI_ROUTER_HTTP_THREADS")) {
+        g_web_server->SetIoThreadCount(static_cast<size_t>(std::atoi(http_threads)));
+    }
+    
     if (!g_web_server->Start()) {
-        std::cerr << "Failed to start web server on port " << port << std::endl;
+        LOG_ERROR("Failed to start web server on port " << port);
+        Logger::Instance().Flush();
         return 1;
     }
 
-    std::cout << "NDI Web Router running on port " << port << std::endl;
-    std::cout << "Press Ctrl+C to stop" << std::endl;
+    LOG_INFO("NDI Web Router running on port " << port);
+    LOG_INFO("Press Ctrl+C to stop");
 
     while (g_web_server->IsRunning()) {
         std::this_thread::sleep_for(std::chrono::milliseconds(100));
     }
 
     ndi_manager->Shutdown();
-    std::cout << "NDI Web Router stopped" << std::endl;
+    LOG_INFO("NDI Web Router stopped");
+    Logger::Instance().Flush();
     return 0;
 }
\ No newline at end of file
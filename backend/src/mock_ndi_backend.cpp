@@ -0,0 +1,324 @@
+#include "mock_ndi_backend.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace {
+constexpr uint32_t kFrameMagic = 0x4d4f434b;   // "MOCK"
+
+// Written over the first bytes of every mock video frame
+struct FrameHeader {
+    uint32_t magic;
+    int32_t source_index;
+    uint64_t sequence;
+};
+
+int64_t ToNdiTimestamp(std::chrono::steady_clock::time_point when) {
+    // Steady-clock schedule to 100 ns UTC, the unit NDI timestamps use
+    auto offset = std::chrono::steady_clock::now() - when;
+    auto utc = std::chrono::system_clock::now().time_since_epoch() - offset;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(utc).count() / 100;
+}
+
+int64_t SteadyNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+struct MockNDIBackend::Receiver {
+    int source_index = -1;    // -1 when the name is not one of ours: never delivers
+    int frame_rate_N = 0;
+    int frame_rate_D = 0;
+    std::chrono::steady_clock::duration period{};
+    std::chrono::steady_clock::duration delay{};        // How late the next frame arrives
+    uint64_t jitter_state = 0;
+    std::chrono::steady_clock::time_point next_frame;
+    std::chrono::steady_clock::time_point last_frame;   // Schedule time of the last video frame
+    uint64_t sequence = 0;
+    bool audio_pending = false;
+    std::vector<float> audio;   // channels * max samples per frame, all source_index + 1
+
+    size_t frame_bytes = 0;
+    std::mutex pool_mutex;      // Frames are freed from whichever thread releases them last
+    std::vector<std::unique_ptr<uint8_t[]>> buffers;
+    std::vector<uint8_t*> free_buffers;
+    std::atomic<uint64_t> dropped_video{0};
+};
+
+struct MockNDIBackend::Sender {
+    std::mutex mutex;
+    MockSenderRecord record;
+};
+
+MockNDIBackend::MockNDIBackend(const MockSourceOptions& options) : options_(options) {
+    for (int i = 0; i < options_.source_count; ++i) {
+        source_indexes_.emplace(SourceName(i), i);
+    }
+}
+
+MockNDIBackend::~MockNDIBackend() {
+    std::lock_guard<std::mutex> lock(senders_mutex_);
+    for (Sender* sender : senders_) {
+        delete sender;
+    }
+}
+
+std::string MockNDIBackend::SourceName(int index) const {
+    return options_.host_name + " (Source " + std::to_string(index + 1) + ")";
+}
+
+std::vector<MockSenderRecord> MockNDIBackend::GetSenderRecords() const {
+    std::vector<MockSenderRecord> records;
+    std::lock_guard<std::mutex> lock(senders_mutex_);
+    records.reserve(senders_.size());
+    for (Sender* sender : senders_) {
+        std::lock_guard<std::mutex> sender_lock(sender->mutex);
+        records.push_back(sender->record);
+    }
+    return records;
+}
+
+NDIFinder MockNDIBackend::CreateFinder() {
+    return reinterpret_cast<NDIFinder>(this);
+}
+
+void MockNDIBackend::DestroyFinder(NDIFinder) {}
+
+bool MockNDIBackend::WaitForSources(NDIFinder, uint32_t timeout_ms) {
+    // The announced list never changes
+    std::this_thread::sleep_for(std::chrono::milliseconds(timeout_ms));
+    return false;
+}
+
+std::vector<NDISource> MockNDIBackend::GetCurrentSources(NDIFinder) {
+    std::vector<NDISource> sources;
+    sources.reserve(options_.source_count);
+    for (int i = 0; i < options_.source_count; ++i) {
+        NDISource source;
+        source.name = SourceName(i);
+        source.url = "mock://" + std::to_string(i + 1);
+        source.is_connected = true;
+        sources.push_back(std::move(source));
+    }
+    return sources;
+}
+
+NDIReceiver MockNDIBackend::CreateReceiver(const ReceiverSettings& settings) {
+    auto* receiver = new Receiver();
+    auto it = source_indexes_.find(settings.source_name);
+    if (it == source_indexes_.end()) {
+        return reinterpret_cast<NDIReceiver>(receiver);
+    }
+    MockSourceTiming timing;
+    if (static_cast<size_t>(it->second) < options_.source_timing.size()) {
+        timing = options_.source_timing[it->second];
+    }
+    receiver->frame_rate_N = timing.frame_rate_N > 0 ? timing.frame_rate_N : options_.frame_rate_N;
+    receiver->frame_rate_D = timing.frame_rate_N > 0 ? timing.frame_rate_D : options_.frame_rate_D;
+    if (receiver->frame_rate_N <= 0 || receiver->frame_rate_D <= 0) {
+        return reinterpret_cast<NDIReceiver>(receiver);
+    }
+
+    receiver->source_index = it->second;
+    receiver->jitter_state = static_cast<uint64_t>(it->second) + 1;
+    // A fast clock runs its frames (and the audio that goes with them) early
+    receiver->period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(receiver->frame_rate_D) / receiver->frame_rate_N /
+                                      (1.0 + timing.clock_skew_ppm / 1e6)));
+    // Spread the sources across one frame period, as independent cameras would be
+    receiver->next_frame = std::chrono::steady_clock::now() + std::chrono::milliseconds(options_.connect_delay_ms) +
+        receiver->period * receiver->source_index / std::max(1, options_.source_count);
+    receiver->frame_bytes = std::max<size_t>(sizeof(FrameHeader),
+        static_cast<size_t>(std::max(options_.width, 1)) * std::max(options_.height, 1) * 2);
+    if (options_.audio_channels > 0) {
+        int max_samples = static_cast<int>(
+            static_cast<int64_t>(options_.audio_sample_rate) * receiver->frame_rate_D / receiver->frame_rate_N) + 1;
+        receiver->audio.assign(static_cast<size_t>(max_samples) * options_.audio_channels,
+                               static_cast<float>(receiver->source_index + 1));
+    }
+    return reinterpret_cast<NDIReceiver>(receiver);
+}
+
+void MockNDIBackend::DestroyReceiver(NDIReceiver handle) {
+    delete reinterpret_cast<Receiver*>(handle);
+}
+
+CaptureResult MockNDIBackend::Capture(NDIReceiver handle, VideoFrame* video, AudioFrame* audio, uint32_t timeout_ms) {
+    Receiver& receiver = *reinterpret_cast<Receiver*>(handle);
+    auto now = std::chrono::steady_clock::now();
+
+    // The audio that belongs to the last video frame goes out right behind it
+    if (receiver.audio_pending) {
+        receiver.audio_pending = false;
+        if (audio) {
+            int64_t rate_D = static_cast<int64_t>(options_.audio_sample_rate) * receiver.frame_rate_D;
+            *audio = AudioFrame();
+            audio->sample_rate = options_.audio_sample_rate;
+            audio->channels = options_.audio_channels;
+            audio->samples = static_cast<int>(receiver.sequence * rate_D / receiver.frame_rate_N -
+                                              (receiver.sequence - 1) * rate_D / receiver.frame_rate_N);
+            audio->data = receiver.audio.data();
+            audio->channel_stride_in_bytes = audio->samples * static_cast<int>(sizeof(float));
+            audio->timestamp = ToNdiTimestamp(receiver.last_frame);
+            return CaptureResult::Audio;
+        }
+    }
+
+    auto deadline = now + std::chrono::milliseconds(timeout_ms);
+    auto arrival = receiver.next_frame + receiver.delay;
+    if (receiver.source_index < 0 || arrival > deadline) {
+        std::this_thread::sleep_until(deadline);
+        return CaptureResult::None;
+    }
+    if (arrival > now) {
+        std::this_thread::sleep_until(arrival);
+    } else {
+        // Behind schedule: frames beyond the queue depth were lost, as in a real receiver
+        auto behind = (now - receiver.next_frame) / receiver.period;
+        if (behind > options_.queue_depth) {
+            auto skipped = behind - options_.queue_depth;
+            receiver.next_frame += receiver.period * skipped;
+            receiver.sequence += static_cast<uint64_t>(skipped);
+            receiver.dropped_video.fetch_add(static_cast<uint64_t>(skipped), std::memory_order_relaxed);
+            dropped_video_.fetch_add(static_cast<uint64_t>(skipped), std::memory_order_relaxed);
+        }
+    }
+
+    receiver.last_frame = receiver.next_frame;
+    receiver.next_frame += receiver.period;
+    if (options_.jitter_us > 0) {
+        receiver.jitter_state = receiver.jitter_state * 6364136223846793005ULL + 1442695040888963407ULL;
+        receiver.delay = std::chrono::microseconds((receiver.jitter_state >> 33) % static_cast<uint64_t>(options_.jitter_us + 1));
+    }
+    ++receiver.sequence;
+    receiver.audio_pending = options_.audio_channels > 0;
+    if (!video) {
+        return CaptureResult::None;
+    }
+
+    uint8_t* buffer = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(receiver.pool_mutex);
+        if (receiver.free_buffers.empty()) {
+            // Left uninitialized: only the header is ever written or read
+            receiver.buffers.emplace_back(new uint8_t[receiver.frame_bytes]);
+            buffer = receiver.buffers.back().get();
+        } else {
+            buffer = receiver.free_buffers.back();
+            receiver.free_buffers.pop_back();
+        }
+    }
+    FrameHeader header{kFrameMagic, receiver.source_index, receiver.sequence};
+    std::memcpy(buffer, &header, sizeof(header));
+    outstanding_video_.fetch_add(1, std::memory_order_relaxed);
+
+    *video = VideoFrame();
+    video->xres = options_.width;
+    video->yres = options_.height;
+    video->fourcc = VideoFourCC::UYVY;
+    video->frame_rate_N = receiver.frame_rate_N;
+    video->frame_rate_D = receiver.frame_rate_D;
+    video->picture_aspect_ratio = options_.height > 0 ? static_cast<float>(options_.width) / options_.height : 0.0f;
+    video->data = buffer;
+    video->line_stride_in_bytes = options_.width * 2;
+    video->timestamp = ToNdiTimestamp(receiver.last_frame);
+    return CaptureResult::Video;
+}
+
+void MockNDIBackend::FreeVideo(NDIReceiver handle, const VideoFrame& frame) {
+    Receiver& receiver = *reinterpret_cast<Receiver*>(handle);
+    {
+        std::lock_guard<std::mutex> lock(receiver.pool_mutex);
+        receiver.free_buffers.push_back(frame.data);
+    }
+    outstanding_video_.fetch_sub(1, std::memory_order_relaxed);
+}
+
+void MockNDIBackend::FreeAudio(NDIReceiver, const AudioFrame&) {}
+
+ReceiverPerformance MockNDIBackend::GetPerformance(NDIReceiver handle) {
+    ReceiverPerformance performance;
+    performance.dropped_video_frames = reinterpret_cast<Receiver*>(handle)->dropped_video.load(std::memory_order_relaxed);
+    return performance;
+}
+
+NDISender MockNDIBackend::CreateSender(const std::string& name, bool, bool) {
+    auto* sender = new Sender();
+    sender->record.name = name;
+    std::lock_guard<std::mutex> lock(senders_mutex_);
+    senders_.push_back(sender);
+    return reinterpret_cast<NDISender>(sender);
+}
+
+void MockNDIBackend::DestroySender(NDISender handle) {
+    Sender* sender = reinterpret_cast<Sender*>(handle);
+    {
+        std::lock_guard<std::mutex> lock(senders_mutex_);
+        senders_.erase(std::remove(senders_.begin(), senders_.end(), sender), senders_.end());
+    }
+    delete sender;
+}
+
+void MockNDIBackend::RecordVideo(Sender& sender, const VideoFrame& frame, bool async) {
+    FrameHeader header{};
+    if (frame.data) {
+        std::memcpy(&header, frame.data, sizeof(header));
+    }
+    int source_index = header.magic == kFrameMagic ? header.source_index : -1;
+
+    std::lock_guard<std::mutex> lock(sender.mutex);
+    MockSenderRecord& record = sender.record;
+    if (record.video_frames > 0 && source_index != record.last_source_index) {
+        record.source_switches++;
+    }
+    record.video_frames++;
+    if (async) {
+        record.async_video_frames++;
+    }
+    record.last_xres = frame.xres;
+    record.last_yres = frame.yres;
+    record.last_source_index = source_index;
+    record.last_frame_sequence = source_index >= 0 ? header.sequence : 0;
+    if (options_.log_frames) {
+        MockFrameEvent event;
+        event.source_index = source_index;
+        event.timestamp = frame.timestamp;
+        event.sent_ns = SteadyNs();
+        record.frames.push_back(event);
+    }
+}
+
+void MockNDIBackend::SendVideo(NDISender handle, const VideoFrame& frame) {
+    RecordVideo(*reinterpret_cast<Sender*>(handle), frame, false);
+}
+
+void MockNDIBackend::SendVideoAsync(NDISender handle, const VideoFrame* frame) {
+    // Nothing is kept in flight, so a flush has nothing to wait for
+    if (frame) {
+        RecordVideo(*reinterpret_cast<Sender*>(handle), *frame, true);
+    }
+}
+
+void MockNDIBackend::SendAudio(NDISender handle, const AudioFrame& frame) {
+    Sender& sender = *reinterpret_cast<Sender*>(handle);
+    std::lock_guard<std::mutex> lock(sender.mutex);
+    sender.record.audio_frames++;
+    sender.record.audio_samples += static_cast<uint64_t>(frame.samples);
+    if (options_.log_frames) {
+        MockFrameEvent event;
+        event.audio = true;
+        event.source_index = frame.data && frame.samples > 0 ? static_cast<int>(frame.data[0]) - 1 : -1;
+        event.timestamp = frame.timestamp;
+        event.samples = frame.samples;
+        event.sample_rate = frame.sample_rate;
+        event.sent_ns = SteadyNs();
+        sender.record.frames.push_back(event);
+    }
+}
+
+int MockNDIBackend::GetConnectionCount(NDISender, uint32_t) {
+    return 0;
+}
@@ -1,246 +1,721 @@
 #include "ndi_manager.h"
-#include <iostream>
+#include "preview_encoder.h"
+#include "logger.h"
 #include <thread>
 #include <chrono>
 #include <random>
-#include <sstream>
-#include <iomanip>
+#include <cstdio>
 #include <algorithm>
 #include <set>
 #include <cctype>
 #include <cstdlib>
 #include <cstring>
+#include <iterator>
+#include <unordered_map>
+#include <unordered_set>
 
-NDIManager::NDIManager() : ndi_find_(nullptr), should_stop_routing_(false), is_updating_routes_(false), preview_receiver_(nullptr) {}
+namespace {
+// Default cap on concurrent capture workers (one thread per routed source)
+constexpr size_t kDefaultMaxSourceWorkers = 64;
+// Workers block for one frame period; these bound it before the first frame and for odd rates
+constexpr uint32_t kDefaultFramePeriodMs = 40;
+constexpr uint32_t kMinFramePeriodMs = 5;
+constexpr uint32_t kMaxFramePeriodMs = 100;
+// Supervisor housekeeping (status dump, snapshot reclaim, idle receiver expiry)
+constexpr auto kStatusInterval = std::chrono::seconds(10);
+constexpr auto kCleanupInterval = std::chrono::seconds(5);
+// Receiver pool: unrouted sources kept connected, and how long one that is in
+// no slot stays warm after its last route
+constexpr size_t kDefaultWarmReceiverBudget = 16;
+constexpr auto kDefaultWarmReceiverIdleTimeout = std::chrono::seconds(30);
+// Idle slate: a small black UYVY frame, built once and sent to unrouted destinations
+constexpr int kSlateWidth = 640;
+constexpr int kSlateHeight = 360;
+constexpr double kDefaultSlateFps = 2.0;
+constexpr double kMaxSlateFps = 30.0;
+// Rates a clocked destination accepts
+constexpr double kMinOutputFps = 1.0;
+constexpr double kMaxOutputFps = 240.0;
+constexpr int kMinOutputSampleRate = 8000;
+constexpr int kMaxOutputSampleRate = 192000;
+// Preview: encode at most this often, downscaled to fit this width
+constexpr auto kPreviewInterval = std::chrono::milliseconds(100);
+constexpr int kPreviewMaxWidth = 480;
+constexpr int kPreviewJpegQuality = 70;
+constexpr uint32_t kPreviewCaptureTimeoutMs = 100;
+// Change log entries kept for GET /api/matrix/changes; older clients resync
+constexpr size_t kMaxChangeLogEntries = 4096;
+// Matrix size until SetMatrixSize() says otherwise; destinations are created on demand
+constexpr int kDefaultSourceSlots = 16;
+constexpr int kDefaultDestinationSlots = SlotIndex::kMaxSlotNumber;
+// Longest the discovery thread blocks waiting for the network; bounds shutdown latency
+constexpr uint32_t kDiscoveryWaitMs = 250;
+// A source switched away from keeps feeding the destination until the new one
+// delivers its first video frame, for at most this long
+constexpr auto kCutHandoverTimeout = std::chrono::milliseconds(500);
+// NDI timestamps and timecodes count 100 ns units
+constexpr int64_t kNdiTicksPerSecond = 10000000;
+
+// Destinations are stored in allocation order; lists go out in slot order
+std::vector<MatrixDestination> SortedBySlot(std::vector<MatrixDestination> destinations) {
+    std::sort(destinations.begin(), destinations.end(),
+        [](const MatrixDestination& a, const MatrixDestination& b) { return a.slot_number < b.slot_number; });
+    return destinations;
+}
+
+uint32_t FramePeriodMs(const VideoFrame& frame) {
+    if (frame.frame_rate_N <= 0 || frame.frame_rate_D <= 0) {
+        return kDefaultFramePeriodMs;
+    }
+    uint32_t period = static_cast<uint32_t>((1000LL * frame.frame_rate_D + frame.frame_rate_N - 1) / frame.frame_rate_N);
+    return std::min(std::max(period, kMinFramePeriodMs), kMaxFramePeriodMs);
+}
+
+// Captured video frame on loan from the backend, shared by every destination it
+// is async-sent to. It goes back to the receiver when the last destination moves on.
+class CapturedVideoFrame : public SharedFrame {
+public:
+    CapturedVideoFrame(const void* owner, NDIBackend* backend, NDIReceiver receiver)
+        : SharedFrame(owner), backend_(backend), receiver_(receiver), frame_() {}
+    
+    void Hold(const VideoFrame& frame) {
+        frame_ = frame;
+        refs_.store(1, std::memory_order_relaxed);  // The capturing worker's reference
+        in_use_.store(true, std::memory_order_relaxed);
+    }
+    const VideoFrame& frame() const { return frame_; }
+    bool in_use() const { return in_use_.load(std::memory_order_acquire); }
+    
+protected:
+    void Recycle() override {
+        backend_->FreeVideo(receiver_, frame_);
+        in_use_.store(false, std::memory_order_release);
+    }
+    
+private:
+    NDIBackend* backend_;
+    NDIReceiver receiver_;
+    VideoFrame frame_;
+    std::atomic<bool> in_use_{false};
+};
+
+// Which worker offers a frame to a destination, under which routing snapshot,
+// and whether that snapshot still routes the destination to it
+struct FeedTag {
+    uint64_t worker;
+    uint64_t version;
+    bool routed;
+};
+
+// Timestamp just past the end of a video frame; undefined without a timestamp or rate
+int64_t VideoFrameEnd(const VideoFrame& frame) {
+    if (frame.timestamp == kNDITimestampUndefined || frame.frame_rate_N <= 0 || frame.frame_rate_D <= 0) {
+        return kNDITimestampUndefined;
+    }
+    return frame.timestamp + kNdiTicksPerSecond * frame.frame_rate_D / frame.frame_rate_N;
+}
+
+// Whether a video frame goes out. The routed source takes the destination
+// over with its first frame; until then the previous feed keeps it. A worker
+// still reading an older snapshot than the current feed's cannot take it back.
+// Requires send_mutex.
+bool AdmitVideo(DestinationSender& sender, const FeedTag& tag, const VideoFrame& frame) {
+    if (sender.feed != tag.worker) {
+        if (!tag.routed || tag.version < sender.feed_version) {
+            return false;
+        }
+        sender.previous_feed = sender.feed;
+        sender.previous_audio_end = sender.feed_video_end;
+        sender.feed = tag.worker;
+        sender.feed_version = tag.version;
+        sender.feed_audio_start = frame.timestamp;
+        sender.cuts.fetch_add(1, std::memory_order_relaxed);
+    }
+    sender.feed_video_end = VideoFrameEnd(frame);
+    return true;
+}
+
+// Index of the first sample in `frame` at or after NDI time `time`
+int FirstSampleAt(const AudioFrame& frame, int64_t time) {
+    int64_t offset = time - frame.timestamp;
+    if (offset <= 0) {
+        return 0;
+    }
+    if (offset >= static_cast<int64_t>(frame.samples) * kNdiTicksPerSecond / frame.sample_rate + 1) {
+        return frame.samples;
+    }
+    return static_cast<int>((offset * frame.sample_rate + kNdiTicksPerSecond - 1) / kNdiTicksPerSecond);
+}
+
+// Narrows an audio frame to the part that belongs on the destination: the
+// feed's audio from its first video frame on, the previous feed's up to the
+// end of its last one. Planar audio trims by moving the data pointer, so
+// nothing is copied. A routed source whose video never arrives (audio only, or
+// the feed went quiet) takes over on audio once the feed has sent no video
+// for the handover timeout. False if none of it belongs.
+// Requires send_mutex.
+bool ClipAudio(DestinationSender& sender, const FeedTag& tag, AudioFrame& frame) {
+    const uint64_t worker = tag.worker;
+    bool timed = frame.timestamp != kNDITimestampUndefined && frame.sample_rate > 0;
+    if (worker != sender.feed && tag.routed && tag.version >= sender.feed_version &&
+        std::chrono::steady_clock::now() - sender.last_routed_video >= kCutHandoverTimeout) {
+        sender.previous_feed = 0;
+        sender.feed = worker;
+        sender.feed_version = tag.version;
+        sender.feed_audio_start = kNDITimestampUndefined;
+        sender.feed_video_end = kNDITimestampUndefined;
+        sender.cuts.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (worker == sender.feed) {
+        if (!timed || sender.feed_audio_start == kNDITimestampUndefined) {
+            return true;
+        }
+        int skip = FirstSampleAt(frame, sender.feed_audio_start);
+        if (skip >= frame.samples) {
+            return false;
+        }
+        if (skip > 0) {
+            int64_t skipped_ticks = static_cast<int64_t>(skip) * kNdiTicksPerSecond / frame.sample_rate;
+            frame.data += skip;
+            frame.samples -= skip;
+            frame.timestamp += skipped_ticks;
+            if (frame.timecode != kNDITimecodeSynthesize) {
+                frame.timecode += skipped_ticks;
+            }
+        }
+        return true;
+    }
+    if (worker != 0 && worker == sender.previous_feed) {
+        int keep = timed && sender.previous_audio_end != kNDITimestampUndefined
+            ? FirstSampleAt(frame, sender.previous_audio_end) : 0;
+        if (keep == 0) {
+            sender.previous_feed = 0;   // Its audio has reached the cut
+            return false;
+        }
+        frame.samples = keep;
+        return true;
+    }
+    return false;
+}
+
+// Whether a worker the destination was switched away from still owes it
+// frames: video until the new source takes over, audio until it reaches the cut
+bool StillFeeding(DestinationSender& sender, uint64_t worker) {
+    std::lock_guard<std::mutex> lock(sender.send_mutex);
+    return sender.routed.load(std::memory_order_relaxed) &&
+           (sender.feed == worker || sender.previous_feed == worker);
+}
+
+// Queue the frame on the sender and release whatever it was sending before:
+// the backend stops reading the previous async buffer once the next call returns.
+// A clocked destination only holds the frame for its next tick.
+// False if the destination is not taking frames from this worker.
+bool SendVideoAsync(DestinationSender& sender, CapturedVideoFrame* frame, const FeedTag& tag) {
+    SharedFrame* previous = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sender.send_mutex);
+        if (!AdmitVideo(sender, tag, frame->frame())) {
+            return false;
+        }
+        if (sender.sync) {
+            previous = sender.sync->PushVideo(frame, frame->frame());
+        } else {
+            frame->AddRef();
+            sender.backend->SendVideoAsync(sender.instance, &frame->frame());
+            previous = sender.in_flight_video;
+            sender.in_flight_video = frame;
+            sender.video_frames_sent.fetch_add(1, std::memory_order_relaxed);
+        }
+        sender.last_routed_video = std::chrono::steady_clock::now();
+    }
+    if (previous) {
+        previous->Release();
+    }
+    return true;
+}
+
+// Sends the part of an audio frame that belongs on the destination; the
+// number of samples per channel sent
+int SendAudio(DestinationSender& sender, const AudioFrame& frame, const FeedTag& tag) {
+    AudioFrame clipped = frame;
+    std::lock_guard<std::mutex> lock(sender.send_mutex);
+    if (!ClipAudio(sender, tag, clipped)) {
+        return 0;
+    }
+    if (sender.sync) {
+        sender.sync->PushAudio(clipped);
+    } else {
+        sender.backend->SendAudio(sender.instance, clipped);
+        sender.audio_frames_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    return clipped.samples;
+}
+
+// A destination this worker fed before the latest route change
+struct DepartingDestination {
+    std::weak_ptr<DestinationSender> sender;
+    std::chrono::steady_clock::time_point deadline;
+};
+
+// After a fan-out change: destinations the source no longer feeds start their
+// handover, and any it feeds again stop it
+void UpdateDepartures(const RoutingSnapshot::SourceFanout* previous, const RoutingSnapshot::SourceFanout* current,
+                      std::vector<DepartingDestination>& departing) {
+    std::unordered_set<const DestinationSender*> routed;
+    if (current) {
+        routed.reserve(current->senders.size());
+        for (const auto& sender : current->senders) {
+            routed.insert(sender.get());
+        }
+    }
+    departing.erase(
+        std::remove_if(departing.begin(), departing.end(),
+            [&routed](const DepartingDestination& entry) {
+                auto sender = entry.sender.lock();
+                return !sender || routed.count(sender.get()) != 0;
+            }),
+        departing.end()
+    );
+    if (!previous) {
+        return;
+    }
+    std::unordered_set<const DestinationSender*> known;
+    for (const auto& entry : departing) {
+        known.insert(entry.sender.lock().get());
+    }
+    auto deadline = std::chrono::steady_clock::now() + kCutHandoverTimeout;
+    for (const auto& sender : previous->senders) {
+        if (routed.count(sender.get()) == 0 && known.insert(sender.get()).second) {
+            departing.push_back({sender, deadline});
+        }
+    }
+}
+
+// Synchronous slate send (it also waits out any pending async frame). Skips a
+// sender that carried routed video within `quiet`, so a route that was just
+// made is never interrupted by a stale idle decision.
+bool SendSlateIfIdle(DestinationSender& sender, const VideoFrame& slate,
+                     std::chrono::steady_clock::duration quiet) {
+    SharedFrame* previous = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sender.send_mutex);
+        if (std::chrono::steady_clock::now() - sender.last_routed_video < quiet) {
+            return false;
+        }
+        sender.backend->SendVideo(sender.instance, slate);
+        previous = sender.in_flight_video;
+        sender.in_flight_video = nullptr;
+        sender.video_frames_sent.fetch_add(1, std::memory_order_relaxed);
+        sender.slate_frames_sent.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (previous) {
+        previous->Release();
+    }
+    return true;
+}
+
+// Wait for the backend to finish with an async frame from `owner` (any owner if
+// null), and take back the frame a frame synchronizer holds for its next tick
+void FlushSender(DestinationSender& sender, const void* owner) {
+    SharedFrame* previous = nullptr;
+    SharedFrame* held = nullptr;
+    {
+        std::lock_guard<std::mutex> lock(sender.send_mutex);
+        if (sender.sync) {
+            held = sender.sync->ReleaseVideo(owner);
+        }
+        if (sender.in_flight_video && (!owner || sender.in_flight_video->owner() == owner)) {
+            sender.backend->SendVideoAsync(sender.instance, nullptr);
+            previous = sender.in_flight_video;
+            sender.in_flight_video = nullptr;
+        }
+    }
+    if (previous) {
+        previous->Release();
+    }
+    if (held) {
+        held->Release();
+    }
+}
+
+// Output thread of a clocked destination: one video frame and one tick of
+// audio per tick of its clock, whatever the sources deliver. Ticks are
+// scheduled from the first one, so the cadence does not drift; a tick missed
+// by more than a frame is skipped rather than sent in a burst. The slate
+// stands in when no source frame is held; once the destination has been
+// unrouted for the handover timeout its last frame is let go.
+void RunOutputClock(DestinationSender* sender, VideoFrame slate) {
+    FrameSync& sync = *sender->sync;
+    const OutputClock& clock = sync.clock();
+    slate.frame_rate_N = clock.frame_rate_N;
+    slate.frame_rate_D = clock.frame_rate_D;
+    
+    auto start = std::chrono::steady_clock::now();
+    uint64_t tick = 0;
+    while (!sync.should_stop.load(std::memory_order_acquire)) {
+        auto due = start + sync.TickTime(tick);
+        std::this_thread::sleep_until(due);
+        auto now = std::chrono::steady_clock::now();
+        if (now - due > sync.TickTime(1)) {
+            while (start + sync.TickTime(tick + 1) <= now) {
+                tick++;
+                sync.late_ticks.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        tick++;
+        
+        SharedFrame* previous = nullptr;
+        SharedFrame* stale = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(sender->send_mutex);
+            if (!sender->routed.load(std::memory_order_relaxed) && now - sender->last_routed_video >= kCutHandoverTimeout) {
+                stale = sync.ReleaseVideo(nullptr);
+            }
+            VideoFrame frame;
+            if (SharedFrame* held = sync.VideoForTick(&frame)) {
+                held->AddRef();
+                sender->backend->SendVideoAsync(sender->instance, &frame);
+                previous = sender->in_flight_video;
+                sender->in_flight_video = held;
+                sender->video_frames_sent.fetch_add(1, std::memory_order_relaxed);
+            } else if (slate.data) {
+                sender->backend->SendVideo(sender->instance, slate);
+                previous = sender->in_flight_video;
+                sender->in_flight_video = nullptr;
+                sender->video_frames_sent.fetch_add(1, std::memory_order_relaxed);
+                sender->slate_frames_sent.fetch_add(1, std::memory_order_relaxed);
+            }
+            if (const AudioFrame* audio = sync.AudioForTick()) {
+                sender->backend->SendAudio(sender->instance, *audio);
+                sender->audio_frames_sent.fetch_add(1, std::memory_order_relaxed);
+            }
+        }
+        if (previous) {
+            previous->Release();
+        }
+        if (stale) {
+            stale->Release();
+        }
+    }
+}
+
+// How old a frame was when it was captured, from the timestamp its sender
+// stamped on it (100 ns units since the Unix epoch); -1 if it carries none.
+// Clock skew between machines can make it look negative, which reads as 0.
+int64_t SourceAgeNs(int64_t timestamp) {
+    if (timestamp == kNDITimestampUndefined || timestamp <= 0) {
+        return -1;
+    }
+    int64_t now_100ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::system_clock::now().time_since_epoch()).count() / 100;
+    return std::max<int64_t>(0, now_100ns - timestamp) * 100;
+}
+
+// Counts one frame sent on a route and records how long after capture (and
+// after the sender stamped it, when known) its send returned. Only the worker
+// feeding the route writes, so plain relaxed updates suffice.
+void RecordRouteSend(RouteStats* stats, std::chrono::steady_clock::time_point captured, int64_t source_age_ns,
+                     bool audio, int audio_samples) {
+    if (!stats) {
+        return;
+    }
+    uint64_t send_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now() - captured).count();
+    if (audio) {
+        stats->audio_frames.fetch_add(1, std::memory_order_relaxed);
+        stats->audio_samples.fetch_add(static_cast<uint64_t>(audio_samples), std::memory_order_relaxed);
+    } else {
+        stats->video_frames.fetch_add(1, std::memory_order_relaxed);
+    }
+    stats->send_latency.Record(send_ns);
+    if (source_age_ns >= 0) {
+        stats->source_latency.Record(static_cast<uint64_t>(source_age_ns) + send_ns);
+    }
+}
+
+// Stops a clocked destination's output thread, hands back the frame the
+// backend is still sending and destroys the NDI sender
+void DestroyDestinationSender(DestinationSender* sender) {
+    if (sender->sync && sender->sync->thread.joinable()) {
+        sender->sync->should_stop = true;
+        sender->sync->thread.join();
+    }
+    FlushSender(*sender, nullptr);
+    sender->backend->DestroySender(sender->instance);
+    delete sender;
+}
+}
+
+// Per-worker set of frame holders, reused so the steady-state capture path does
+// not allocate. Only the owning worker acquires; any thread may release. It
+// outlives the worker: a stopped worker's receiver is destroyed only once every
+// frame it lent out has come back.
+class NDIManager::VideoFramePool {
+public:
+    VideoFramePool(NDIBackend* backend, NDIReceiver receiver) : backend_(backend), receiver_(receiver) {}
+    
+    CapturedVideoFrame* Acquire(const VideoFrame& frame) {
+        for (auto& holder : holders_) {
+            if (!holder->in_use()) {
+                holder->Hold(frame);
+                return holder.get();
+            }
+        }
+        holders_.push_back(std::make_unique<CapturedVideoFrame>(this, backend_, receiver_));
+        holders_.back()->Hold(frame);
+        return holders_.back().get();
+    }
+    
+    bool AllReturned() const {
+        for (const auto& holder : holders_) {
+            if (holder->in_use()) return false;
+        }
+        return true;
+    }
+    
+private:
+    NDIBackend* backend_;
+    NDIReceiver receiver_;
+    std::vector<std::unique_ptr<CapturedVideoFrame>> holders_;
+};
+
+NDIManager::NDIManager(std::unique_ptr<NDIBackend> backend)
+    : backend_(std::move(backend)), ndi_find_(nullptr), matrix_size_{kDefaultSourceSlots, kDefaultDestinationSlots},
+      state_version_(0), preview_receiver_(nullptr), should_stop_preview_(false), route_id_rng_(std::random_device{}()),
+      slate_frame_(), idle_slate_fps_(kDefaultSlateFps),
+      max_source_workers_(kDefaultMaxSourceWorkers), pending_source_count_(0),
+      receive_mode_(ReceiveMode::Passthrough), receivers_stale_(false), assigned_sources_stale_(false),
+      warm_receiver_budget_(kDefaultWarmReceiverBudget),
+      warm_receiver_idle_timeout_s_(kDefaultWarmReceiverIdleTimeout.count()), warm_receiver_count_(0),
+      retired_senders_pending_(false), should_stop_discovery_(false), should_stop_routing_(false),
+      routing_generation_(0) {}
 
 NDIManager::~NDIManager() {
     Shutdown();
 }
 
 bool NDIManager::Initialize() {
-    if (!NDIlib_initialize()) {
-        std::cerr << "Failed to initialize NDI library" << std::endl;
+    if (!backend_->Initialize()) {
+        LOG_ERROR("Failed to initialize NDI library (" << backend_->name() << " backend)");
         return false;
     }
 
-    NDIlib_find_create_t find_desc;
-    find_desc.show_local_sources = true;
-    find_desc.p_groups = nullptr;
-    find_desc.p_extra_ips = nullptr;
-
-    ndi_find_ = NDIlib_find_create_v2(&find_desc);
+    // The backend lets NDI settle here before any sender is created
+    ndi_find_ = backend_->CreateFinder();
     if (!ndi_find_) {
-        std::cerr << "Failed to create NDI finder" << std::endl;
-        NDIlib_destroy();
+        LOG_ERROR("Failed to create NDI finder");
+        backend_->Shutdown();
         return false;
     }
 
-    // Wait for NDI to fully initialize before creating senders
-    std::this_thread::sleep_for(std::chrono::milliseconds(500));
-
     // Initialize default matrix layout
+    BuildIdleSlate();
     InitializeDefaultMatrix();
     
+    // Start source discovery; from here on only that thread uses ndi_find_
+    should_stop_discovery_ = false;
+    discovery_thread_ = std::make_unique<std::thread>(&NDIManager::SourceDiscoveryThread, this);
+    
     // Start routing thread
     should_stop_routing_ = false;
     routing_thread_ = std::make_unique<std::thread>(&NDIManager::ProcessRoutes, this);
     
-    std::cout << "NDI Manager initialized successfully" << std::endl;
+    // Start preview thread (idle until a preview source is set)
+    should_stop_preview_ = false;
+    preview_thread_ = std::make_unique<std::thread>(&NDIManager::PreviewThread, this);
+    
+    LOG_INFO("NDI Manager initialized successfully");
     return true;
 }
 
 void NDIManager::Shutdown() {
     // Stop routing thread
     should_stop_routing_ = true;
+    NotifyRoutingChange();
     if (routing_thread_ && routing_thread_->joinable()) {
         routing_thread_->join();
     }
     
-    if (ndi_find_) {
-        NDIlib_find_destroy(ndi_find_);
-        ndi_find_ = nullptr;
+    // Stop preview thread; it destroys its own receiver
+    {
+        std::lock_guard<std::mutex> lock(preview_mutex_);
+        should_stop_preview_ = true;
     }
-
-    for (auto& receiver : receivers_) {
-        if (receiver) {
-            NDIlib_recv_destroy(*receiver);
-        }
+    preview_wakeup_.notify_all();
+    if (preview_thread_ && preview_thread_->joinable()) {
+        preview_thread_->join();
     }
-    receivers_.clear();
-
-    for (auto& sender : senders_) {
-        if (sender) {
-            NDIlib_send_destroy(*sender);
-        }
+    
+    // Stop source discovery before the finder goes away
+    should_stop_discovery_ = true;
+    if (discovery_thread_ && discovery_thread_->joinable()) {
+        discovery_thread_->join();
     }
-    senders_.clear();
-
-    // Clean up matrix destination senders
-    for (auto& destination : matrix_destinations_) {
-        if (destination.ndi_sender) {
-            NDIlib_send_destroy(destination.ndi_sender);
-        }
+    
+    if (ndi_find_) {
+        backend_->DestroyFinder(ndi_find_);
+        ndi_find_ = nullptr;
     }
+
+    // Clean up matrix destination senders (the last handle retires each sender)
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    std::atomic_store(&routing_snapshot_, std::shared_ptr<const RoutingSnapshot>());
+    retired_snapshots_.clear();
+    routing_table_.Clear();
     matrix_destinations_.clear();
     matrix_source_slots_.clear();
+    source_slot_index_.Clear();
+    destination_index_.Clear();
+    free_destination_slots_.clear();
+    next_destination_slot_ = 1;
+    ReclaimRetiredSenders();
 
-    // Clean up route receivers
+    // Clean up route receivers; the senders above gave back the last frames
+    // of those still draining
     for (auto& pair : route_receivers_) {
         if (pair.second) {
-            NDIlib_recv_destroy(pair.second);
+            backend_->DestroyReceiver(pair.second);
         }
     }
     route_receivers_.clear();
+    ReclaimDrainingReceivers(true);
 
     // Studio monitor source tracking cleanup (no special cleanup needed)
 
     matrix_routes_.clear();
-    NDIlib_destroy();
-    std::cout << "NDI Manager shut down" << std::endl;
+    route_index_.Clear();
+    backend_->Shutdown();
+    LOG_INFO("NDI Manager shut down");
 }
 
 std::vector<NDISource> NDIManager::DiscoverSources() {
-    std::vector<NDISource> sources;
-    
-    if (!ndi_find_) {
-        std::cout << "ERROR: NDI finder is null" << std::endl;
-        return sources;
-    }
+    return source_table_.Load()->sources;
+}
 
-    uint32_t num_sources = 0;
-    const NDIlib_source_t* ndi_sources = NDIlib_find_get_current_sources(ndi_find_, &num_sources);
-    
-    if (!ndi_sources && num_sources > 0) {
-        std::cout << "ERROR: NDI sources pointer is null but num_sources is " << num_sources << std::endl;
-        return sources;
-    }
-    
-    std::cout << "NDI finder returned " << num_sources << " sources" << std::endl;
+std::vector<NDISource> NDIManager::DiscoverStudioMonitors() {
+    return source_table_.Load()->studio_monitors;
+}
 
-    for (uint32_t i = 0; i < num_sources; i++) {
-        std::string source_name = ndi_sources[i].p_ndi_name ? ndi_sources[i].p_ndi_name : "";
-        
-        // Filter out our own created destinations
-        bool is_our_destination = false;
-        for (const auto& destination : matrix_destinations_) {
-            if (destination.name == source_name) {
-                is_our_destination = true;
-                break;
-            }
-        }
-        
-        // Only add if it's not one of our destinations
-        if (!is_our_destination && !source_name.empty()) {
-            NDISource source;
-            source.name = source_name;
-            source.url = ndi_sources[i].p_url_address ? ndi_sources[i].p_url_address : "";
-            source.is_connected = true;
-            source.group_name = "";
-            sources.push_back(source);
+std::shared_ptr<const SourceTableSnapshot> NDIManager::GetSourceTable() const {
+    return source_table_.Load();
+}
+
+void NDIManager::SourceDiscoveryThread() {
+    // Publish whatever the finder saw while Initialize() was running, then
+    // sleep in the backend until the announced list changes
+    bool changed = true;
+    while (!should_stop_discovery_) {
+        if (changed) {
+            RefreshSourceTable();
         }
+        changed = backend_->WaitForSources(ndi_find_, kDiscoveryWaitMs);
     }
-
-    return sources;
 }
 
-std::vector<NDISource> NDIManager::DiscoverStudioMonitors() {
-    std::vector<NDISource> studio_monitors;
+void NDIManager::RefreshSourceTable() {
+    std::vector<NDISource> announced = backend_->GetCurrentSources(ndi_find_);
     
-    if (!ndi_find_) {
-        return studio_monitors;
+    SourceTableChanges changes;
+    if (!source_table_.Update(announced, changes)) {
+        return;
     }
-
-    uint32_t num_sources = 0;
-    const NDIlib_source_t* ndi_sources = NDIlib_find_get_current_sources(ndi_find_, &num_sources);
-
-    for (uint32_t i = 0; i < num_sources; i++) {
-        std::string source_name = ndi_sources[i].p_ndi_name ? ndi_sources[i].p_ndi_name : "";
-        
-        // Look for sources that contain "Studio Monitor" (case insensitive)
-        std::string lower_name = source_name;
-        std::transform(lower_name.begin(), lower_name.end(), lower_name.begin(), ::tolower);
-        
-        if (lower_name.find("studio monitor") != std::string::npos && !source_name.empty()) {
-            NDISource source;
-            source.name = source_name;
-            source.url = ndi_sources[i].p_url_address ? ndi_sources[i].p_url_address : "";
-            source.is_connected = true;
-            source.group_name = "";
-            studio_monitors.push_back(source);
-        }
+    LOG_INFO("NDI sources changed: " << changes.added.size() << " added, " << changes.removed.size()
+              << " removed, " << announced.size() << " announced");
+    
+    // Sources are not matrix state, so the state version does not move
+    std::lock_guard<std::mutex> lock(state_change_mutex_);
+    if (source_update_callback_) {
+        source_update_callback_(changes);
+    }
+    if (state_change_callback_) {
+        state_change_callback_(kSourcesChanged);
     }
-
-    return studio_monitors;
 }
 
 std::vector<MatrixSourceSlot> NDIManager::GetSourceSlots() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     return matrix_source_slots_;
 }
 
 bool NDIManager::AssignSourceToSlot(int slot_number, const std::string& ndi_source_name, const std::string& display_name) {
-    // Find existing slot or create new one
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    // Every slot up to the matrix size exists
     MatrixSourceSlot* slot = FindMatrixSourceSlot(slot_number);
+    if (!slot) {
+        LOG_ERROR("Invalid source slot number: " << slot_number << " (matrix has " << matrix_size_.source_slots << " source slots)");
+        return false;
+    }
     
-    if (slot) {
-        // Update existing slot
-        slot->assigned_ndi_source = ndi_source_name;
-        slot->display_name = display_name;
-        slot->is_assigned = true;
-    } else {
-        // Create new slot
-        MatrixSourceSlot new_slot;
-        new_slot.slot_number = slot_number;
-        new_slot.assigned_ndi_source = ndi_source_name;
-        new_slot.display_name = display_name;
-        new_slot.is_assigned = true;
-        matrix_source_slots_.push_back(new_slot);
+    if (slot->is_assigned && slot->assigned_ndi_source == ndi_source_name && slot->display_name == display_name) {
+        LOG_DEBUG("Source slot " << slot_number << " already carries '" << ndi_source_name << "'");
+        return true;
     }
     
-    std::cout << "Assigned NDI source '" << ndi_source_name << "' to slot " << slot_number << std::endl;
+    // Only a slot that was already routed moves routes to another NDI source
+    bool reroutes = slot->is_assigned && slot->assigned_ndi_source != ndi_source_name;
+    slot->assigned_ndi_source = ndi_source_name;
+    slot->display_name = display_name;
+    slot->is_assigned = true;
+    
+    // The supervisor starts warming the source's receiver ahead of any take
+    assigned_sources_stale_ = true;
+    if (reroutes) {
+        // The old source's worker may still be recording into the current stats
+        for (auto& route : matrix_routes_) {
+            if (route.source_slot == slot_number) {
+                route.stats = std::make_shared<RouteStats>();
+            }
+        }
+        RebuildRoutingTable();
+        PublishRoutingSnapshot();
+    } else {
+        NotifyRoutingChange();
+    }
+    LogChange(ChangedEntity::SourceSlot, slot_number);
+    NotifyStateChange(kSourceSlotsChanged);
+    LOG_INFO("Assigned NDI source '" << ndi_source_name << "' to slot " << slot_number);
     return true;
 }
 
 bool NDIManager::UnassignSourceSlot(int slot_number) {
     try {
-        std::cout << "=== STARTING UNASSIGN FOR SOURCE SLOT " << slot_number << " ===" << std::endl;
-        
-        // Pause routing operations
-        std::cout << "THREAD SAFETY: Setting update flag to pause routing thread" << std::endl;
-        is_updating_routes_ = true;
+        LOG_DEBUG("Starting unassign for source slot " << slot_number);
         
-        // Give the routing thread a moment to see the flag
-        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        // Workers keep routing from the previous snapshot until the new one is published,
+        // so there is no need to pause them
+        std::lock_guard<std::mutex> lock(state_mutex_);
         
         MatrixSourceSlot* slot = FindMatrixSourceSlot(slot_number);
         if (!slot) {
-            std::cout << "ERROR: Source slot " << slot_number << " not found" << std::endl;
-            is_updating_routes_ = false;
+            LOG_ERROR("Source slot " << slot_number << " not found");
             return false;
         }
         
         if (!slot->is_assigned) {
-            std::cout << "WARNING: Source slot " << slot_number << " is not assigned" << std::endl;
-            is_updating_routes_ = false;
+            LOG_WARN("Source slot " << slot_number << " is not assigned");
             return true; // Already unassigned
         }
         
         std::string source_name = slot->assigned_ndi_source;
-        std::cout << "Unassigning slot " << slot_number << " (was: '" << source_name << "')" << std::endl;
+        LOG_INFO("Unassigning slot " << slot_number << " (was: '" << source_name << "')");
         
         // Check if there are any routes using this source slot
-        std::cout << "Checking for routes using source slot " << slot_number << "..." << std::endl;
+        LOG_DEBUG("Checking for routes using source slot " << slot_number << "...");
         size_t routes_before = matrix_routes_.size();
         
         // Count routes that will be removed
         int routes_to_remove = 0;
         for (const auto& route : matrix_routes_) {
             if (route.source_slot == slot_number) {
-                std::cout << "Found route: source " << route.source_slot << " -> dest " << route.destination_slot << " (active: " << route.is_active << ")" << std::endl;
+                LOG_DEBUG("Found route: source " << route.source_slot << " -> dest " << route.destination_slot << " (active: " << route.is_active << ")");
+                routing_table_.RemoveRoute(source_name, route.destination_slot);
+                LogChange(ChangedEntity::Route, route.destination_slot);
                 routes_to_remove++;
             }
         }
         
-        std::cout << "Will remove " << routes_to_remove << " routes" << std::endl;
+        LOG_DEBUG("Will remove " << routes_to_remove << " routes");
         
         // Remove all routes that use this source slot
         matrix_routes_.erase(
@@ -250,279 +725,421 @@ bool NDIManager::UnassignSourceSlot(int slot_number) {
                 }),
             matrix_routes_.end()
         );
+        route_index_.Rebuild(matrix_routes_, &MatrixRoute::destination_slot);
         
         size_t routes_after = matrix_routes_.size();
-        std::cout << "Removed " << (routes_before - routes_after) << " routes (before: " << routes_before << ", after: " << routes_after << ")" << std::endl;
+        LOG_DEBUG("Removed " << (routes_before - routes_after) << " routes (before: " << routes_before << ", after: " << routes_after << ")");
+        
+        uint32_t changes = kSourceSlotsChanged | kRoutesChanged | kDestinationsChanged;
         
         // Clear studio monitor if it's using this source
         if (current_studio_monitor_source_ == source_name) {
-            std::cout << "Clearing studio monitor source (was using source being unassigned)" << std::endl;
-            ClearStudioMonitorSource();
+            LOG_DEBUG("Clearing studio monitor source (was using source being unassigned)");
+            current_studio_monitor_source_.clear();
+            LogChange(ChangedEntity::StudioMonitor);
+            changes |= kStudioMonitorChanged;
         }
         
         // Clear current_source_slot for destinations that were using this source
-        std::cout << "Clearing destination references..." << std::endl;
+        LOG_DEBUG("Clearing destination references...");
         for (auto& destination : matrix_destinations_) {
             if (destination.current_source_slot == slot_number) {
-                std::cout << "Clearing destination " << destination.slot_number << " current source" << std::endl;
+                LOG_DEBUG("Clearing destination " << destination.slot_number << " current source");
                 destination.current_source_slot = 0;
+                LogChange(ChangedEntity::Destination, destination.slot_number);
             }
         }
         
-        // Clear the slot data BEFORE cleanup
-        std::cout << "Clearing source slot data..." << std::endl;
+        // Clear the slot data
+        LOG_DEBUG("Clearing source slot data...");
         slot->assigned_ndi_source.clear();
         slot->display_name.clear();
         slot->is_assigned = false;
         
-        std::cout << "Source slot data cleared. Current receiver count: " << route_receivers_.size() << std::endl;
-        
-        // Check if the source has a receiver
-        auto receiver_it = route_receivers_.find(source_name);
-        if (receiver_it != route_receivers_.end()) {
-            std::cout << "Found receiver for source '" << source_name << "', will be cleaned up" << std::endl;
-        } else {
-            std::cout << "No receiver found for source '" << source_name << "'" << std::endl;
-        }
-        
-        std::cout << "Starting receiver cleanup..." << std::endl;
-        
-        // Clean up unused receivers
-        CleanupUnusedReceivers();
+        // The supervisor stops the worker, or keeps the receiver warm for a while
+        assigned_sources_stale_ = true;
+        PublishRoutingSnapshot();
+        LogChange(ChangedEntity::SourceSlot, slot_number);
+        NotifyStateChange(changes);
         
-        std::cout << "THREAD SAFETY: Re-enabling routing thread" << std::endl;
-        is_updating_routes_ = false;
-        
-        std::cout << "=== SLOT " << slot_number << " UNASSIGNED SUCCESSFULLY ===" << std::endl;
+        LOG_INFO("Unassigned source slot " << slot_number);
         return true;
     } catch (const std::exception& e) {
-        std::cout << "=== ERROR in UnassignSourceSlot: " << e.what() << " ===" << std::endl;
-        is_updating_routes_ = false;
+        LOG_ERROR("UnassignSourceSlot failed: " << e.what());
         return false;
     } catch (...) {
-        std::cout << "=== UNKNOWN ERROR in UnassignSourceSlot ===" << std::endl;
-        is_updating_routes_ = false;
+        LOG_ERROR("Unknown error in UnassignSourceSlot");
         return false;
     }
 }
 
 std::vector<MatrixDestination> NDIManager::GetMatrixDestinations() {
-    return matrix_destinations_;
+    std::vector<MatrixDestination> destinations;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        destinations = matrix_destinations_;
+    }
+    return SortedBySlot(std::move(destinations));
 }
 
-bool NDIManager::CreateMatrixDestination(const std::string& name, const std::string& description) {
-    // Find the next available slot number
-    int next_slot = 1;
-    for (const auto& dest : matrix_destinations_) {
-        if (dest.slot_number >= next_slot) {
-            next_slot = dest.slot_number + 1;
+bool NDIManager::CreateMatrixDestination(const std::string& name, const std::string& description,
+                                          const OutputClock& output_clock) {
+    if (output_clock.enabled) {
+        double fps = output_clock.frame_rate_D > 0
+            ? static_cast<double>(output_clock.frame_rate_N) / output_clock.frame_rate_D : 0.0;
+        if (!(fps >= kMinOutputFps && fps <= kMaxOutputFps) ||
+            output_clock.audio_sample_rate < kMinOutputSampleRate || output_clock.audio_sample_rate > kMaxOutputSampleRate) {
+            LOG_ERROR("Cannot create destination '" << name << "': invalid output clock " << output_clock.frame_rate_N
+                      << "/" << output_clock.frame_rate_D << " fps, " << output_clock.audio_sample_rate << " Hz");
+            return false;
         }
     }
     
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    int next_slot = AllocateDestinationSlot();
+    if (next_slot == 0) {
+        LOG_ERROR("Cannot create destination '" << name << "': all " << matrix_size_.destination_slots << " destination slots are in use");
+        return false;
+    }
+    
     MatrixDestination destination;
     destination.slot_number = next_slot;
     destination.name = name;
     destination.description = description;
     destination.is_enabled = true;
     destination.current_source_slot = 0; // 0 means no source assigned
+    destination.output_clock = output_clock;
 
-    // Create actual NDI sender for this destination with low-latency optimizations
-    NDIlib_send_create_t send_desc;
-    send_desc.p_ndi_name = destination.name.c_str();
-    send_desc.p_groups = nullptr;
-    send_desc.clock_video = false; // No clocking for lowest latency
-    send_desc.clock_audio = false;
-
-    std::cout << "Attempting to create NDI sender for: " << name << std::endl;
-    destination.ndi_sender = NDIlib_send_create(&send_desc);
+    // Create actual NDI sender for this destination. The SDK never clocks it:
+    // free-running outputs send as frames arrive for the lowest latency, and a
+    // clocked output paces itself on its own thread.
+    LOG_DEBUG("Attempting to create NDI sender for: " << name);
+    NDISender sender = backend_->CreateSender(destination.name, false, false);
     
-    if (!destination.ndi_sender) {
-        std::cerr << "Failed to create NDI sender for destination: " << name << std::endl;
-        std::cerr << "This may be due to NDI runtime issues or resource limitations" << std::endl;
+    if (!sender) {
+        LOG_ERROR("Failed to create NDI sender for destination: " << name);
+        LOG_ERROR("This may be due to NDI runtime issues or resource limitations");
+        ReleaseDestinationSlot(next_slot);
         return false;
     }
 
-    matrix_destinations_.push_back(destination);
+    // A new destination has no route, so the routing table does not change
+    destination.ndi_sender = MakeSenderHandle(sender, output_clock);
+    matrix_destinations_.push_back(std::move(destination));
+    destination_index_.Set(next_slot, static_cast<int>(matrix_destinations_.size() - 1));
+    source_table_.AddOwnOutput(name);
+    LogChange(ChangedEntity::Destination, next_slot);
+    NotifyStateChange(kDestinationsChanged | kSourcesChanged);
     
-    std::cout << "Created matrix destination '" << name << "' in slot " << next_slot << " (now visible on network)" << std::endl;
+    LOG_INFO("Created matrix destination '" << name << "' in slot " << next_slot << " (now visible on network)");
+    if (output_clock.enabled) {
+        LOG_INFO("Destination '" << name << "' is clocked at " << output_clock.frame_rate_N << "/"
+                 << output_clock.frame_rate_D << " fps, " << output_clock.audio_sample_rate << " Hz");
+    }
     return true;
 }
 
 bool NDIManager::RemoveMatrixDestination(int slot_number) {
-    for (auto it = matrix_destinations_.begin(); it != matrix_destinations_.end(); ++it) {
-        if (it->slot_number == slot_number) {
-            // Remove any routes using this destination
-            matrix_routes_.erase(
-                std::remove_if(matrix_routes_.begin(), matrix_routes_.end(),
-                    [slot_number](const MatrixRoute& route) {
-                        return route.destination_slot == slot_number;
-                    }),
-                matrix_routes_.end()
-            );
-            
-            // Destroy the NDI sender
-            if (it->ndi_sender) {
-                NDIlib_send_destroy(it->ndi_sender);
-            }
-            
-            std::cout << "Removed matrix destination: " << it->name << " (slot " << slot_number << ", no longer visible on network)" << std::endl;
-            matrix_destinations_.erase(it);
-            return true;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    int position = destination_index_.Find(slot_number);
+    if (position == SlotIndex::kNone) {
+        return false;
+    }
+    
+    // Remove the route feeding this destination, if any
+    MatrixDestination& destination = matrix_destinations_[position];
+    bool routing_changed = false;
+    if (const MatrixRoute* route = FindRouteForDestination(slot_number)) {
+        if (const MatrixSourceSlot* src_slot = FindMatrixSourceSlot(route->source_slot)) {
+            routing_changed = routing_table_.RemoveRoute(src_slot->assigned_ndi_source, slot_number);
         }
+        EraseRouteForDestination(slot_number);
+        LogChange(ChangedEntity::Route, slot_number);
     }
-    return false;
+    
+    LOG_INFO("Removed matrix destination: " << destination.name << " (slot " << slot_number << ", no longer visible on network)");
+    source_table_.RemoveOwnOutput(destination.name);
+    
+    // Dropping our handle does not destroy the sender yet: workers may still hold
+    // the previous snapshot. The sender goes away when that snapshot is reclaimed.
+    // Swap-remove keeps this O(1); destinations are listed in slot order anyway.
+    if (static_cast<size_t>(position) != matrix_destinations_.size() - 1) {
+        destination = std::move(matrix_destinations_.back());
+        destination_index_.Set(destination.slot_number, position);
+    }
+    matrix_destinations_.pop_back();
+    destination_index_.Erase(slot_number);
+    ReleaseDestinationSlot(slot_number);
+    if (routing_changed) {
+        PublishRoutingSnapshot();
+    }
+    LogChange(ChangedEntity::Destination, slot_number);
+    NotifyStateChange(kDestinationsChanged | kRoutesChanged | kSourcesChanged);
+    return true;
 }
 
 
 bool NDIManager::CreateMatrixRoute(int source_slot, int destination_slot) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    bool changed = false;
+    if (!CreateMatrixRouteLocked(source_slot, destination_slot, &changed)) {
+        return false;
+    }
+    if (changed) {
+        PublishRoutingSnapshot();
+        NotifyStateChange(kRoutesChanged | kDestinationsChanged);
+    }
+    return true;
+}
+
+bool NDIManager::CreateMatrixRouteLocked(int source_slot, int destination_slot, bool* changed) {
+    if (changed) {
+        *changed = false;
+    }
+    
     // Find the source slot
     MatrixSourceSlot* src_slot = FindMatrixSourceSlot(source_slot);
     if (!src_slot || !src_slot->is_assigned) {
-        std::cerr << "Source slot " << source_slot << " not found or not assigned" << std::endl;
+        LOG_ERROR("Source slot " << source_slot << " not found or not assigned");
         return false;
     }
     
     // Find the destination
     MatrixDestination* dest = FindMatrixDestination(destination_slot);
     if (!dest) {
-        std::cerr << "Destination slot " << destination_slot << " not found" << std::endl;
+        LOG_ERROR("Destination slot " << destination_slot << " not found");
         return false;
     }
 
-    // Check if route already exists
-    for (const auto& route : matrix_routes_) {
-        if (route.source_slot == source_slot && route.destination_slot == destination_slot) {
-            std::cout << "Route from slot " << source_slot << " to destination " << destination_slot << " already exists" << std::endl;
-            return true; // Route already exists, no need to create
+    // Destinations receive from one source, so a route is keyed by its destination
+    MatrixRoute* existing = FindRouteForDestination(destination_slot);
+    if (existing && existing->source_slot == source_slot) {
+        LOG_INFO("Route from slot " << source_slot << " to destination " << destination_slot << " already exists");
+        return true; // Route already exists, no need to create
+    }
+    if (changed) {
+        *changed = true;
+    }
+    
+    if (existing) {
+        // Replace the previous route to this destination in place
+        if (const MatrixSourceSlot* previous_slot = FindMatrixSourceSlot(existing->source_slot)) {
+            routing_table_.RemoveRoute(previous_slot->assigned_ndi_source, destination_slot);
         }
+        existing->id = GenerateDestinationId(); // Reuse the ID generator
+        existing->source_slot = source_slot;
+        existing->is_active = true;
+        existing->stats = std::make_shared<RouteStats>();
+    } else {
+        MatrixRoute route;
+        route.id = GenerateDestinationId(); // Reuse the ID generator
+        route.source_slot = source_slot;
+        route.destination_slot = destination_slot;
+        route.is_active = true;
+        route.stats = std::make_shared<RouteStats>();
+        
+        matrix_routes_.push_back(route);
+        route_index_.Set(destination_slot, static_cast<int>(matrix_routes_.size() - 1));
     }
-
-    // Remove any existing route to this destination (destinations can still only receive from one source)
-    matrix_routes_.erase(
-        std::remove_if(matrix_routes_.begin(), matrix_routes_.end(),
-            [destination_slot](const MatrixRoute& route) {
-                return route.destination_slot == destination_slot;
-            }),
-        matrix_routes_.end()
-    );
-
-    MatrixRoute route;
-    route.id = GenerateDestinationId(); // Reuse the ID generator
-    route.source_slot = source_slot;
-    route.destination_slot = destination_slot;
-    route.is_active = true;
-
-    matrix_routes_.push_back(route);
+    routing_table_.AddRoute(src_slot->assigned_ndi_source, destination_slot, dest->ndi_sender,
+                            matrix_routes_[route_index_.Find(destination_slot)].stats);
     dest->current_source_slot = source_slot;
+    LogChange(ChangedEntity::Route, destination_slot);
+    LogChange(ChangedEntity::Destination, destination_slot);
     
-    std::cout << "Created matrix route from slot " << source_slot << " (" << src_slot->assigned_ndi_source << ") to destination slot " << destination_slot << " (" << dest->name << ")" << std::endl;
+    LOG_INFO("Created matrix route from slot " << source_slot << " (" << src_slot->assigned_ndi_source << ") to destination slot " << destination_slot << " (" << dest->name << ")");
     return true;
 }
 
 bool NDIManager::RemoveMatrixRoute(int source_slot, int destination_slot) {
-    for (auto it = matrix_routes_.begin(); it != matrix_routes_.end(); ++it) {
-        if (it->source_slot == source_slot && it->destination_slot == destination_slot) {
-            // Clear the destination's current source
-            MatrixDestination* dest = FindMatrixDestination(destination_slot);
-            if (dest) {
-                dest->current_source_slot = 0;
-            }
-            
-            std::cout << "Removed matrix route from slot " << source_slot << " to destination slot " << destination_slot << std::endl;
-            matrix_routes_.erase(it);
-            
-            // Receiver cleanup will happen periodically via routing thread
-            return true;
-        }
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    MatrixRoute* route = FindRouteForDestination(destination_slot);
+    if (!route || route->source_slot != source_slot) {
+        return false;
     }
-    return false;
+    
+    LOG_INFO("Removed matrix route from slot " << source_slot << " to destination slot " << destination_slot);
+    RemoveRouteLocked(destination_slot);
+    PublishRoutingSnapshot();
+    NotifyStateChange(kRoutesChanged | kDestinationsChanged);
+    
+    // The supervisor keeps the source's receiver warm or releases it
+    return true;
 }
 
-bool NDIManager::UnassignDestination(int destination_slot) {
-    try {
-        std::cout << "Starting unassign for destination slot " << destination_slot << std::endl;
+bool NDIManager::RemoveRouteLocked(int destination_slot) {
+    MatrixRoute* route = FindRouteForDestination(destination_slot);
+    if (!route) {
+        return false;
+    }
+    if (const MatrixSourceSlot* src_slot = FindMatrixSourceSlot(route->source_slot)) {
+        routing_table_.RemoveRoute(src_slot->assigned_ndi_source, destination_slot);
+    }
+    EraseRouteForDestination(destination_slot);
+    
+    // Clear the destination's current source
+    if (MatrixDestination* dest = FindMatrixDestination(destination_slot)) {
+        dest->current_source_slot = 0;
+    }
+    LogChange(ChangedEntity::Route, destination_slot);
+    LogChange(ChangedEntity::Destination, destination_slot);
+    return true;
+}
+
+bool NDIManager::ApplySalvo(const std::vector<Crosspoint>& crosspoints, std::vector<CrosspointResult>& results) {
+    results.clear();
+    results.reserve(crosspoints.size());
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    // Validate everything first; a salvo is applied whole or not at all
+    std::unordered_set<int> seen_destinations;
+    seen_destinations.reserve(crosspoints.size());
+    bool valid = true;
+    for (const Crosspoint& crosspoint : crosspoints) {
+        CrosspointResult result;
+        result.source_slot = crosspoint.source_slot;
+        result.destination_slot = crosspoint.destination_slot;
+        const MatrixSourceSlot* src_slot = crosspoint.source_slot != 0 ? FindMatrixSourceSlot(crosspoint.source_slot) : nullptr;
+        const MatrixRoute* route = FindRouteForDestination(crosspoint.destination_slot);
         
-        MatrixDestination* dest = FindMatrixDestination(destination_slot);
-        if (!dest) {
-            std::cout << "ERROR: Destination slot " << destination_slot << " not found for unassign" << std::endl;
-            return false;
+        if (!FindMatrixDestination(crosspoint.destination_slot)) {
+            result.error = "Destination slot not found";
+        } else if (!seen_destinations.insert(crosspoint.destination_slot).second) {
+            result.error = "Destination slot appears more than once";
+        } else if (crosspoint.source_slot != 0 && (!src_slot || !src_slot->is_assigned)) {
+            result.error = "Source slot not found or not assigned";
+        } else {
+            result.changed = crosspoint.source_slot == 0 ? route != nullptr
+                                                         : !route || route->source_slot != crosspoint.source_slot;
         }
+        valid = valid && result.error.empty();
+        results.push_back(std::move(result));
+    }
+    if (!valid) {
+        LOG_WARN("Rejected salvo of " << crosspoints.size() << " crosspoints: invalid crosspoints");
+        return false;
+    }
+    
+    size_t changed = 0;
+    for (const CrosspointResult& result : results) {
+        if (!result.changed) {
+            continue;
+        }
+        if (result.source_slot == 0) {
+            RemoveRouteLocked(result.destination_slot);
+        } else {
+            CreateMatrixRouteLocked(result.source_slot, result.destination_slot);
+        }
+        changed++;
+    }
+    
+    // One publish: every worker picks up all of the changes with its next frame
+    if (changed > 0) {
+        PublishRoutingSnapshot();
+        NotifyStateChange(kRoutesChanged | kDestinationsChanged);
+    }
+    LOG_INFO("Applied salvo: " << changed << " of " << crosspoints.size() << " crosspoints changed");
+    return true;
+}
+
+bool NDIManager::UnassignDestination(int destination_slot) {
+    try {
+        LOG_DEBUG("Starting unassign for destination slot " << destination_slot);
+        std::lock_guard<std::mutex> lock(state_mutex_);
         
-        std::cout << "Unassigning destination slot " << destination_slot << " (" << dest->name << ")" << std::endl;
-        std::cout << "Current source slot before unassign: " << dest->current_source_slot << std::endl;
-        
-        // Count routes before removal
-        size_t routes_before = matrix_routes_.size();
-        
-        // Remove any routes to this destination
-        matrix_routes_.erase(
-            std::remove_if(matrix_routes_.begin(), matrix_routes_.end(),
-                [destination_slot](const MatrixRoute& route) {
-                    std::cout << "Checking route: source " << route.source_slot << " -> dest " << route.destination_slot << " (active: " << route.is_active << ")" << std::endl;
-                    return route.destination_slot == destination_slot;
-                }),
-            matrix_routes_.end()
-        );
+        MatrixDestination* dest = FindMatrixDestination(destination_slot);
+        if (!dest) {
+            LOG_ERROR("Destination slot " << destination_slot << " not found for unassign");
+            return false;
+        }
         
-        size_t routes_after = matrix_routes_.size();
-        std::cout << "Removed " << (routes_before - routes_after) << " routes (before: " << routes_before << ", after: " << routes_after << ")" << std::endl;
+        LOG_INFO("Unassigning destination slot " << destination_slot << " (" << dest->name << ")");
+        LOG_DEBUG("Current source slot before unassign: " << dest->current_source_slot);
         
-        // Clear the destination's current source
-        dest->current_source_slot = 0;
-        std::cout << "Set destination current_source_slot to 0" << std::endl;
+        // Nothing to publish or tell clients if it was not routed
+        if (!RemoveRouteLocked(destination_slot)) {
+            LOG_DEBUG("Destination slot " << destination_slot << " has no route");
+            return true;
+        }
+        PublishRoutingSnapshot();
+        NotifyStateChange(kRoutesChanged | kDestinationsChanged);
         
-        std::cout << "Successfully unassigned destination slot " << destination_slot << std::endl;
+        LOG_INFO("Successfully unassigned destination slot " << destination_slot);
         return true;
     } catch (const std::exception& e) {
-        std::cout << "ERROR in UnassignDestination: " << e.what() << std::endl;
+        LOG_ERROR("UnassignDestination failed: " << e.what());
         return false;
     } catch (...) {
-        std::cout << "UNKNOWN ERROR in UnassignDestination" << std::endl;
+        LOG_ERROR("Unknown error in UnassignDestination");
         return false;
     }
 }
 
 std::vector<MatrixRoute> NDIManager::GetMatrixRoutes() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     return matrix_routes_;
 }
 
 // Bulk Routing Operations
 bool NDIManager::CreateMultipleRoutes(int source_slot, const std::vector<int>& destination_slots) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
     // Find the source slot
     MatrixSourceSlot* src_slot = FindMatrixSourceSlot(source_slot);
     if (!src_slot || !src_slot->is_assigned) {
-        std::cerr << "Source slot " << source_slot << " not found or not assigned" << std::endl;
+        LOG_ERROR("Source slot " << source_slot << " not found or not assigned");
         return false;
     }
     
     bool all_successful = true;
     int successful_routes = 0;
+    int changed_routes = 0;
     
-    std::cout << "Creating multiple routes from source slot " << source_slot << " (" << src_slot->assigned_ndi_source << ") to " << destination_slots.size() << " destinations" << std::endl;
+    LOG_INFO("Creating multiple routes from source slot " << source_slot << " (" << src_slot->assigned_ndi_source << ") to " << destination_slots.size() << " destinations");
     
     for (int dest_slot : destination_slots) {
-        if (CreateMatrixRoute(source_slot, dest_slot)) {
+        bool changed = false;
+        if (CreateMatrixRouteLocked(source_slot, dest_slot, &changed)) {
             successful_routes++;
+            changed_routes += changed ? 1 : 0;
         } else {
             all_successful = false;
-            std::cerr << "Failed to create route to destination " << dest_slot << std::endl;
+            LOG_ERROR("Failed to create route to destination " << dest_slot);
         }
     }
     
-    std::cout << "Successfully created " << successful_routes << " out of " << destination_slots.size() << " routes from source " << source_slot << std::endl;
+    // Publish once so every destination switches in the same routing pass
+    if (changed_routes > 0) {
+        PublishRoutingSnapshot();
+        NotifyStateChange(kRoutesChanged | kDestinationsChanged);
+    }
+    
+    LOG_INFO("Successfully created " << successful_routes << " out of " << destination_slots.size() << " routes from source " << source_slot);
     return all_successful;
 }
 
 bool NDIManager::RemoveAllRoutesFromSource(int source_slot) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     int routes_removed = 0;
     
     // Find all destinations that are routed from this source
+    const MatrixSourceSlot* src_slot = FindMatrixSourceSlot(source_slot);
     std::vector<int> affected_destinations;
     for (const auto& route : matrix_routes_) {
         if (route.source_slot == source_slot) {
             affected_destinations.push_back(route.destination_slot);
+            if (src_slot) {
+                routing_table_.RemoveRoute(src_slot->assigned_ndi_source, route.destination_slot);
+            }
         }
     }
+    if (affected_destinations.empty()) {
+        LOG_INFO("No routes from source slot " << source_slot << " to remove");
+        return false;
+    }
     
     // Remove all routes from this source
     matrix_routes_.erase(
@@ -536,6 +1153,7 @@ bool NDIManager::RemoveAllRoutesFromSource(int source_slot) {
             }),
         matrix_routes_.end()
     );
+    route_index_.Rebuild(matrix_routes_, &MatrixRoute::destination_slot);
     
     // Clear current_source_slot for affected destinations
     for (int dest_slot : affected_destinations) {
@@ -543,13 +1161,18 @@ bool NDIManager::RemoveAllRoutesFromSource(int source_slot) {
         if (dest) {
             dest->current_source_slot = 0;
         }
+        LogChange(ChangedEntity::Route, dest_slot);
+        LogChange(ChangedEntity::Destination, dest_slot);
     }
     
-    std::cout << "Removed " << routes_removed << " routes from source slot " << source_slot << std::endl;
-    return routes_removed > 0;
+    PublishRoutingSnapshot();
+    NotifyStateChange(kRoutesChanged | kDestinationsChanged);
+    LOG_INFO("Removed " << routes_removed << " routes from source slot " << source_slot);
+    return true;
 }
 
 std::vector<int> NDIManager::GetDestinationsForSource(int source_slot) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     std::vector<int> destinations;
     
     for (const auto& route : matrix_routes_) {
@@ -561,10 +1184,82 @@ std::vector<int> NDIManager::GetDestinationsForSource(int source_slot) {
     return destinations;
 }
 
+bool NDIManager::SetMatrixSize(int source_slots, int destination_slots) {
+    if (!SlotIndex::IsValidSlot(source_slots) || !SlotIndex::IsValidSlot(destination_slots)) {
+        LOG_ERROR("Invalid matrix size " << source_slots << "x" << destination_slots
+                  << " (1 to " << SlotIndex::kMaxSlotNumber << " slots each)");
+        return false;
+    }
+    
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    // Refuse to drop a slot that is in use; unassigned source slots carry no routes
+    for (const auto& slot : matrix_source_slots_) {
+        if (slot.slot_number > source_slots && slot.is_assigned) {
+            LOG_ERROR("Cannot shrink to " << source_slots << " source slots: slot " << slot.slot_number << " is assigned");
+            return false;
+        }
+    }
+    for (const auto& destination : matrix_destinations_) {
+        if (destination.slot_number > destination_slots) {
+            LOG_ERROR("Cannot shrink to " << destination_slots << " destination slots: slot "
+                      << destination.slot_number << " is in use");
+            return false;
+        }
+    }
+    
+    // Destination slots beyond the new size are free, so only the free list changes
+    matrix_size_.destination_slots = destination_slots;
+    free_destination_slots_.erase(
+        std::remove_if(free_destination_slots_.begin(), free_destination_slots_.end(),
+            [destination_slots](int slot_number) { return slot_number > destination_slots; }),
+        free_destination_slots_.end()
+    );
+    next_destination_slot_ = std::min(next_destination_slot_, destination_slots + 1);
+    
+    // Before Initialize() there are no slots yet; InitializeDefaultMatrix() creates them
+    int previous_source_slots = matrix_size_.source_slots;
+    matrix_size_.source_slots = source_slots;
+    if (matrix_source_slots_.empty() || source_slots == previous_source_slots) {
+        LOG_INFO("Matrix size set to " << source_slots << " source slots, " << destination_slots << " destination slots");
+        return true;
+    }
+    
+    // Slots are kept in slot order, so resizing only touches the tail
+    while (!matrix_source_slots_.empty() && matrix_source_slots_.back().slot_number > source_slots) {
+        source_slot_index_.Erase(matrix_source_slots_.back().slot_number);
+        matrix_source_slots_.pop_back();
+    }
+    for (int i = static_cast<int>(matrix_source_slots_.size()) + 1; i <= source_slots; ++i) {
+        MatrixSourceSlot slot;
+        slot.slot_number = i;
+        slot.display_name = "Slot " + std::to_string(i);
+        slot.is_assigned = false;
+        matrix_source_slots_.push_back(slot);
+        source_slot_index_.Set(i, static_cast<int>(matrix_source_slots_.size() - 1));
+    }
+    
+    // The change log has no entry for a removed slot; clients must refetch
+    change_log_.clear();
+    change_log_floor_ = state_version_.load() + 1;
+    NotifyStateChange(kSourceSlotsChanged);
+    
+    LOG_INFO("Matrix resized from " << previous_source_slots << " to " << source_slots << " source slots, "
+             << destination_slots << " destination slots");
+    return true;
+}
+
+MatrixSize NDIManager::GetMatrixSize() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    return matrix_size_;
+}
+
 void NDIManager::InitializeDefaultMatrix() {
-    // Initialize 16 source slots (empty by default)
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    
+    // Initialize empty source slots
     matrix_source_slots_.clear();
-    for (int i = 1; i <= 16; ++i) {
+    for (int i = 1; i <= matrix_size_.source_slots; ++i) {
         MatrixSourceSlot slot;
         slot.slot_number = i;
         slot.assigned_ndi_source = "";
@@ -573,48 +1268,195 @@ void NDIManager::InitializeDefaultMatrix() {
         matrix_source_slots_.push_back(slot);
     }
     
+    source_slot_index_.Rebuild(matrix_source_slots_, &MatrixSourceSlot::slot_number);
+    
     // Initialize empty destinations list (destinations will be created on demand)
     matrix_destinations_.clear();
+    destination_index_.Clear();
+    free_destination_slots_.clear();
+    next_destination_slot_ = 1;
+    matrix_routes_.clear();
+    route_index_.Clear();
+    routing_table_.Clear();
+    assigned_sources_stale_ = true;
+    PublishRoutingSnapshot();
+    source_table_.SetOwnOutputs({});
+    
+    // Everything changed; clients holding an older version must refetch
+    change_log_.clear();
+    change_log_floor_ = state_version_.load() + 1;
+    NotifyStateChange(kSourceSlotsChanged | kDestinationsChanged | kRoutesChanged);
     
-    std::cout << "Initialized default matrix: 16 source slots, 0 destinations (destinations created on demand)" << std::endl;
+    LOG_INFO("Initialized default matrix: " << matrix_size_.source_slots << " source slots, 0 of "
+             << matrix_size_.destination_slots << " destinations (destinations created on demand)");
 }
 
-void NDIManager::SetSourceUpdateCallback(std::function<void(const std::vector<NDISource>&)> callback) {
-    source_update_callback_ = callback;
+void NDIManager::SetSourceUpdateCallback(std::function<void(const SourceTableChanges&)> callback) {
+    std::lock_guard<std::mutex> lock(state_change_mutex_);
+    source_update_callback_ = std::move(callback);
 }
 
-std::string NDIManager::GenerateDestinationId() {
-    std::random_device rd;
-    std::mt19937 gen(rd());
-    std::uniform_int_distribution<> dis(0, 15);
-    
-    std::stringstream ss;
-    for (int i = 0; i < 8; ++i) {
-        ss << std::hex << dis(gen);
-        if (i == 3) ss << "-";
+void NDIManager::SetStateChangeCallback(std::function<void(uint32_t changes)> callback) {
+    // Waits out a notification in progress, so the old callback is not called after this returns
+    std::lock_guard<std::mutex> lock(state_change_mutex_);
+    state_change_callback_ = std::move(callback);
+}
+
+uint64_t NDIManager::GetStateVersion() const {
+    return state_version_.load(std::memory_order_acquire);
+}
+
+void NDIManager::LogChange(ChangedEntity entity, int slot_number) {
+    // Stamped with the version the following NotifyStateChange() publishes
+    change_log_.push_back({state_version_.load(std::memory_order_relaxed) + 1, entity, slot_number});
+    if (change_log_.size() > kMaxChangeLogEntries) {
+        change_log_floor_ = change_log_.front().version;
+        change_log_.pop_front();
     }
-    return ss.str();
 }
 
-MatrixDestination* NDIManager::FindMatrixDestination(int slot_number) {
-    for (auto& dest : matrix_destinations_) {
-        if (dest.slot_number == slot_number) {
-            return &dest;
+MatrixStateSnapshot NDIManager::GetMatrixState() {
+    MatrixStateSnapshot state;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    state.version = state_version_.load(std::memory_order_relaxed);
+    state.source_slots = matrix_source_slots_;
+    state.destinations = SortedBySlot(matrix_destinations_);
+    state.routes = matrix_routes_;
+    state.studio_monitor_source = current_studio_monitor_source_;
+    {
+        std::lock_guard<std::mutex> preview_lock(preview_mutex_);
+        state.preview_source = current_preview_source_;
+    }
+    return state;
+}
+
+MatrixChanges NDIManager::GetMatrixChangesSince(uint64_t since_version) {
+    MatrixChanges changes;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    changes.version = state_version_.load(std::memory_order_relaxed);
+    if (since_version < change_log_floor_ || since_version > changes.version) {
+        changes.resync = true;
+        return changes;
+    }
+
+    // Entries are in version order; walk back to the first one after since_version
+    auto first = change_log_.end();
+    while (first != change_log_.begin() && std::prev(first)->version > since_version) {
+        --first;
+    }
+
+    std::set<int> source_slots;
+    std::set<int> destinations;
+    std::set<int> routes;
+    for (auto it = first; it != change_log_.end(); ++it) {
+        switch (it->entity) {
+            case ChangedEntity::SourceSlot: source_slots.insert(it->slot_number); break;
+            case ChangedEntity::Destination: destinations.insert(it->slot_number); break;
+            case ChangedEntity::Route: routes.insert(it->slot_number); break;
+            case ChangedEntity::StudioMonitor: changes.studio_monitor_changed = true; break;
+            case ChangedEntity::Preview: changes.preview_changed = true; break;
+        }
+    }
+
+    for (int slot_number : source_slots) {
+        if (MatrixSourceSlot* slot = FindMatrixSourceSlot(slot_number)) {
+            changes.source_slots.push_back(*slot);
+        }
+    }
+    for (int slot_number : destinations) {
+        if (MatrixDestination* destination = FindMatrixDestination(slot_number)) {
+            changes.destinations.push_back(*destination);
+        } else {
+            changes.removed_destinations.push_back(slot_number);
+        }
+    }
+    for (int slot_number : routes) {
+        if (MatrixRoute* route = FindRouteForDestination(slot_number)) {
+            changes.routes.push_back(*route);
+        } else {
+            changes.removed_routes.push_back(slot_number);
         }
     }
-    return nullptr;
+    if (changes.studio_monitor_changed) {
+        changes.studio_monitor_source = current_studio_monitor_source_;
+    }
+    if (changes.preview_changed) {
+        std::lock_guard<std::mutex> preview_lock(preview_mutex_);
+        changes.preview_source = current_preview_source_;
+    }
+    return changes;
+}
+
+void NDIManager::NotifyStateChange(uint32_t changes) {
+    std::lock_guard<std::mutex> lock(state_change_mutex_);
+    state_version_.fetch_add(1, std::memory_order_acq_rel);
+    if (state_change_callback_) {
+        state_change_callback_(changes);
+    }
+}
+
+std::string NDIManager::GenerateDestinationId() {
+    // Same "xxxx-xxxx" hex format as before, from one draw of a generator seeded at startup
+    uint32_t value = static_cast<uint32_t>(route_id_rng_());
+    char id[10];
+    std::snprintf(id, sizeof(id), "%04x-%04x", value >> 16, value & 0xffff);
+    return id;
+}
+
+int NDIManager::AllocateDestinationSlot() {
+    if (!free_destination_slots_.empty()) {
+        int slot_number = free_destination_slots_.back();
+        free_destination_slots_.pop_back();
+        return slot_number;
+    }
+    if (next_destination_slot_ > matrix_size_.destination_slots) {
+        return 0;
+    }
+    return next_destination_slot_++;
+}
+
+void NDIManager::ReleaseDestinationSlot(int slot_number) {
+    if (slot_number == next_destination_slot_ - 1) {
+        next_destination_slot_--;
+    } else {
+        free_destination_slots_.push_back(slot_number);
+    }
+}
+
+MatrixDestination* NDIManager::FindMatrixDestination(int slot_number) {
+    int position = destination_index_.Find(slot_number);
+    return position != SlotIndex::kNone ? &matrix_destinations_[position] : nullptr;
 }
 
 MatrixSourceSlot* NDIManager::FindMatrixSourceSlot(int slot_number) {
-    for (auto& slot : matrix_source_slots_) {
-        if (slot.slot_number == slot_number) {
-            return &slot;
-        }
+    int position = source_slot_index_.Find(slot_number);
+    return position != SlotIndex::kNone ? &matrix_source_slots_[position] : nullptr;
+}
+
+MatrixRoute* NDIManager::FindRouteForDestination(int destination_slot) {
+    int position = route_index_.Find(destination_slot);
+    return position != SlotIndex::kNone ? &matrix_routes_[position] : nullptr;
+}
+
+bool NDIManager::EraseRouteForDestination(int destination_slot) {
+    int position = route_index_.Find(destination_slot);
+    if (position == SlotIndex::kNone) {
+        return false;
+    }
+    
+    // Swap-remove keeps this O(1); route order is not significant
+    if (static_cast<size_t>(position) != matrix_routes_.size() - 1) {
+        matrix_routes_[position] = std::move(matrix_routes_.back());
+        route_index_.Set(matrix_routes_[position].destination_slot, position);
     }
-    return nullptr;
+    matrix_routes_.pop_back();
+    route_index_.Erase(destination_slot);
+    return true;
 }
 
-NDIlib_recv_instance_t NDIManager::GetOrCreateReceiver(const std::string& source_name) {
+NDIReceiver NDIManager::GetOrCreateReceiver(const std::string& source_name) {
+    std::lock_guard<std::mutex> lock(receivers_mutex_);
+    
     // Check if we already have a receiver for this source
     auto it = route_receivers_.find(source_name);
     if (it != route_receivers_.end() && it->second) {
@@ -622,293 +1464,869 @@ NDIlib_recv_instance_t NDIManager::GetOrCreateReceiver(const std::string& source
     }
     
     // Create new receiver
-    std::string recv_name = "Router_Recv_" + source_name;
-    
-    NDIlib_recv_create_v3_t recv_desc;
-    recv_desc.source_to_connect_to.p_ndi_name = source_name.c_str();
-    recv_desc.source_to_connect_to.p_url_address = nullptr;
-    recv_desc.color_format = NDIlib_recv_color_format_BGRX_BGRA; // Standard format to preserve quality
-    recv_desc.bandwidth = NDIlib_recv_bandwidth_highest; // Keep native resolution and quality
-    recv_desc.allow_video_fields = false;
-    recv_desc.p_ndi_recv_name = recv_name.c_str();
+    ReceiverSettings settings;
+    settings.source_name = source_name;
+    settings.receiver_name = "Router_Recv_" + source_name;
+    settings.color_format = receive_mode_.load() == ReceiveMode::Passthrough
+        ? ReceiveColorFormat::UYVY_BGRA   // Native decode output, no per-frame conversion
+        : ReceiveColorFormat::BGRX_BGRA;
+    settings.bandwidth = ReceiveBandwidth::Highest; // Keep native resolution and quality
 
-    NDIlib_recv_instance_t receiver = NDIlib_recv_create_v3(&recv_desc);
+    NDIReceiver receiver = backend_->CreateReceiver(settings);
     if (receiver) {
         route_receivers_[source_name] = receiver;
-        std::cout << "Created receiver for source: " << source_name << std::endl;
+        LOG_DEBUG("Created receiver for source: " << source_name);
     }
     
     return receiver;
 }
 
-void NDIManager::CleanupUnusedReceivers() {
-    try {
-        std::cout << "=== STARTING RECEIVER CLEANUP ===" << std::endl;
-        std::cout << "Current receivers: " << route_receivers_.size() << std::endl;
-        std::cout << "Current routes: " << matrix_routes_.size() << std::endl;
+void NDIManager::ReleaseReceiver(const std::string& source_name, std::unique_ptr<VideoFramePool> frames) {
+    std::lock_guard<std::mutex> lock(receivers_mutex_);
+    auto it = route_receivers_.find(source_name);
+    if (it == route_receivers_.end()) {
+        return;
+    }
+    if (it->second && frames && !frames->AllReturned()) {
+        // A sender still holds a frame from it; the supervisor destroys it later
+        draining_receivers_.push_back({it->second, std::move(frames)});
+        LOG_DEBUG("Receiver for '" << source_name << "' waits for its frames before it is destroyed");
+    } else if (it->second) {
+        backend_->DestroyReceiver(it->second);
+        LOG_DEBUG("Destroyed receiver for: '" << source_name << "'");
+    }
+    route_receivers_.erase(it);
+}
+
+void NDIManager::ReclaimDrainingReceivers(bool force) {
+    std::lock_guard<std::mutex> lock(receivers_mutex_);
+    for (auto it = draining_receivers_.begin(); it != draining_receivers_.end();) {
+        if (!force && !it->frames->AllReturned()) {
+            ++it;
+            continue;
+        }
+        if (!it->frames->AllReturned()) {
+            LOG_WARN("Destroying a receiver with frames still out");
+        }
+        backend_->DestroyReceiver(it->receiver);
+        LOG_DEBUG("Destroyed a receiver once its frames were back");
+        it = draining_receivers_.erase(it);
+    }
+}
+
+void NDIManager::BuildIdleSlate() {
+    // UYVY black (Y=16, U=V=128): half the bytes of BGRA at a quarter of 720p
+    slate_buffer_.resize(static_cast<size_t>(kSlateWidth) * kSlateHeight * 2);
+    for (size_t i = 0; i < slate_buffer_.size(); i += 2) {
+        slate_buffer_[i] = 128;
+        slate_buffer_[i + 1] = 16;
+    }
+    
+    slate_frame_ = VideoFrame();
+    slate_frame_.xres = kSlateWidth;
+    slate_frame_.yres = kSlateHeight;
+    slate_frame_.fourcc = VideoFourCC::UYVY;
+    slate_frame_.picture_aspect_ratio = 16.0f / 9.0f;
+    slate_frame_.frame_format = VideoFrameFormat::Progressive;
+    slate_frame_.timecode = kNDITimecodeSynthesize;
+    slate_frame_.data = slate_buffer_.data();
+    slate_frame_.line_stride_in_bytes = kSlateWidth * 2;
+}
+
+void NDIManager::SetIdleSlateRate(double frames_per_second) {
+    if (!(frames_per_second > 0.0)) {
+        frames_per_second = 0.0;
+    }
+    idle_slate_fps_ = std::min(frames_per_second, kMaxSlateFps);
+    LOG_INFO("Idle slate rate set to " << idle_slate_fps_.load() << " fps");
+    NotifyRoutingChange();
+}
+
+double NDIManager::GetIdleSlateRate() const {
+    return idle_slate_fps_.load();
+}
+
+void NDIManager::SendIdleSlate(std::chrono::steady_clock::duration period) {
+    // Destinations with no route in the control-plane state; the send itself
+    // re-checks for recent routed video under the sender's lock
+    std::vector<NDISenderHandle> senders;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (const auto& dest : matrix_destinations_) {
+            // A clocked destination sends its own slate
+            if (dest.ndi_sender && !dest.output_clock.enabled && !FindRouteForDestination(dest.slot_number)) {
+                senders.push_back(dest.ndi_sender);
+            }
+        }
+    }
+    
+    // Advertise the cadence the slate actually runs at. slate_frame_ itself
+    // stays as built: clocked destinations copy it when they are created.
+    double fps = idle_slate_fps_.load();
+    VideoFrame slate = slate_frame_;
+    slate.frame_rate_N = std::max(1, static_cast<int>(fps * 1000.0 + 0.5));
+    slate.frame_rate_D = 1000;
+    
+    for (const auto& sender : senders) {
+        SendSlateIfIdle(*sender, slate, period);
+    }
+}
+
+void NDIManager::ProcessRoutes() {
+    LOG_INFO("Matrix routing supervisor started");
+    
+    auto last_status_time = std::chrono::steady_clock::now();
+    auto last_cleanup_time = last_status_time;
+    auto next_slate_time = last_status_time;
+    uint64_t synced_generation = 0;
+    bool needs_sync = true;
+    
+    while (!should_stop_routing_) {
+        double slate_fps = idle_slate_fps_.load();
+        auto slate_period = std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+            std::chrono::duration<double>(slate_fps > 0.0 ? 1.0 / slate_fps : 0.0));
         
-        // List all current receivers
-        for (const auto& pair : route_receivers_) {
-            std::cout << "  Receiver: '" << pair.first << "' -> " << (pair.second ? "valid" : "NULL") << std::endl;
+        // Sleep until the control plane changes something, housekeeping is due
+        // or idle destinations need their next slate frame
+        {
+            std::unique_lock<std::mutex> lock(routing_wakeup_mutex_);
+            auto next_wakeup = std::min(last_status_time + kStatusInterval, last_cleanup_time + kCleanupInterval);
+            if (slate_fps > 0.0) {
+                next_wakeup = std::min(next_wakeup, next_slate_time);
+            }
+            routing_wakeup_.wait_until(lock, next_wakeup, [this, synced_generation, needs_sync] {
+                return should_stop_routing_ || needs_sync || retired_senders_pending_ ||
+                       routing_generation_.load() != synced_generation;
+            });
+        }
+        if (should_stop_routing_) {
+            break;
         }
         
-        // Find receivers that are no longer used by any route
-        std::set<std::string> used_sources;
-        std::cout << "Checking which sources are still in use..." << std::endl;
+        // A capture worker dropped the last handle of a sender; tear it down here,
+        // then destroy receivers whose last frames that gave back
+        if (retired_senders_pending_.exchange(false)) {
+            ReclaimRetiredSenders();
+        }
+        ReclaimDrainingReceivers();
         
-        for (const auto& route : matrix_routes_) {
-            if (route.is_active) {
-                MatrixSourceSlot* src_slot = FindMatrixSourceSlot(route.source_slot);
-                if (src_slot && src_slot->is_assigned) {
-                    std::cout << "  Route uses source: '" << src_slot->assigned_ndi_source << "'" << std::endl;
-                    used_sources.insert(src_slot->assigned_ndi_source);
+        // A receive mode change reconnects every source; the sync below restarts workers
+        if (receivers_stale_.exchange(false)) {
+            ResetRouteReceivers();
+            needs_sync = true;
+        }
+        
+        auto current_time = std::chrono::steady_clock::now();
+        
+        // Keep unrouted outputs alive on the network with the cached slate
+        if (slate_fps > 0.0 && current_time >= next_slate_time) {
+            SendIdleSlate(slate_period);
+            next_slate_time = std::max(next_slate_time + slate_period, current_time);
+        }
+        
+        // Debug output every 10 seconds; skipped entirely unless debug logging is on
+        if (NDI_ROUTER_LOG_DEBUG_COMPILED && Logger::Enabled(LogLevel::Debug) &&
+            current_time - last_status_time >= kStatusInterval) {
+            {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                LOG_DEBUG("Routing status: " << matrix_routes_.size() << " routes, "
+                          << matrix_destinations_.size() << " destinations");
+                
+                // Show destination status
+                for (const auto& dest : matrix_destinations_) {
+                    LOG_DEBUG("  Destination '" << dest.name << "' slot " << dest.slot_number
+                              << " - sender: " << (dest.ndi_sender ? "OK" : "FAILED"));
                 }
             }
+            
+            // Show worker status
+            for (const auto& stats : GetRoutingWorkerStats()) {
+                LOG_DEBUG("  Worker '" << stats.source_name << "' -> " << stats.destination_count
+                          << " destinations, " << stats.frames_forwarded << " frames, avg loop "
+                          << stats.avg_loop_ms << " ms, max " << stats.max_loop_ms << " ms");
+            }
+            
+            last_status_time = current_time;
         }
         
-        std::cout << "Found " << used_sources.size() << " sources still in use by active routes" << std::endl;
-        
-        // Remove unused receivers safely
-        std::vector<std::string> receivers_to_remove;
-        for (const auto& pair : route_receivers_) {
-            if (used_sources.find(pair.first) == used_sources.end()) {
-                std::cout << "  Receiver '" << pair.first << "' is unused, marking for removal" << std::endl;
-                receivers_to_remove.push_back(pair.first);
-            } else {
-                std::cout << "  Receiver '" << pair.first << "' is still in use" << std::endl;
+        // Free snapshots no worker reads any more and let idle warm receivers expire (every 5 seconds)
+        if (current_time - last_cleanup_time >= kCleanupInterval) {
+            {
+                std::lock_guard<std::mutex> lock(state_mutex_);
+                ReclaimRetiredSnapshots();
             }
+            last_cleanup_time = current_time;
+            needs_sync = true;
         }
         
-        std::cout << "Will remove " << receivers_to_remove.size() << " unused receivers" << std::endl;
+        // A slot assignment changed which receivers the pool should keep warm
+        if (assigned_sources_stale_.exchange(false)) {
+            RefreshAssignedSources();
+            needs_sync = true;
+        }
         
-        for (const std::string& source_name : receivers_to_remove) {
-            try {
-                auto it = route_receivers_.find(source_name);
-                if (it != route_receivers_.end()) {
-                    if (it->second) {
-                        std::cout << "Destroying NDI receiver for: '" << source_name << "'" << std::endl;
-                        NDIlib_recv_destroy(it->second);
-                        std::cout << "NDI receiver destroyed successfully" << std::endl;
-                    } else {
-                        std::cout << "Receiver for '" << source_name << "' was already NULL" << std::endl;
-                    }
-                    route_receivers_.erase(it);
-                    std::cout << "Removed receiver entry for: '" << source_name << "'" << std::endl;
-                } else {
-                    std::cout << "WARNING: Receiver '" << source_name << "' not found in map" << std::endl;
-                }
-            } catch (const std::exception& e) {
-                std::cout << "ERROR destroying receiver '" << source_name << "': " << e.what() << std::endl;
-            } catch (...) {
-                std::cout << "UNKNOWN ERROR destroying receiver '" << source_name << "'" << std::endl;
-            }
+        // Sources left waiting on the worker cap are retried on housekeeping wakeups
+        uint64_t generation = routing_generation_.load();
+        if (!needs_sync && generation == synced_generation && pending_source_count_ == 0) {
+            continue;
         }
         
-        std::cout << "=== RECEIVER CLEANUP COMPLETED. Remaining receivers: " << route_receivers_.size() << " ===" << std::endl;
-    } catch (const std::exception& e) {
-        std::cout << "=== ERROR in CleanupUnusedReceivers: " << e.what() << " ===" << std::endl;
-    } catch (...) {
-        std::cout << "=== UNKNOWN ERROR in CleanupUnusedReceivers ===" << std::endl;
+        // The snapshot already groups routes by source, so each source is captured once
+        auto snapshot = LoadRoutingSnapshot();
+        if (snapshot) {
+            SyncSourceWorkers(*snapshot);
+        }
+        synced_generation = generation;
+        needs_sync = false;
+    }
+    
+    StopAllSourceWorkers();
+    LOG_INFO("Matrix routing supervisor stopped");
+}
+
+void NDIManager::NotifyRoutingChange() {
+    {
+        std::lock_guard<std::mutex> lock(routing_wakeup_mutex_);
+        routing_generation_.fetch_add(1, std::memory_order_release);
     }
+    routing_wakeup_.notify_all();
+}
+
+void NDIManager::RebuildRoutingTable() {
+    routing_table_.Rebuild(matrix_source_slots_, source_slot_index_,
+                           matrix_destinations_, destination_index_, matrix_routes_);
 }
 
-void NDIManager::SendTestFramesToAllDestinations() {
-    // Create a simple test frame to make NDI outputs visible on network
-    static int frame_counter = 0;
+void NDIManager::PublishRoutingSnapshot() {
+    // Shares every fan-out the last change did not touch with the previous snapshot
+    auto snapshot = routing_table_.Build();
     
-    // Create a simple 720p test frame (minimal overhead)
-    NDIlib_video_frame_v2_t test_frame;
-    test_frame.xres = 1280;
-    test_frame.yres = 720;
-    test_frame.FourCC = NDIlib_FourCC_type_BGRA;
-    test_frame.frame_rate_N = 30;
-    test_frame.frame_rate_D = 1;
-    test_frame.picture_aspect_ratio = 16.0f / 9.0f;
-    test_frame.frame_format_type = NDIlib_frame_format_type_progressive;
-    test_frame.timecode = frame_counter * 1000; // Simple timecode
-    test_frame.timestamp = 0; // Let NDI handle timestamp
+    auto previous = LoadRoutingSnapshot();
+    snapshot->version = previous ? previous->version + 1 : 1;
+    std::atomic_store(&routing_snapshot_, std::shared_ptr<const RoutingSnapshot>(std::move(snapshot)));
     
-    // Allocate minimal buffer (black frame)
-    size_t buffer_size = test_frame.xres * test_frame.yres * 4; // BGRA = 4 bytes per pixel
-    test_frame.p_data = (uint8_t*)malloc(buffer_size);
-    test_frame.line_stride_in_bytes = test_frame.xres * 4;
+    // Workers may still be sending from the previous snapshot; keep it (and the
+    // senders it references) alive until they have moved on
+    if (previous) {
+        retired_snapshots_.push_back(std::move(previous));
+    }
+    ReclaimRetiredSnapshots();
     
-    if (test_frame.p_data) {
-        // Fill with black (all zeros for BGRA black)
-        memset(test_frame.p_data, 0, buffer_size);
-        
-        // Send test frame to all destinations to make them visible
-        for (const auto& dest : matrix_destinations_) {
-            if (dest.ndi_sender) {
-                NDIlib_send_send_video_v2(dest.ndi_sender, &test_frame);
+    NotifyRoutingChange();
+}
+
+void NDIManager::ReclaimRetiredSnapshots() {
+    // A retired snapshot can no longer be loaded, so once we hold the only
+    // reference no worker can pick it up again and it is safe to free
+    retired_snapshots_.erase(
+        std::remove_if(retired_snapshots_.begin(), retired_snapshots_.end(),
+            [](const std::shared_ptr<const RoutingSnapshot>& snapshot) {
+                return snapshot.use_count() == 1;
+            }),
+        retired_snapshots_.end()
+    );
+    
+    // Usually the last handle of a removed destination went with its snapshot
+    ReclaimRetiredSenders();
+}
+
+// A clocked destination's output thread starts with the sender and shows the
+// slate while it has no source
+NDISenderHandle NDIManager::MakeSenderHandle(NDISender instance, const OutputClock& clock) {
+    auto* sender = new DestinationSender();
+    sender->backend = backend_.get();
+    sender->instance = instance;
+    if (clock.enabled) {
+        sender->sync = std::make_unique<FrameSync>(clock);
+        sender->sync->thread = std::thread(RunOutputClock, sender, slate_frame_);
+    }
+    return NDISenderHandle(sender, [this](DestinationSender* sender) {
+        RetireSender(sender);
+    });
+}
+
+void NDIManager::RetireSender(DestinationSender* sender) {
+    {
+        std::lock_guard<std::mutex> lock(retired_senders_mutex_);
+        retired_senders_.push_back(sender);
+    }
+    {
+        std::lock_guard<std::mutex> lock(routing_wakeup_mutex_);
+        retired_senders_pending_ = true;
+    }
+    routing_wakeup_.notify_all();
+}
+
+void NDIManager::ReclaimRetiredSenders() {
+    std::vector<DestinationSender*> senders;
+    {
+        std::lock_guard<std::mutex> lock(retired_senders_mutex_);
+        senders.swap(retired_senders_);
+    }
+    for (DestinationSender* sender : senders) {
+        DestroyDestinationSender(sender);
+    }
+}
+
+std::shared_ptr<const RoutingSnapshot> NDIManager::LoadRoutingSnapshot() const {
+    return std::atomic_load(&routing_snapshot_);
+}
+
+void NDIManager::RefreshAssignedSources() {
+    std::unordered_set<std::string> assigned;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        for (const auto& slot : matrix_source_slots_) {
+            if (slot.is_assigned && !slot.assigned_ndi_source.empty()) {
+                assigned.insert(slot.assigned_ndi_source);
             }
         }
-        
-        free(test_frame.p_data);
-        frame_counter++;
-        
-        static int last_log_frame = 0;
-        if (frame_counter - last_log_frame >= 300) { // Log every 10 seconds at 30fps
-            std::cout << "Sent test frames to " << matrix_destinations_.size() 
-                      << " destinations to maintain network visibility" << std::endl;
-            last_log_frame = frame_counter;
+    }
+    assigned_sources_.swap(assigned);
+}
+
+std::unordered_set<std::string> NDIManager::SelectWarmSources(
+    const std::unordered_map<std::string, uint32_t>& routed, std::chrono::steady_clock::time_point now) {
+    auto idle_timeout = std::chrono::seconds(warm_receiver_idle_timeout_s_.load());
+    
+    // A source in a slot counts as used from when it was assigned and never
+    // expires; any other source expires idle_timeout after its last route
+    for (const std::string& source_name : assigned_sources_) {
+        receiver_last_used_.emplace(source_name, now);
+    }
+    std::vector<std::pair<std::chrono::steady_clock::time_point, const std::string*>> candidates;
+    for (auto it = receiver_last_used_.begin(); it != receiver_last_used_.end();) {
+        if (!assigned_sources_.count(it->first) && now - it->second >= idle_timeout) {
+            it = receiver_last_used_.erase(it);
+            continue;
+        }
+        if (!routed.count(it->first)) {
+            candidates.emplace_back(it->second, &it->first);
         }
+        ++it;
+    }
+    
+    // Least recently used beyond the budget are evicted
+    size_t budget = warm_receiver_budget_.load();
+    if (candidates.size() > budget) {
+        std::nth_element(candidates.begin(), candidates.begin() + budget, candidates.end(),
+            [](const auto& a, const auto& b) { return a.first > b.first; });
+        candidates.resize(budget);
+    }
+    std::unordered_set<std::string> warm;
+    warm.reserve(candidates.size());
+    for (const auto& candidate : candidates) {
+        warm.insert(*candidate.second);
     }
+    return warm;
 }
 
-void NDIManager::ProcessRoutes() {
-    std::cout << "Matrix routing thread started" << std::endl;
+void NDIManager::SyncSourceWorkers(const RoutingSnapshot& snapshot) {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    auto now = std::chrono::steady_clock::now();
     
-    // Debug: Show routing status
-    static int debug_counter = 0;
-    static auto last_debug_time = std::chrono::steady_clock::now();
+    std::unordered_map<std::string, uint32_t> routed;
+    routed.reserve(snapshot.source_count);
+    snapshot.ForEachSource([&](uint32_t source_id, const RoutingSnapshot::SourceFanout& fanout) {
+        routed.emplace(fanout.source_name, source_id);
+        receiver_last_used_[fanout.source_name] = now;
+    });
+    std::unordered_set<std::string> warm = SelectWarmSources(routed, now);
     
-    while (!should_stop_routing_) {
-        // Check if we should pause for route updates
-        if (is_updating_routes_) {
-            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    size_t max_workers = max_source_workers_.load();
+    size_t routed_workers = 0;
+    auto has_capacity = [&routed_workers, max_workers] {
+        return max_workers == 0 || routed_workers < max_workers;
+    };
+    
+    // Routed workers follow their source's id: a source that lost every route
+    // and got one back may have a new one. Workers of unrouted sources either
+    // keep their receiver warm or stop.
+    std::vector<SourceWorker*> promoted;
+    for (auto it = source_workers_.begin(); it != source_workers_.end();) {
+        SourceWorker& worker = *it->second;
+        auto routed_it = routed.find(it->first);
+        if (routed_it != routed.end()) {
+            if (worker.routed) {
+                worker.source_id.store(routed_it->second, std::memory_order_release);
+                routed_workers++;
+            } else {
+                promoted.push_back(&worker);
+            }
+        } else if (warm.count(it->first)) {
+            // Drops frames until the next take, so the receiver never falls behind
+            worker.routed = false;
+            worker.source_id.store(RoutingSnapshot::kNoSource, std::memory_order_release);
+        } else {
+            LOG_DEBUG("Stopping capture worker for source: " << it->first);
+            StopSourceWorker(worker);
+            ReleaseReceiver(it->first, std::move(worker.frames));
+            it = source_workers_.erase(it);
+            continue;
+        }
+        ++it;
+    }
+    
+    // A take onto a warm source only hands its worker the fan-out id
+    size_t pending = 0;
+    for (SourceWorker* worker : promoted) {
+        if (!has_capacity()) {
+            pending++;
             continue;
         }
+        worker->routed = true;
+        worker->source_id.store(routed.at(worker->source_name), std::memory_order_release);
+        routed_workers++;
+    }
+    
+    snapshot.ForEachSource([&](uint32_t source_id, const RoutingSnapshot::SourceFanout& source) {
+        if (source_workers_.find(source.source_name) != source_workers_.end()) {
+            return;
+        }
+        if (!has_capacity()) {
+            pending++;
+            return;
+        }
+        if (StartSourceWorker(source.source_name, source_id)) {
+            routed_workers++;
+        }
+    });
+    
+    // Connect ahead of the take; warm workers do not count against the worker cap
+    for (const std::string& source_name : warm) {
+        if (source_workers_.find(source_name) == source_workers_.end()) {
+            StartSourceWorker(source_name, RoutingSnapshot::kNoSource);
+        }
+    }
+    warm_receiver_count_ = source_workers_.size() - routed_workers;
+    
+    if (pending != pending_source_count_.exchange(pending) && pending > 0) {
+        LOG_EVERY(LogLevel::Warn, 5000, "Worker limit (" << max_workers << ") reached, " << pending
+                  << " routed sources are waiting for a capture worker");
+    }
+}
+
+bool NDIManager::StartSourceWorker(const std::string& source_name, uint32_t source_id) {
+    NDIReceiver receiver = GetOrCreateReceiver(source_name);
+    if (!receiver) {
+        return false;
+    }
+    
+    auto worker = std::make_unique<SourceWorker>();
+    worker->source_name = source_name;
+    worker->serial = next_worker_serial_++;
+    worker->source_id.store(source_id, std::memory_order_relaxed);
+    worker->routed = source_id != RoutingSnapshot::kNoSource;
+    worker->receiver = receiver;
+    worker->frames = std::make_unique<VideoFramePool>(backend_.get(), receiver);
+    worker->thread = std::make_unique<std::thread>(&NDIManager::SourceWorkerLoop, this, worker.get());
+    LOG_DEBUG("Started " << (worker->routed ? "capture" : "warm") << " worker for source: " << source_name);
+    source_workers_[source_name] = std::move(worker);
+    return true;
+}
+
+void NDIManager::StopSourceWorker(SourceWorker& worker) {
+    worker.should_stop = true;
+    if (worker.thread && worker.thread->joinable()) {
+        worker.thread->join();
+    }
+}
+
+void NDIManager::StopAllSourceWorkers() {
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    for (auto& pair : source_workers_) {
+        StopSourceWorker(*pair.second);
+        ReleaseReceiver(pair.first, std::move(pair.second->frames));
+    }
+    source_workers_.clear();
+    pending_source_count_ = 0;
+    warm_receiver_count_ = 0;
+}
+
+void NDIManager::ResetRouteReceivers() {
+    StopAllSourceWorkers();
+    
+    std::lock_guard<std::mutex> lock(receivers_mutex_);
+    for (auto& pair : route_receivers_) {
+        if (pair.second) {
+            backend_->DestroyReceiver(pair.second);
+        }
+    }
+    LOG_INFO("Reset " << route_receivers_.size() << " route receivers");
+    route_receivers_.clear();
+}
+
+void NDIManager::SetReceiveMode(ReceiveMode mode) {
+    if (receive_mode_.exchange(mode) == mode) {
+        return;
+    }
+    LOG_INFO("Receive mode set to " << (mode == ReceiveMode::Passthrough ? "passthrough" : "bgra"));
+    receivers_stale_ = true;
+    NotifyRoutingChange();
+}
+
+ReceiveMode NDIManager::GetReceiveMode() const {
+    return receive_mode_.load();
+}
+
+void NDIManager::SourceWorkerLoop(SourceWorker* worker) {
+    uint32_t capture_timeout_ms = kDefaultFramePeriodMs;
+    
+    // Local reference to the routing table; only reloaded when the control plane publishes
+    std::shared_ptr<const RoutingSnapshot> snapshot;
+    const RoutingSnapshot::SourceFanout* fanout = nullptr;
+    uint64_t snapshot_generation = 0;
+    uint32_t snapshot_source_id = RoutingSnapshot::kNoSource;
+    const uint64_t serial = worker->serial;
+    
+    // Destinations switched to another source, which this one keeps feeding
+    // until the cut has happened
+    std::vector<DepartingDestination> departing;
+    
+    // Video frames stay with the backend while async sends use them. Remember every
+    // sender we fed so their last frame can be flushed before the receiver goes away.
+    // Keyed by owner, so membership never locks a handle.
+    VideoFramePool& frame_pool = *worker->frames;
+    std::set<std::weak_ptr<DestinationSender>, std::owner_less<std::weak_ptr<DestinationSender>>> fed_senders;
+    
+    auto iteration_start = std::chrono::steady_clock::now();
+    while (!worker->should_stop) {
+        VideoFrame video_frame;
+        AudioFrame audio_frame;
         
-        // Debug output every 10 seconds
-        auto current_time = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::seconds>(current_time - last_debug_time).count() >= 10) {
-            std::cout << "Routing status: " << matrix_routes_.size() << " routes, " 
-                      << matrix_destinations_.size() << " destinations" << std::endl;
-            
-            // Show destination status
-            for (const auto& dest : matrix_destinations_) {
-                std::cout << "  Destination '" << dest.name << "' slot " << dest.slot_number 
-                          << " - sender: " << (dest.ndi_sender ? "OK" : "FAILED") << std::endl;
+        // Block on this source only, for at most one frame period; the receiver returns
+        // as soon as a frame arrives so there is no added polling delay
+        CaptureResult frame_type = backend_->Capture(worker->receiver, &video_frame, &audio_frame, capture_timeout_ms);
+        worker->loop_iterations.fetch_add(1, std::memory_order_relaxed);
+        
+        auto loop_start = std::chrono::steady_clock::now();
+        if (frame_type != CaptureResult::Video && frame_type != CaptureResult::Audio) {
+            worker->total_iteration_us.fetch_add(
+                std::chrono::duration_cast<std::chrono::microseconds>(loop_start - iteration_start).count(),
+                std::memory_order_relaxed);
+            iteration_start = loop_start;
+            continue;
+        }
+        
+        uint64_t generation = routing_generation_.load(std::memory_order_acquire);
+        uint32_t source_id = worker->source_id.load(std::memory_order_acquire);
+        if (generation != snapshot_generation || source_id != snapshot_source_id || !snapshot) {
+            snapshot_generation = generation;
+            snapshot_source_id = source_id;
+            // The previous snapshot stays loaded until the departures are taken
+            std::shared_ptr<const RoutingSnapshot> previous_snapshot = std::move(snapshot);
+            const RoutingSnapshot::SourceFanout* previous_fanout = fanout;
+            snapshot = LoadRoutingSnapshot();
+            fanout = snapshot ? snapshot->FindSource(source_id, worker->source_name) : nullptr;
+            if (fanout != previous_fanout) {
+                UpdateDepartures(previous_fanout, fanout, departing);
             }
-            
-            // Send test frames to make outputs visible on network
-            if (matrix_routes_.empty()) {
-                SendTestFramesToAllDestinations();
+            // Senders that are gone were flushed when they were torn down
+            for (auto it = fed_senders.begin(); it != fed_senders.end();) {
+                it = it->expired() ? fed_senders.erase(it) : std::next(it);
+            }
+            if (fanout) {
+                fed_senders.insert(fanout->senders.begin(), fanout->senders.end());
             }
-            
-            last_debug_time = current_time;
         }
         
-        // Group routes by source to process frames efficiently
-        std::map<std::string, std::vector<MatrixDestination*>> source_to_destinations;
+        if (frame_type == CaptureResult::Video) {
+            capture_timeout_ms = FramePeriodMs(video_frame);
+        }
         
-        for (const auto& route : matrix_routes_) {
-            if (!route.is_active) continue;
-            
-            // Find the source slot
-            MatrixSourceSlot* src_slot = FindMatrixSourceSlot(route.source_slot);
-            if (!src_slot || !src_slot->is_assigned) continue;
-            
-            // Find the destination
-            MatrixDestination* dest = FindMatrixDestination(route.destination_slot);
-            if (!dest || !dest->ndi_sender) continue;
-            
-            // Group destinations by source
-            source_to_destinations[src_slot->assigned_ndi_source].push_back(dest);
+        // A warm worker (no route yet, or none any more) only drains the receiver,
+        // so the first frame after a take is a live one rather than a queued one.
+        // It lets go of the snapshot so a source that stops sending cannot keep
+        // retired snapshots alive; the next frame reloads it.
+        if (!fanout && departing.empty()) {
+            snapshot.reset();
+            if (frame_type == CaptureResult::Video) {
+                backend_->FreeVideo(worker->receiver, video_frame);
+            } else {
+                backend_->FreeAudio(worker->receiver, audio_frame);
+            }
+            worker->total_iteration_us.fetch_add(
+                std::chrono::duration_cast<std::chrono::microseconds>(loop_start - iteration_start).count(),
+                std::memory_order_relaxed);
+            iteration_start = loop_start;
+            continue;
         }
         
-        // Process each unique source once
-        for (const auto& source_group : source_to_destinations) {
-            const std::string& source_name = source_group.first;
-            const std::vector<MatrixDestination*>& destinations = source_group.second;
-            
-            // Get or create persistent receiver for this source
-            NDIlib_recv_instance_t receiver = GetOrCreateReceiver(source_name);
-            
-            if (receiver) {
-                // Try to receive frames
-                NDIlib_video_frame_v2_t video_frame;
-                NDIlib_audio_frame_v2_t audio_frame;
-                
-                switch (NDIlib_recv_capture_v2(receiver, &video_frame, &audio_frame, nullptr, 1)) { // 1ms timeout for non-blocking
-                    case NDIlib_frame_type_video:
-                        // Send the same video frame to all destinations using this source
-                        for (MatrixDestination* dest : destinations) {
-                            NDIlib_send_send_video_v2(dest->ndi_sender, &video_frame);
-                        }
-                        NDIlib_recv_free_video_v2(receiver, &video_frame);
-                        break;
-                        
-                    case NDIlib_frame_type_audio:
-                        // Send the same audio frame to all destinations using this source
-                        for (MatrixDestination* dest : destinations) {
-                            NDIlib_send_send_audio_v2(dest->ndi_sender, &audio_frame);
-                        }
-                        NDIlib_recv_free_audio_v2(receiver, &audio_frame);
-                        break;
-                        
-                    default:
-                        // No frame available, continue
-                        break;
+        if (frame_type == CaptureResult::Video) {
+            // Async fan-out: every destination shares the captured buffer and the
+            // worker goes straight back to capturing while the backend sends
+            int64_t source_age_ns = SourceAgeNs(video_frame.timestamp);
+            CapturedVideoFrame* shared_frame = frame_pool.Acquire(video_frame);
+            if (fanout) {
+                FeedTag tag{serial, snapshot->version, true};
+                for (size_t i = 0; i < fanout->senders.size(); ++i) {
+                    if (SendVideoAsync(*fanout->senders[i], shared_frame, tag)) {
+                        RecordRouteSend(fanout->route_stats[i].get(), loop_start, source_age_ns, false, 0);
+                    }
                 }
             }
+            // Departing destinations take video until the new source's first frame
+            for (auto it = departing.begin(); it != departing.end();) {
+                auto sender = it->sender.lock();
+                if (!sender || loop_start >= it->deadline || !StillFeeding(*sender, serial)) {
+                    it = departing.erase(it);
+                    continue;
+                }
+                SendVideoAsync(*sender, shared_frame, FeedTag{serial, 0, false});
+                ++it;
+            }
+            shared_frame->Release();
+            worker->video_frames.fetch_add(1, std::memory_order_relaxed);
+        } else {
+            // NDI has no async audio path; audio frames are small and copied on send.
+            // Around a cut each side's audio is trimmed to the video it sent.
+            int64_t source_age_ns = SourceAgeNs(audio_frame.timestamp);
+            if (fanout) {
+                FeedTag tag{serial, snapshot->version, true};
+                for (size_t i = 0; i < fanout->senders.size(); ++i) {
+                    int samples = SendAudio(*fanout->senders[i], audio_frame, tag);
+                    if (samples > 0) {
+                        RecordRouteSend(fanout->route_stats[i].get(), loop_start, source_age_ns, true, samples);
+                    }
+                }
+            }
+            for (auto it = departing.begin(); it != departing.end();) {
+                auto sender = it->sender.lock();
+                if (!sender || loop_start >= it->deadline || !StillFeeding(*sender, serial)) {
+                    it = departing.erase(it);
+                    continue;
+                }
+                SendAudio(*sender, audio_frame, FeedTag{serial, 0, false});
+                ++it;
+            }
+            worker->audio_frames.fetch_add(1, std::memory_order_relaxed);
+            worker->audio_samples.fetch_add(static_cast<uint64_t>(audio_frame.samples), std::memory_order_relaxed);
+            backend_->FreeAudio(worker->receiver, audio_frame);
         }
         
-        // Clean up unused receivers periodically (every 5 seconds)
-        static auto last_cleanup = std::chrono::steady_clock::now();
-        auto now = std::chrono::steady_clock::now();
-        if (std::chrono::duration_cast<std::chrono::seconds>(now - last_cleanup).count() >= 5) {
-            CleanupUnusedReceivers();
-            last_cleanup = now;
+        auto loop_end = std::chrono::steady_clock::now();
+        uint64_t loop_us = std::chrono::duration_cast<std::chrono::microseconds>(loop_end - loop_start).count();
+        worker->total_iteration_us.fetch_add(
+            std::chrono::duration_cast<std::chrono::microseconds>(loop_end - iteration_start).count(),
+            std::memory_order_relaxed);
+        iteration_start = loop_end;
+        worker->frames_forwarded.fetch_add(1, std::memory_order_relaxed);
+        worker->last_loop_us.store(loop_us, std::memory_order_relaxed);
+        worker->total_loop_us.fetch_add(loop_us, std::memory_order_relaxed);
+        worker->busy_iterations.fetch_add(1, std::memory_order_relaxed);
+        if (loop_us > worker->max_loop_us.load(std::memory_order_relaxed)) {
+            worker->max_loop_us.store(loop_us, std::memory_order_relaxed);
+        }
+    }
+    
+    // Take our frames back from every live sender. One that a retired sender
+    // (or another worker mid-way through replacing it) still holds comes back
+    // later; the supervisor destroys the receiver only once all have.
+    for (const auto& fed : fed_senders) {
+        if (auto sender = fed.lock()) {
+            FlushSender(*sender, &frame_pool);
         }
+    }
+}
+
+void NDIManager::SetMaxSourceWorkers(size_t max_workers) {
+    max_source_workers_ = max_workers;
+    LOG_INFO("Max capture workers set to " << max_workers << (max_workers == 0 ? " (unlimited)" : ""));
+}
+
+size_t NDIManager::GetMaxSourceWorkers() const {
+    return max_source_workers_.load();
+}
+
+size_t NDIManager::GetPendingSourceCount() const {
+    return pending_source_count_.load();
+}
+
+void NDIManager::SetWarmReceiverBudget(size_t budget) {
+    warm_receiver_budget_ = budget;
+    LOG_INFO("Warm receiver budget set to " << budget);
+    NotifyRoutingChange();
+}
+
+size_t NDIManager::GetWarmReceiverBudget() const {
+    return warm_receiver_budget_.load();
+}
+
+void NDIManager::SetWarmReceiverIdleTimeout(std::chrono::seconds idle_timeout) {
+    warm_receiver_idle_timeout_s_ = std::max<int64_t>(0, idle_timeout.count());
+    LOG_INFO("Warm receiver idle timeout set to " << warm_receiver_idle_timeout_s_.load() << " s");
+    NotifyRoutingChange();
+}
+
+size_t NDIManager::GetWarmReceiverCount() const {
+    return warm_receiver_count_.load();
+}
+
+std::vector<RoutingWorkerStats> NDIManager::GetRoutingWorkerStats() {
+    std::vector<RoutingWorkerStats> stats;
+    auto snapshot = LoadRoutingSnapshot();
+    std::lock_guard<std::mutex> lock(workers_mutex_);
+    
+    for (const auto& pair : source_workers_) {
+        SourceWorker& worker = *pair.second;
+        RoutingWorkerStats entry;
+        entry.source_name = worker.source_name;
+        entry.warm = !worker.routed;
+        const RoutingSnapshot::SourceFanout* fanout =
+            snapshot ? snapshot->FindSource(worker.source_id.load(std::memory_order_relaxed), worker.source_name) : nullptr;
+        entry.destination_count = fanout ? fanout->senders.size() : 0;
+        entry.loop_iterations = worker.loop_iterations.load(std::memory_order_relaxed);
+        entry.frames_forwarded = worker.frames_forwarded.load(std::memory_order_relaxed);
+        entry.video_frames = worker.video_frames.load(std::memory_order_relaxed);
+        entry.audio_frames = worker.audio_frames.load(std::memory_order_relaxed);
+        entry.audio_samples = worker.audio_samples.load(std::memory_order_relaxed);
+        uint64_t busy = worker.busy_iterations.load(std::memory_order_relaxed);
+        entry.last_loop_ms = worker.last_loop_us.load(std::memory_order_relaxed) / 1000.0;
+        entry.total_loop_ms = worker.total_loop_us.load(std::memory_order_relaxed) / 1000.0;
+        entry.avg_loop_ms = busy > 0 ? entry.total_loop_ms / busy : 0.0;
+        entry.max_loop_ms = worker.max_loop_us.load(std::memory_order_relaxed) / 1000.0;
+        entry.total_iteration_ms = worker.total_iteration_us.load(std::memory_order_relaxed) / 1000.0;
         
-        // Balanced delay for low latency without excessive CPU usage
-        std::this_thread::sleep_for(std::chrono::milliseconds(1)); // 1ms for good latency with reasonable CPU usage
+        // The receiver outlives its worker, and workers only go away under workers_mutex_
+        ReceiverPerformance performance = backend_->GetPerformance(worker.receiver);
+        entry.dropped_video_frames = performance.dropped_video_frames;
+        entry.dropped_audio_frames = performance.dropped_audio_frames;
+        entry.queued_video_frames = performance.queued_video_frames;
+        entry.queued_audio_frames = performance.queued_audio_frames;
+        stats.push_back(entry);
+    }
+    
+    return stats;
+}
+
+std::vector<RouteMetrics> NDIManager::GetRouteMetrics() {
+    std::vector<RouteMetrics> metrics;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    metrics.reserve(matrix_routes_.size());
+    
+    for (const auto& route : matrix_routes_) {
+        const MatrixSourceSlot* slot = FindMatrixSourceSlot(route.source_slot);
+        const MatrixDestination* dest = FindMatrixDestination(route.destination_slot);
+        RouteMetrics entry;
+        entry.source_slot = route.source_slot;
+        entry.destination_slot = route.destination_slot;
+        entry.source_name = slot ? slot->assigned_ndi_source : std::string();
+        entry.destination_name = dest ? dest->name : std::string();
+        const RouteStats* stats = route.stats.get();
+        entry.video_frames = stats ? stats->video_frames.load(std::memory_order_relaxed) : 0;
+        entry.audio_frames = stats ? stats->audio_frames.load(std::memory_order_relaxed) : 0;
+        entry.audio_samples = stats ? stats->audio_samples.load(std::memory_order_relaxed) : 0;
+        if (stats) {
+            entry.send_latency = stats->send_latency.Summarize();
+            entry.source_latency = stats->source_latency.Summarize();
+        }
+        metrics.push_back(std::move(entry));
     }
     
-    std::cout << "Matrix routing thread stopped" << std::endl;
+    return metrics;
+}
+
+bool NDIManager::ResetRouteLatency(int destination_slot) {
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    bool found = false;
+    for (const auto& route : matrix_routes_) {
+        if ((destination_slot == 0 || route.destination_slot == destination_slot) && route.stats) {
+            route.stats->send_latency.Reset();
+            route.stats->source_latency.Reset();
+            found = true;
+        }
+    }
+    return found || destination_slot == 0;
+}
+
+std::vector<DestinationMetrics> NDIManager::GetDestinationMetrics() {
+    std::vector<DestinationMetrics> metrics;
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    metrics.reserve(matrix_destinations_.size());
+    
+    for (const auto& dest : matrix_destinations_) {
+        DestinationMetrics entry;
+        entry.slot_number = dest.slot_number;
+        entry.name = dest.name;
+        const DestinationSender* sender = dest.ndi_sender.get();
+        // Zero timeout: reports the current count without waiting for a connection
+        entry.connections = sender ? backend_->GetConnectionCount(sender->instance, 0) : -1;
+        entry.video_frames = sender ? sender->video_frames_sent.load(std::memory_order_relaxed) : 0;
+        entry.audio_frames = sender ? sender->audio_frames_sent.load(std::memory_order_relaxed) : 0;
+        entry.slate_frames = sender ? sender->slate_frames_sent.load(std::memory_order_relaxed) : 0;
+        entry.cuts = sender ? sender->cuts.load(std::memory_order_relaxed) : 0;
+        const FrameSync* sync = sender ? sender->sync.get() : nullptr;
+        entry.frame_sync = sync != nullptr;
+        entry.repeated_frames = sync ? sync->repeated_frames.load(std::memory_order_relaxed) : 0;
+        entry.dropped_frames = sync ? sync->dropped_frames.load(std::memory_order_relaxed) : 0;
+        entry.late_ticks = sync ? sync->late_ticks.load(std::memory_order_relaxed) : 0;
+        entry.audio_fill_samples = sync ? sync->audio_fill_samples.load(std::memory_order_relaxed) : 0;
+        entry.audio_dropped_samples = sync ? sync->audio_dropped_samples.load(std::memory_order_relaxed) : 0;
+        metrics.push_back(std::move(entry));
+    }
+    
+    return metrics;
 }
 
 // Studio Monitor Source Control Implementation
 bool NDIManager::SetStudioMonitorSource(const std::string& source_name) {
-    std::cout << "Setting studio monitor source to: " << source_name << std::endl;
+    LOG_DEBUG("Setting studio monitor source to: " << source_name);
     
     // Simply track which source the studio monitors should be viewing
-    current_studio_monitor_source_ = source_name;
+    {
+        std::lock_guard<std::mutex> lock(state_mutex_);
+        if (current_studio_monitor_source_ == source_name) {
+            return true;
+        }
+        current_studio_monitor_source_ = source_name;
+        LogChange(ChangedEntity::StudioMonitor);
+        NotifyStateChange(kStudioMonitorChanged);
+    }
     
     // Use existing studio monitor functionality to tell all monitors to view this source
     // This leverages the existing DiscoverStudioMonitors() and studio monitor communication
     // No additional NDI receivers needed - much more efficient!
     
-    std::cout << "Studio monitor source set to: " << source_name << std::endl;
+    LOG_INFO("Studio monitor source set to: " << source_name);
     return true;
 }
 
 std::string NDIManager::GetStudioMonitorSource() {
+    std::lock_guard<std::mutex> lock(state_mutex_);
     return current_studio_monitor_source_;
 }
 
 void NDIManager::ClearStudioMonitorSource() {
-    std::cout << "Clearing studio monitor source" << std::endl;
+    LOG_INFO("Clearing studio monitor source");
+    std::lock_guard<std::mutex> lock(state_mutex_);
+    if (current_studio_monitor_source_.empty()) {
+        return;
+    }
     current_studio_monitor_source_.clear();
+    LogChange(ChangedEntity::StudioMonitor);
+    NotifyStateChange(kStudioMonitorChanged);
 }
 
 // Lightweight Preview System Implementation
 bool NDIManager::SetPreviewSource(const std::string& source_name) {
-    std::lock_guard<std::mutex> lock(preview_mutex_);
-    
-    std::cout << "Setting preview source to: " << source_name << std::endl;
-    
-    // Clear existing preview receiver if different source
-    if (current_preview_source_ != source_name && preview_receiver_) {
-        NDIlib_recv_destroy(preview_receiver_);
-        preview_receiver_ = nullptr;
-        cached_preview_image_.clear();
-    }
-    
-    current_preview_source_ = source_name;
-    
-    // Create receiver for preview source
-    if (!source_name.empty()) {
-        preview_receiver_ = GetOrCreateReceiver(source_name);
-        if (!preview_receiver_) {
-            std::cout << "Failed to create preview receiver for: " << source_name << std::endl;
-            return false;
+    {
+        // state_mutex_ first, so the selection and its version change together
+        std::lock_guard<std::mutex> state_lock(state_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(preview_mutex_);
+            if (current_preview_source_ == source_name) {
+                return true;
+            }
+            cached_preview_image_.clear();
+            current_preview_source_ = source_name;
         }
+        LogChange(ChangedEntity::Preview);
+        NotifyStateChange(kPreviewChanged);
     }
     
-    std::cout << "Preview source set to: " << source_name << std::endl;
+    // The preview thread connects its own receiver; routed outputs are unaffected
+    preview_wakeup_.notify_all();
+    LOG_INFO("Preview source set to: " << source_name);
     return true;
 }
 
@@ -919,43 +2337,110 @@ std::string NDIManager::GetPreviewSource() {
 
 std::string NDIManager::GetPreviewImage() {
     std::lock_guard<std::mutex> lock(preview_mutex_);
-    
-    if (!preview_receiver_ || current_preview_source_.empty()) {
-        return ""; // No preview source set
+    return cached_preview_image_;
+}
+
+void NDIManager::ClearPreviewSource() {
+    LOG_INFO("Clearing preview source");
+    {
+        std::lock_guard<std::mutex> state_lock(state_mutex_);
+        {
+            std::lock_guard<std::mutex> lock(preview_mutex_);
+            if (current_preview_source_.empty()) {
+                return;
+            }
+            current_preview_source_.clear();
+            cached_preview_image_.clear();
+        }
+        LogChange(ChangedEntity::Preview);
+        NotifyStateChange(kPreviewChanged);
     }
+    preview_wakeup_.notify_all();
+}
+
+void NDIManager::PreviewThread() {
+    PreviewEncoder encoder(kPreviewMaxWidth, kPreviewJpegQuality);
+    std::string receiver_source;
+    std::string encoded;
+    auto next_encode_time = std::chrono::steady_clock::now();
     
-    // Try to capture a frame
-    NDIlib_video_frame_v2_t video_frame;
-    
-    // Non-blocking capture with 1ms timeout
-    if (NDIlib_recv_capture_v2(preview_receiver_, &video_frame, nullptr, nullptr, 1) == NDIlib_frame_type_video) {
+    while (!should_stop_preview_) {
+        std::string wanted_source;
+        {
+            std::unique_lock<std::mutex> lock(preview_mutex_);
+            if (!preview_receiver_) {
+                preview_wakeup_.wait(lock, [this] {
+                    return should_stop_preview_ || !current_preview_source_.empty();
+                });
+            }
+            wanted_source = current_preview_source_;
+        }
+        if (should_stop_preview_) {
+            break;
+        }
+        
+        // Reconnect when the preview source changes
+        if (wanted_source != receiver_source || !preview_receiver_) {
+            if (preview_receiver_) {
+                backend_->DestroyReceiver(preview_receiver_);
+                preview_receiver_ = nullptr;
+            }
+            receiver_source = wanted_source;
+            if (receiver_source.empty()) {
+                continue;
+            }
+            
+            ReceiverSettings settings;
+            settings.source_name = receiver_source;
+            settings.receiver_name = "Router_Preview_" + receiver_source;
+            settings.color_format = ReceiveColorFormat::UYVY_BGRA;
+            settings.bandwidth = ReceiveBandwidth::Lowest;  // Proxy stream, not the program feed
+            
+            preview_receiver_ = backend_->CreateReceiver(settings);
+            if (!preview_receiver_) {
+                LOG_EVERY(LogLevel::Warn, 10000, "Failed to create preview receiver for: " << receiver_source);
+                std::unique_lock<std::mutex> lock(preview_mutex_);
+                preview_wakeup_.wait_for(lock, std::chrono::seconds(1), [this, &receiver_source] {
+                    return should_stop_preview_ || current_preview_source_ != receiver_source;
+                });
+                continue;
+            }
+            LOG_DEBUG("Created preview receiver for: " << receiver_source);
+        }
         
-        // Convert to base64 JPEG (simplified - you might need a proper image encoder)
-        // For now, return a placeholder that indicates we have a frame
-        std::string frame_info = "data:image/jpeg;base64,"; // Placeholder
+        // Keep draining so the newest frame is always the one encoded
+        VideoFrame video_frame;
+        if (backend_->Capture(preview_receiver_, &video_frame, nullptr, kPreviewCaptureTimeoutMs) != CaptureResult::Video) {
+            continue;
+        }
         
-        // Free the frame
-        NDIlib_recv_free_video_v2(preview_receiver_, &video_frame);
+        auto now = std::chrono::steady_clock::now();
+        bool encoded_frame = false;
+        if (now >= next_encode_time) {
+            bool supported = true;
+            PreviewPixelFormat format = PreviewPixelFormat::UYVY;
+            switch (video_frame.fourcc) {
+                case VideoFourCC::UYVY: format = PreviewPixelFormat::UYVY; break;
+                case VideoFourCC::BGRA:
+                case VideoFourCC::BGRX: format = PreviewPixelFormat::BGRA; break;
+                default: supported = false; break;
+            }
+            encoded_frame = supported && encoder.Encode(video_frame.data, video_frame.xres, video_frame.yres,
+                                                        video_frame.line_stride_in_bytes, format, encoded);
+            next_encode_time = now + kPreviewInterval;
+        }
+        backend_->FreeVideo(preview_receiver_, video_frame);
         
-        // Cache this as the latest preview image
-        cached_preview_image_ = frame_info + "FRAME_DATA_PLACEHOLDER";
-        return cached_preview_image_;
+        if (encoded_frame) {
+            std::lock_guard<std::mutex> lock(preview_mutex_);
+            if (current_preview_source_ == receiver_source) {
+                cached_preview_image_.swap(encoded);
+            }
+        }
     }
     
-    // Return cached image if no new frame
-    return cached_preview_image_;
-}
-
-void NDIManager::ClearPreviewSource() {
-    std::lock_guard<std::mutex> lock(preview_mutex_);
-    
-    std::cout << "Clearing preview source" << std::endl;
-    
     if (preview_receiver_) {
-        NDIlib_recv_destroy(preview_receiver_);
+        backend_->DestroyReceiver(preview_receiver_);
         preview_receiver_ = nullptr;
     }
-    
-    current_preview_source_.clear();
-    cached_preview_image_.clear();
-}
\ No newline at end of file
+}
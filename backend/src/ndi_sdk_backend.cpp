@@ -0,0 +1,245 @@
+#include "ndi_backend.h"
+#include <chrono>
+#include <thread>
+#include <Processing.NDI.Lib.h>
+
+namespace {
+// Lets the runtime come up and the finder hear the first announcements
+// before any sender is created
+constexpr auto kStartupSettleTime = std::chrono::milliseconds(500);
+
+NDIlib_recv_instance_t ToSdk(NDIReceiver receiver) { return reinterpret_cast<NDIlib_recv_instance_t>(receiver); }
+NDIlib_send_instance_t ToSdk(NDISender sender) { return reinterpret_cast<NDIlib_send_instance_t>(sender); }
+NDIlib_find_instance_t ToSdk(NDIFinder finder) { return reinterpret_cast<NDIlib_find_instance_t>(finder); }
+
+VideoFourCC FromSdk(NDIlib_FourCC_video_type_e fourcc) {
+    switch (fourcc) {
+        case NDIlib_FourCC_type_UYVY: return VideoFourCC::UYVY;
+        case NDIlib_FourCC_type_UYVA: return VideoFourCC::UYVA;
+        case NDIlib_FourCC_type_BGRA: return VideoFourCC::BGRA;
+        case NDIlib_FourCC_type_BGRX: return VideoFourCC::BGRX;
+        case NDIlib_FourCC_type_RGBA: return VideoFourCC::RGBA;
+        case NDIlib_FourCC_type_RGBX: return VideoFourCC::RGBX;
+        default: return VideoFourCC::Unsupported;
+    }
+}
+
+NDIlib_FourCC_video_type_e ToSdk(VideoFourCC fourcc) {
+    switch (fourcc) {
+        case VideoFourCC::UYVA: return NDIlib_FourCC_type_UYVA;
+        case VideoFourCC::BGRA: return NDIlib_FourCC_type_BGRA;
+        case VideoFourCC::BGRX: return NDIlib_FourCC_type_BGRX;
+        case VideoFourCC::RGBA: return NDIlib_FourCC_type_RGBA;
+        case VideoFourCC::RGBX: return NDIlib_FourCC_type_RGBX;
+        default: return NDIlib_FourCC_type_UYVY;
+    }
+}
+
+void FromSdk(const NDIlib_video_frame_v2_t& sdk, VideoFrame& frame) {
+    frame.xres = sdk.xres;
+    frame.yres = sdk.yres;
+    frame.fourcc = FromSdk(sdk.FourCC);
+    frame.frame_rate_N = sdk.frame_rate_N;
+    frame.frame_rate_D = sdk.frame_rate_D;
+    frame.picture_aspect_ratio = sdk.picture_aspect_ratio;
+    frame.frame_format = sdk.frame_format_type == NDIlib_frame_format_type_progressive
+        ? VideoFrameFormat::Progressive : VideoFrameFormat::Interleaved;
+    frame.timecode = sdk.timecode;
+    frame.data = sdk.p_data;
+    frame.line_stride_in_bytes = sdk.line_stride_in_bytes;
+    frame.metadata = sdk.p_metadata;
+    frame.timestamp = sdk.timestamp;
+}
+
+NDIlib_video_frame_v2_t ToSdk(const VideoFrame& frame) {
+    NDIlib_video_frame_v2_t sdk;
+    sdk.xres = frame.xres;
+    sdk.yres = frame.yres;
+    sdk.FourCC = ToSdk(frame.fourcc);
+    sdk.frame_rate_N = frame.frame_rate_N;
+    sdk.frame_rate_D = frame.frame_rate_D;
+    sdk.picture_aspect_ratio = frame.picture_aspect_ratio;
+    sdk.frame_format_type = frame.frame_format == VideoFrameFormat::Progressive
+        ? NDIlib_frame_format_type_progressive : NDIlib_frame_format_type_interleaved;
+    sdk.timecode = frame.timecode;
+    sdk.p_data = frame.data;
+    sdk.line_stride_in_bytes = frame.line_stride_in_bytes;
+    sdk.p_metadata = frame.metadata;
+    sdk.timestamp = frame.timestamp;
+    return sdk;
+}
+
+void FromSdk(const NDIlib_audio_frame_v2_t& sdk, AudioFrame& frame) {
+    frame.sample_rate = sdk.sample_rate;
+    frame.channels = sdk.no_channels;
+    frame.samples = sdk.no_samples;
+    frame.timecode = sdk.timecode;
+    frame.data = sdk.p_data;
+    frame.channel_stride_in_bytes = sdk.channel_stride_in_bytes;
+    frame.metadata = sdk.p_metadata;
+    frame.timestamp = sdk.timestamp;
+}
+
+NDIlib_audio_frame_v2_t ToSdk(const AudioFrame& frame) {
+    NDIlib_audio_frame_v2_t sdk;
+    sdk.sample_rate = frame.sample_rate;
+    sdk.no_channels = frame.channels;
+    sdk.no_samples = frame.samples;
+    sdk.timecode = frame.timecode;
+    sdk.p_data = frame.data;
+    sdk.channel_stride_in_bytes = frame.channel_stride_in_bytes;
+    sdk.p_metadata = frame.metadata;
+    sdk.timestamp = frame.timestamp;
+    return sdk;
+}
+
+class SDKBackend : public NDIBackend {
+public:
+    const char* name() const override { return "sdk"; }
+
+    bool Initialize() override { return NDIlib_initialize(); }
+    void Shutdown() override { NDIlib_destroy(); }
+
+    NDIFinder CreateFinder() override {
+        NDIlib_find_create_t find_desc;
+        find_desc.show_local_sources = true;
+        find_desc.p_groups = nullptr;
+        find_desc.p_extra_ips = nullptr;
+        NDIlib_find_instance_t finder = NDIlib_find_create_v2(&find_desc);
+        if (finder) {
+            std::this_thread::sleep_for(kStartupSettleTime);
+        }
+        return reinterpret_cast<NDIFinder>(finder);
+    }
+
+    void DestroyFinder(NDIFinder finder) override { NDIlib_find_destroy(ToSdk(finder)); }
+
+    bool WaitForSources(NDIFinder finder, uint32_t timeout_ms) override {
+        return NDIlib_find_wait_for_sources(ToSdk(finder), timeout_ms);
+    }
+
+    std::vector<NDISource> GetCurrentSources(NDIFinder finder) override {
+        uint32_t num_sources = 0;
+        const NDIlib_source_t* sdk_sources = NDIlib_find_get_current_sources(ToSdk(finder), &num_sources);
+        std::vector<NDISource> sources;
+        if (!sdk_sources) {
+            return sources;
+        }
+        sources.reserve(num_sources);
+        for (uint32_t i = 0; i < num_sources; i++) {
+            if (!sdk_sources[i].p_ndi_name || !sdk_sources[i].p_ndi_name[0]) {
+                continue;
+            }
+            NDISource source;
+            source.name = sdk_sources[i].p_ndi_name;
+            source.url = sdk_sources[i].p_url_address ? sdk_sources[i].p_url_address : "";
+            source.is_connected = true;
+            sources.push_back(std::move(source));
+        }
+        return sources;
+    }
+
+    NDIReceiver CreateReceiver(const ReceiverSettings& settings) override {
+        NDIlib_recv_create_v3_t recv_desc;
+        recv_desc.source_to_connect_to.p_ndi_name = settings.source_name.c_str();
+        recv_desc.source_to_connect_to.p_url_address = nullptr;
+        recv_desc.color_format = settings.color_format == ReceiveColorFormat::UYVY_BGRA
+            ? NDIlib_recv_color_format_UYVY_BGRA
+            : NDIlib_recv_color_format_BGRX_BGRA;
+        recv_desc.bandwidth = settings.bandwidth == ReceiveBandwidth::Highest
+            ? NDIlib_recv_bandwidth_highest
+            : NDIlib_recv_bandwidth_lowest;
+        recv_desc.allow_video_fields = false;
+        recv_desc.p_ndi_recv_name = settings.receiver_name.c_str();
+        return reinterpret_cast<NDIReceiver>(NDIlib_recv_create_v3(&recv_desc));
+    }
+
+    void DestroyReceiver(NDIReceiver receiver) override { NDIlib_recv_destroy(ToSdk(receiver)); }
+
+    CaptureResult Capture(NDIReceiver receiver, VideoFrame* video, AudioFrame* audio, uint32_t timeout_ms) override {
+        NDIlib_video_frame_v2_t sdk_video;
+        NDIlib_audio_frame_v2_t sdk_audio;
+        NDIlib_frame_type_e frame_type = NDIlib_recv_capture_v2(
+            ToSdk(receiver), video ? &sdk_video : nullptr, audio ? &sdk_audio : nullptr, nullptr, timeout_ms);
+        switch (frame_type) {
+            case NDIlib_frame_type_video:
+                FromSdk(sdk_video, *video);
+                if (video->fourcc == VideoFourCC::Unsupported) {
+                    NDIlib_recv_free_video_v2(ToSdk(receiver), &sdk_video);
+                    return CaptureResult::None;
+                }
+                return CaptureResult::Video;
+            case NDIlib_frame_type_audio:
+                FromSdk(sdk_audio, *audio);
+                return CaptureResult::Audio;
+            case NDIlib_frame_type_error:
+                return CaptureResult::Error;
+            default:
+                return CaptureResult::None;
+        }
+    }
+
+    void FreeVideo(NDIReceiver receiver, const VideoFrame& frame) override {
+        NDIlib_video_frame_v2_t sdk = ToSdk(frame);
+        NDIlib_recv_free_video_v2(ToSdk(receiver), &sdk);
+    }
+
+    void FreeAudio(NDIReceiver receiver, const AudioFrame& frame) override {
+        NDIlib_audio_frame_v2_t sdk = ToSdk(frame);
+        NDIlib_recv_free_audio_v2(ToSdk(receiver), &sdk);
+    }
+
+    ReceiverPerformance GetPerformance(NDIReceiver receiver) override {
+        ReceiverPerformance performance;
+        NDIlib_recv_performance_t total_frames = {};
+        NDIlib_recv_performance_t dropped_frames = {};
+        NDIlib_recv_get_performance(ToSdk(receiver), &total_frames, &dropped_frames);
+        performance.dropped_video_frames = static_cast<uint64_t>(dropped_frames.video_frames);
+        performance.dropped_audio_frames = static_cast<uint64_t>(dropped_frames.audio_frames);
+        NDIlib_recv_queue_t queue = {};
+        NDIlib_recv_get_queue(ToSdk(receiver), &queue);
+        performance.queued_video_frames = static_cast<uint32_t>(queue.video_frames);
+        performance.queued_audio_frames = static_cast<uint32_t>(queue.audio_frames);
+        return performance;
+    }
+
+    NDISender CreateSender(const std::string& name, bool clock_video, bool clock_audio) override {
+        NDIlib_send_create_t send_desc;
+        send_desc.p_ndi_name = name.c_str();
+        send_desc.p_groups = nullptr;
+        send_desc.clock_video = clock_video;
+        send_desc.clock_audio = clock_audio;
+        return reinterpret_cast<NDISender>(NDIlib_send_create(&send_desc));
+    }
+
+    void DestroySender(NDISender sender) override { NDIlib_send_destroy(ToSdk(sender)); }
+
+    void SendVideo(NDISender sender, const VideoFrame& frame) override {
+        NDIlib_video_frame_v2_t sdk = ToSdk(frame);
+        NDIlib_send_send_video_v2(ToSdk(sender), &sdk);
+    }
+
+    // The SDK copies the descriptor; only the pixel buffer has to outlive the call
+    void SendVideoAsync(NDISender sender, const VideoFrame* frame) override {
+        if (!frame) {
+            NDIlib_send_send_video_async_v2(ToSdk(sender), nullptr);
+            return;
+        }
+        NDIlib_video_frame_v2_t sdk = ToSdk(*frame);
+        NDIlib_send_send_video_async_v2(ToSdk(sender), &sdk);
+    }
+
+    void SendAudio(NDISender sender, const AudioFrame& frame) override {
+        NDIlib_audio_frame_v2_t sdk = ToSdk(frame);
+        NDIlib_send_send_audio_v2(ToSdk(sender), &sdk);
+    }
+
+    int GetConnectionCount(NDISender sender, uint32_t timeout_ms) override {
+        return NDIlib_send_get_no_connections(ToSdk(sender), timeout_ms);
+    }
+};
+}
+
+std::unique_ptr<NDIBackend> CreateSDKBackend() {
+    return std::make_unique<SDKBackend>();
+}
@@ -0,0 +1,514 @@
+#include "preview_encoder.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define PREVIEW_USE_SSE2 1
+#endif
+
+namespace {
+
+// Baseline JPEG tables from ITU T.81 Annex K
+const uint8_t kZigzag[64] = {
+     0,  1,  8, 16,  9,  2,  3, 10, 17, 24, 32, 25, 18, 11,  4,  5,
+    12, 19, 26, 33, 40, 48, 41, 34, 27, 20, 13,  6,  7, 14, 21, 28,
+    35, 42, 49, 56, 57, 50, 43, 36, 29, 22, 15, 23, 30, 37, 44, 51,
+    58, 59, 52, 45, 38, 31, 39, 46, 53, 60, 61, 54, 47, 55, 62, 63
+};
+
+const uint8_t kLumaQuant[64] = {
+    16, 11, 10, 16,  24,  40,  51,  61,
+    12, 12, 14, 19,  26,  58,  60,  55,
+    14, 13, 16, 24,  40,  57,  69,  56,
+    14, 17, 22, 29,  51,  87,  80,  62,
+    18, 22, 37, 56,  68, 109, 103,  77,
+    24, 35, 55, 64,  81, 104, 113,  92,
+    49, 64, 78, 87, 103, 121, 120, 101,
+    72, 92, 95, 98, 112, 100, 103,  99
+};
+
+const uint8_t kChromaQuant[64] = {
+    17, 18, 24, 47, 99, 99, 99, 99,
+    18, 21, 26, 66, 99, 99, 99, 99,
+    24, 26, 56, 99, 99, 99, 99, 99,
+    47, 66, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99,
+    99, 99, 99, 99, 99, 99, 99, 99
+};
+
+const uint8_t kDcLumaBits[16] = {0, 1, 5, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0, 0, 0};
+const uint8_t kDcChromaBits[16] = {0, 3, 1, 1, 1, 1, 1, 1, 1, 1, 1, 0, 0, 0, 0, 0};
+const uint8_t kDcValues[12] = {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11};
+
+const uint8_t kAcLumaBits[16] = {0, 2, 1, 3, 3, 2, 4, 3, 5, 5, 4, 4, 0, 0, 1, 0x7d};
+const uint8_t kAcLumaValues[162] = {
+    0x01, 0x02, 0x03, 0x00, 0x04, 0x11, 0x05, 0x12, 0x21, 0x31, 0x41, 0x06, 0x13, 0x51, 0x61, 0x07,
+    0x22, 0x71, 0x14, 0x32, 0x81, 0x91, 0xa1, 0x08, 0x23, 0x42, 0xb1, 0xc1, 0x15, 0x52, 0xd1, 0xf0,
+    0x24, 0x33, 0x62, 0x72, 0x82, 0x09, 0x0a, 0x16, 0x17, 0x18, 0x19, 0x1a, 0x25, 0x26, 0x27, 0x28,
+    0x29, 0x2a, 0x34, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48, 0x49,
+    0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68, 0x69,
+    0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x83, 0x84, 0x85, 0x86, 0x87, 0x88, 0x89,
+    0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5, 0xa6, 0xa7,
+    0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3, 0xc4, 0xc5,
+    0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda, 0xe1, 0xe2,
+    0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf1, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+const uint8_t kAcChromaBits[16] = {0, 2, 1, 2, 4, 4, 3, 4, 7, 5, 4, 4, 0, 1, 2, 0x77};
+const uint8_t kAcChromaValues[162] = {
+    0x00, 0x01, 0x02, 0x03, 0x11, 0x04, 0x05, 0x21, 0x31, 0x06, 0x12, 0x41, 0x51, 0x07, 0x61, 0x71,
+    0x13, 0x22, 0x32, 0x81, 0x08, 0x14, 0x42, 0x91, 0xa1, 0xb1, 0xc1, 0x09, 0x23, 0x33, 0x52, 0xf0,
+    0x15, 0x62, 0x72, 0xd1, 0x0a, 0x16, 0x24, 0x34, 0xe1, 0x25, 0xf1, 0x17, 0x18, 0x19, 0x1a, 0x26,
+    0x27, 0x28, 0x29, 0x2a, 0x35, 0x36, 0x37, 0x38, 0x39, 0x3a, 0x43, 0x44, 0x45, 0x46, 0x47, 0x48,
+    0x49, 0x4a, 0x53, 0x54, 0x55, 0x56, 0x57, 0x58, 0x59, 0x5a, 0x63, 0x64, 0x65, 0x66, 0x67, 0x68,
+    0x69, 0x6a, 0x73, 0x74, 0x75, 0x76, 0x77, 0x78, 0x79, 0x7a, 0x82, 0x83, 0x84, 0x85, 0x86, 0x87,
+    0x88, 0x89, 0x8a, 0x92, 0x93, 0x94, 0x95, 0x96, 0x97, 0x98, 0x99, 0x9a, 0xa2, 0xa3, 0xa4, 0xa5,
+    0xa6, 0xa7, 0xa8, 0xa9, 0xaa, 0xb2, 0xb3, 0xb4, 0xb5, 0xb6, 0xb7, 0xb8, 0xb9, 0xba, 0xc2, 0xc3,
+    0xc4, 0xc5, 0xc6, 0xc7, 0xc8, 0xc9, 0xca, 0xd2, 0xd3, 0xd4, 0xd5, 0xd6, 0xd7, 0xd8, 0xd9, 0xda,
+    0xe2, 0xe3, 0xe4, 0xe5, 0xe6, 0xe7, 0xe8, 0xe9, 0xea, 0xf2, 0xf3, 0xf4, 0xf5, 0xf6, 0xf7, 0xf8,
+    0xf9, 0xfa
+};
+
+struct HuffmanTable {
+    uint16_t code[256] = {};
+    uint8_t size[256] = {};
+
+    HuffmanTable(const uint8_t* bits, const uint8_t* values) {
+        uint16_t next = 0;
+        int k = 0;
+        for (int length = 1; length <= 16; ++length) {
+            for (int i = 0; i < bits[length - 1]; ++i, ++k) {
+                code[values[k]] = next++;
+                size[values[k]] = static_cast<uint8_t>(length);
+            }
+            next <<= 1;
+        }
+    }
+};
+
+const HuffmanTable& DcLumaTable() { static const HuffmanTable table(kDcLumaBits, kDcValues); return table; }
+const HuffmanTable& DcChromaTable() { static const HuffmanTable table(kDcChromaBits, kDcValues); return table; }
+const HuffmanTable& AcLumaTable() { static const HuffmanTable table(kAcLumaBits, kAcLumaValues); return table; }
+const HuffmanTable& AcChromaTable() { static const HuffmanTable table(kAcChromaBits, kAcChromaValues); return table; }
+
+// cos_table[u][x] = C(u)/2 * cos((2x + 1) * u * pi / 16)
+struct DctTable {
+    float c[8][8];
+    DctTable() {
+        const double pi = 3.14159265358979323846;
+        for (int u = 0; u < 8; ++u) {
+            double scale = (u == 0 ? std::sqrt(0.5) : 1.0) * 0.5;
+            for (int x = 0; x < 8; ++x) {
+                c[u][x] = static_cast<float>(scale * std::cos((2 * x + 1) * u * pi / 16.0));
+            }
+        }
+    }
+};
+
+const DctTable& Dct() { static const DctTable table; return table; }
+
+// Separable 8x8 forward DCT, natural order in and out
+void ForwardDct(const float* in, float* out) {
+    const DctTable& t = Dct();
+    float rows[64];
+    for (int y = 0; y < 8; ++y) {
+        for (int u = 0; u < 8; ++u) {
+            float sum = 0.0f;
+            for (int x = 0; x < 8; ++x) sum += t.c[u][x] * in[y * 8 + x];
+            rows[y * 8 + u] = sum;
+        }
+    }
+    for (int u = 0; u < 8; ++u) {
+        for (int v = 0; v < 8; ++v) {
+            float sum = 0.0f;
+            for (int y = 0; y < 8; ++y) sum += t.c[v][y] * rows[y * 8 + u];
+            out[v * 8 + u] = sum;
+        }
+    }
+}
+
+// Entropy-coded segment writer with 0xFF byte stuffing
+class BitWriter {
+public:
+    explicit BitWriter(std::vector<uint8_t>& out) : out_(out) {}
+
+    void Write(uint32_t bits, int count) {
+        buffer_ = (buffer_ << count) | (bits & ((1u << count) - 1));
+        count_ += count;
+        while (count_ >= 8) {
+            uint8_t byte = static_cast<uint8_t>(buffer_ >> (count_ - 8));
+            out_.push_back(byte);
+            if (byte == 0xFF) out_.push_back(0x00);
+            count_ -= 8;
+        }
+    }
+
+    void Flush() {
+        if (count_ > 0) Write(0x7F, 8 - count_);  // Pad with 1 bits
+    }
+
+private:
+    std::vector<uint8_t>& out_;
+    uint32_t buffer_ = 0;
+    int count_ = 0;
+};
+
+int BitLength(int value) {
+    int magnitude = value < 0 ? -value : value;
+    int length = 0;
+    while (magnitude) {
+        ++length;
+        magnitude >>= 1;
+    }
+    return length;
+}
+
+void WriteCoefficient(BitWriter& writer, const HuffmanTable& table, int symbol_high, int value) {
+    int length = BitLength(value);
+    int symbol = (symbol_high << 4) | length;
+    writer.Write(table.code[symbol], table.size[symbol]);
+    if (length) {
+        writer.Write(value < 0 ? value - 1 : value, length);
+    }
+}
+
+// Quantize and Huffman-code one block; returns the new DC predictor
+int EncodeBlock(BitWriter& writer, const float* samples, const float* divisors, int previous_dc,
+                const HuffmanTable& dc_table, const HuffmanTable& ac_table) {
+    float coefficients[64];
+    ForwardDct(samples, coefficients);
+
+    int quantized[64];
+    for (int i = 0; i < 64; ++i) {
+        int natural = kZigzag[i];
+        quantized[i] = static_cast<int>(std::lround(coefficients[natural] * divisors[natural]));
+    }
+
+    WriteCoefficient(writer, dc_table, 0, quantized[0] - previous_dc);
+
+    int zero_run = 0;
+    for (int i = 1; i < 64; ++i) {
+        if (quantized[i] == 0) {
+            ++zero_run;
+            continue;
+        }
+        while (zero_run >= 16) {
+            writer.Write(ac_table.code[0xF0], ac_table.size[0xF0]);  // ZRL
+            zero_run -= 16;
+        }
+        WriteCoefficient(writer, ac_table, zero_run, quantized[i]);
+        zero_run = 0;
+    }
+    if (zero_run > 0) {
+        writer.Write(ac_table.code[0x00], ac_table.size[0x00]);  // EOB
+    }
+    return quantized[0];
+}
+
+void WriteMarker(std::vector<uint8_t>& out, uint8_t marker) {
+    out.push_back(0xFF);
+    out.push_back(marker);
+}
+
+void WriteWord(std::vector<uint8_t>& out, int value) {
+    out.push_back(static_cast<uint8_t>(value >> 8));
+    out.push_back(static_cast<uint8_t>(value));
+}
+
+void WriteHuffmanTable(std::vector<uint8_t>& out, uint8_t table_id, const uint8_t* bits, const uint8_t* values) {
+    out.push_back(table_id);
+    int count = 0;
+    for (int i = 0; i < 16; ++i) {
+        out.push_back(bits[i]);
+        count += bits[i];
+    }
+    out.insert(out.end(), values, values + count);
+}
+
+uint8_t ClampByte(int value) {
+    return static_cast<uint8_t>(std::min(255, std::max(0, value)));
+}
+
+} // namespace
+
+void PreviewPlanes::Resize(int new_width, int new_height) {
+    width = new_width;
+    height = new_height;
+    size_t size = static_cast<size_t>(new_width) * new_height;
+    y.resize(size);
+    cb.resize(size);
+    cr.resize(size);
+}
+
+void DownscaleUyvy2x(const uint8_t* src, int width, int height, int stride, PreviewPlanes& out) {
+    // One output pixel per UYVY macropixel: Y averaged, U/V taken as-is
+    const int out_width = width / 2;
+    const int out_height = (height + 1) / 2;
+    out.Resize(out_width, out_height);
+
+    for (int oy = 0; oy < out_height; ++oy) {
+        const uint8_t* row0 = src + static_cast<size_t>(2 * oy) * stride;
+        const uint8_t* row1 = src + static_cast<size_t>(std::min(2 * oy + 1, height - 1)) * stride;
+        uint8_t* y_out = &out.y[static_cast<size_t>(oy) * out_width];
+        uint8_t* cb_out = &out.cb[static_cast<size_t>(oy) * out_width];
+        uint8_t* cr_out = &out.cr[static_cast<size_t>(oy) * out_width];
+        int ox = 0;
+
+#ifdef PREVIEW_USE_SSE2
+        const __m128i ones16 = _mm_set1_epi16(1);
+        const __m128i one32 = _mm_set1_epi32(1);
+        const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+        const __m128i low_words = _mm_set1_epi32(0x0000FFFF);
+        for (; ox + 8 <= out_width; ox += 8) {
+            const uint8_t* p0 = row0 + ox * 4;
+            const uint8_t* p1 = row1 + ox * 4;
+            __m128i v0 = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p0)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1)));
+            __m128i v1 = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p0 + 16)),
+                                      _mm_loadu_si128(reinterpret_cast<const __m128i*>(p1 + 16)));
+
+            // Luma sits in the odd bytes; sum each macropixel's pair
+            __m128i y0 = _mm_madd_epi16(_mm_srli_epi16(v0, 8), ones16);
+            __m128i y1 = _mm_madd_epi16(_mm_srli_epi16(v1, 8), ones16);
+            y0 = _mm_srli_epi32(_mm_add_epi32(y0, one32), 1);
+            y1 = _mm_srli_epi32(_mm_add_epi32(y1, one32), 1);
+            __m128i y16 = _mm_packs_epi32(y0, y1);
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(y_out + ox), _mm_packus_epi16(y16, y16));
+
+            // Chroma in the even bytes, alternating U and V
+            __m128i c0 = _mm_and_si128(v0, low_bytes);
+            __m128i c1 = _mm_and_si128(v1, low_bytes);
+            __m128i u16 = _mm_packs_epi32(_mm_and_si128(c0, low_words), _mm_and_si128(c1, low_words));
+            __m128i v16 = _mm_packs_epi32(_mm_srli_epi32(c0, 16), _mm_srli_epi32(c1, 16));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(cb_out + ox), _mm_packus_epi16(u16, u16));
+            _mm_storel_epi64(reinterpret_cast<__m128i*>(cr_out + ox), _mm_packus_epi16(v16, v16));
+        }
+#endif
+
+        for (; ox < out_width; ++ox) {
+            const uint8_t* p0 = row0 + ox * 4;
+            const uint8_t* p1 = row1 + ox * 4;
+            int u = (p0[0] + p1[0] + 1) >> 1;
+            int y_a = (p0[1] + p1[1] + 1) >> 1;
+            int v = (p0[2] + p1[2] + 1) >> 1;
+            int y_b = (p0[3] + p1[3] + 1) >> 1;
+            y_out[ox] = static_cast<uint8_t>((y_a + y_b + 1) >> 1);
+            cb_out[ox] = static_cast<uint8_t>(u);
+            cr_out[ox] = static_cast<uint8_t>(v);
+        }
+    }
+}
+
+void DownscaleBgra2x(const uint8_t* src, int width, int height, int stride, PreviewPlanes& out) {
+    // BGRA only shows up for sources with alpha; scalar is fine at preview rates
+    const int out_width = (width + 1) / 2;
+    const int out_height = (height + 1) / 2;
+    out.Resize(out_width, out_height);
+
+    for (int oy = 0; oy < out_height; ++oy) {
+        const uint8_t* row0 = src + static_cast<size_t>(2 * oy) * stride;
+        const uint8_t* row1 = src + static_cast<size_t>(std::min(2 * oy + 1, height - 1)) * stride;
+        size_t out_row = static_cast<size_t>(oy) * out_width;
+
+        for (int ox = 0; ox < out_width; ++ox) {
+            int x0 = 2 * ox * 4;
+            int x1 = std::min(2 * ox + 1, width - 1) * 4;
+            int b = (row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) >> 2;
+            int g = (row0[x0 + 1] + row0[x1 + 1] + row1[x0 + 1] + row1[x1 + 1] + 2) >> 2;
+            int r = (row0[x0 + 2] + row0[x1 + 2] + row1[x0 + 2] + row1[x1 + 2] + 2) >> 2;
+
+            // BT.601 video range, matching what the UYVY path produces
+            out.y[out_row + ox] = ClampByte(((66 * r + 129 * g + 25 * b + 128) >> 8) + 16);
+            out.cb[out_row + ox] = ClampByte(((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128);
+            out.cr[out_row + ox] = ClampByte(((112 * r - 94 * g - 18 * b + 128) >> 8) + 128);
+        }
+    }
+}
+
+void DownscalePlanes2x(const PreviewPlanes& src, PreviewPlanes& out) {
+    const int out_width = (src.width + 1) / 2;
+    const int out_height = (src.height + 1) / 2;
+    out.Resize(out_width, out_height);
+
+    const std::vector<uint8_t>* src_planes[3] = {&src.y, &src.cb, &src.cr};
+    std::vector<uint8_t>* out_planes[3] = {&out.y, &out.cb, &out.cr};
+
+    for (int plane = 0; plane < 3; ++plane) {
+        const uint8_t* in = src_planes[plane]->data();
+        uint8_t* dst = out_planes[plane]->data();
+
+        for (int oy = 0; oy < out_height; ++oy) {
+            const uint8_t* row0 = in + static_cast<size_t>(2 * oy) * src.width;
+            const uint8_t* row1 = in + static_cast<size_t>(std::min(2 * oy + 1, src.height - 1)) * src.width;
+            uint8_t* out_row = dst + static_cast<size_t>(oy) * out_width;
+            int ox = 0;
+
+#ifdef PREVIEW_USE_SSE2
+            const __m128i low_bytes = _mm_set1_epi16(0x00FF);
+            const __m128i one16 = _mm_set1_epi16(1);
+            for (; 2 * ox + 16 <= src.width; ox += 8) {
+                __m128i v = _mm_avg_epu8(_mm_loadu_si128(reinterpret_cast<const __m128i*>(row0 + 2 * ox)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(row1 + 2 * ox)));
+                __m128i sum = _mm_add_epi16(_mm_and_si128(v, low_bytes), _mm_srli_epi16(v, 8));
+                __m128i avg = _mm_srli_epi16(_mm_add_epi16(sum, one16), 1);
+                _mm_storel_epi64(reinterpret_cast<__m128i*>(out_row + ox), _mm_packus_epi16(avg, avg));
+            }
+#endif
+
+            for (; ox < out_width; ++ox) {
+                int x0 = 2 * ox;
+                int x1 = std::min(2 * ox + 1, src.width - 1);
+                out_row[ox] = static_cast<uint8_t>((row0[x0] + row0[x1] + row1[x0] + row1[x1] + 2) >> 2);
+            }
+        }
+    }
+}
+
+std::string Base64Encode(const uint8_t* data, size_t size) {
+    static const char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+    std::string encoded;
+    encoded.reserve((size + 2) / 3 * 4);
+
+    size_t i = 0;
+    for (; i + 3 <= size; i += 3) {
+        uint32_t triple = (data[i] << 16) | (data[i + 1] << 8) | data[i + 2];
+        encoded.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 6) & 0x3F]);
+        encoded.push_back(kAlphabet[triple & 0x3F]);
+    }
+    if (i < size) {
+        uint32_t triple = data[i] << 16;
+        if (i + 1 < size) triple |= data[i + 1] << 8;
+        encoded.push_back(kAlphabet[(triple >> 18) & 0x3F]);
+        encoded.push_back(kAlphabet[(triple >> 12) & 0x3F]);
+        encoded.push_back(i + 1 < size ? kAlphabet[(triple >> 6) & 0x3F] : '=');
+        encoded.push_back('=');
+    }
+    return encoded;
+}
+
+PreviewEncoder::PreviewEncoder(int max_width, int quality) : max_width_(std::max(16, max_width)) {
+    // IJG quality scaling
+    quality = std::min(100, std::max(1, quality));
+    int scale = quality < 50 ? 5000 / quality : 200 - quality * 2;
+
+    for (int i = 0; i < 64; ++i) {
+        int luma = std::min(255, std::max(1, (kLumaQuant[i] * scale + 50) / 100));
+        int chroma = std::min(255, std::max(1, (kChromaQuant[i] * scale + 50) / 100));
+        luma_divisors_[i] = 1.0f / luma;
+        chroma_divisors_[i] = 1.0f / chroma;
+    }
+    for (int i = 0; i < 64; ++i) {
+        luma_quant_[i] = static_cast<uint8_t>(1.0f / luma_divisors_[kZigzag[i]] + 0.5f);
+        chroma_quant_[i] = static_cast<uint8_t>(1.0f / chroma_divisors_[kZigzag[i]] + 0.5f);
+    }
+
+    // JFIF expects full-range YCbCr; NDI video is video range
+    for (int v = 0; v < 256; ++v) {
+        luma_range_[v] = ClampByte(static_cast<int>(std::lround((v - 16) * 255.0 / 219.0)));
+        chroma_range_[v] = ClampByte(static_cast<int>(std::lround((v - 128) * 255.0 / 224.0 + 128.0)));
+    }
+}
+
+bool PreviewEncoder::Encode(const uint8_t* data, int width, int height, int stride,
+                            PreviewPixelFormat format, std::string& data_uri) {
+    if (!data || width < 2 || height < 2) {
+        return false;
+    }
+
+    // The first halving also converts to planar YCbCr
+    if (format == PreviewPixelFormat::UYVY) {
+        DownscaleUyvy2x(data, width, height, stride, planes_);
+    } else {
+        DownscaleBgra2x(data, width, height, stride, planes_);
+    }
+    while (planes_.width > max_width_) {
+        DownscalePlanes2x(planes_, scratch_);
+        std::swap(planes_, scratch_);
+    }
+
+    EncodeJpeg(planes_);
+    data_uri = "data:image/jpeg;base64," + Base64Encode(jpeg_.data(), jpeg_.size());
+    return true;
+}
+
+void PreviewEncoder::EncodeJpeg(const PreviewPlanes& planes) {
+    jpeg_.clear();
+
+    WriteMarker(jpeg_, 0xD8);  // SOI
+
+    // APP0 / JFIF 1.01, no density units
+    static const uint8_t kJfif[] = {'J', 'F', 'I', 'F', 0, 1, 1, 0, 0, 1, 0, 1, 0, 0};
+    WriteMarker(jpeg_, 0xE0);
+    WriteWord(jpeg_, 2 + sizeof(kJfif));
+    jpeg_.insert(jpeg_.end(), kJfif, kJfif + sizeof(kJfif));
+
+    WriteMarker(jpeg_, 0xDB);  // DQT
+    WriteWord(jpeg_, 2 + 2 * 65);
+    jpeg_.push_back(0x00);
+    jpeg_.insert(jpeg_.end(), luma_quant_, luma_quant_ + 64);
+    jpeg_.push_back(0x01);
+    jpeg_.insert(jpeg_.end(), chroma_quant_, chroma_quant_ + 64);
+
+    WriteMarker(jpeg_, 0xC0);  // SOF0, 4:4:4
+    WriteWord(jpeg_, 8 + 3 * 3);
+    jpeg_.push_back(8);
+    WriteWord(jpeg_, planes.height);
+    WriteWord(jpeg_, planes.width);
+    jpeg_.push_back(3);
+    const uint8_t components[3][3] = {{1, 0x11, 0}, {2, 0x11, 1}, {3, 0x11, 1}};
+    for (const auto& component : components) {
+        jpeg_.insert(jpeg_.end(), component, component + 3);
+    }
+
+    WriteMarker(jpeg_, 0xC4);  // DHT
+    WriteWord(jpeg_, 2 + 4 * 17 + 12 + 12 + 162 + 162);
+    WriteHuffmanTable(jpeg_, 0x00, kDcLumaBits, kDcValues);
+    WriteHuffmanTable(jpeg_, 0x10, kAcLumaBits, kAcLumaValues);
+    WriteHuffmanTable(jpeg_, 0x01, kDcChromaBits, kDcValues);
+    WriteHuffmanTable(jpeg_, 0x11, kAcChromaBits, kAcChromaValues);
+
+    WriteMarker(jpeg_, 0xDA);  // SOS
+    WriteWord(jpeg_, 6 + 2 * 3);
+    jpeg_.push_back(3);
+    const uint8_t scan[3][2] = {{1, 0x00}, {2, 0x11}, {3, 0x11}};
+    for (const auto& component : scan) {
+        jpeg_.insert(jpeg_.end(), component, component + 2);
+    }
+    jpeg_.push_back(0);
+    jpeg_.push_back(63);
+    jpeg_.push_back(0);
+
+    BitWriter writer(jpeg_);
+    const std::vector<uint8_t>* plane_data[3] = {&planes.y, &planes.cb, &planes.cr};
+    const uint8_t* range[3] = {luma_range_, chroma_range_, chroma_range_};
+    int dc[3] = {0, 0, 0};
+    float block[64];
+
+    for (int by = 0; by < planes.height; by += 8) {
+        for (int bx = 0; bx < planes.width; bx += 8) {
+            for (int c = 0; c < 3; ++c) {
+                // Edge blocks replicate the last row/column
+                const uint8_t* pixels = plane_data[c]->data();
+                for (int y = 0; y < 8; ++y) {
+                    const uint8_t* row = pixels + static_cast<size_t>(std::min(by + y, planes.height - 1)) * planes.width;
+                    for (int x = 0; x < 8; ++x) {
+                        block[y * 8 + x] = static_cast<float>(range[c][row[std::min(bx + x, planes.width - 1)]]) - 128.0f;
+                    }
+                }
+                bool luma = c == 0;
+                dc[c] = EncodeBlock(writer, block, luma ? luma_divisors_ : chroma_divisors_, dc[c],
+                                    luma ? DcLumaTable() : DcChromaTable(),
+                                    luma ? AcLumaTable() : AcChromaTable());
+            }
+        }
+    }
+    writer.Flush();
+
+    WriteMarker(jpeg_, 0xD9);  // EOI
+}
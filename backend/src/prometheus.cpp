@@ -0,0 +1,69 @@
+#include "prometheus.h"
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+
+PrometheusWriter& PrometheusWriter::Family(std::string_view name, std::string_view type, std::string_view help) {
+    text_ += "# HELP ";
+    text_ += name;
+    text_ += ' ';
+    // HELP text escapes only backslash and newline
+    for (char c : help) {
+        if (c == '\\') text_ += "\\\\";
+        else if (c == '\n') text_ += "\\n";
+        else text_ += c;
+    }
+    text_ += "\n# TYPE ";
+    text_ += name;
+    text_ += ' ';
+    text_ += type;
+    text_ += '\n';
+    return *this;
+}
+
+PrometheusWriter& PrometheusWriter::Sample(std::string_view name, std::initializer_list<Label> labels, double value) {
+    AppendSeries(name, labels);
+    if (std::isnan(value)) {
+        text_ += "NaN";
+    } else if (std::isinf(value)) {
+        text_ += value > 0 ? "+Inf" : "-Inf";
+    } else {
+        char digits[32];
+        int length = std::snprintf(digits, sizeof(digits), "%.9g", value);
+        text_.append(digits, static_cast<size_t>(length));
+    }
+    text_ += '\n';
+    return *this;
+}
+
+PrometheusWriter& PrometheusWriter::SampleInt(std::string_view name, std::initializer_list<Label> labels, uint64_t value) {
+    AppendSeries(name, labels);
+    char digits[24];
+    auto result = std::to_chars(digits, digits + sizeof(digits), value);
+    text_.append(digits, static_cast<size_t>(result.ptr - digits));
+    text_ += '\n';
+    return *this;
+}
+
+void PrometheusWriter::AppendSeries(std::string_view name, std::initializer_list<Label> labels) {
+    text_ += name;
+    if (labels.size() > 0) {
+        text_ += '{';
+        bool first = true;
+        for (const auto& label : labels) {
+            if (!first) text_ += ',';
+            first = false;
+            text_ += label.first;
+            text_ += "=\"";
+            for (char c : label.second) {
+                if (c == '\\') text_ += "\\\\";
+                else if (c == '"') text_ += "\\\"";
+                else if (c == '\n') text_ += "\\n";
+                else text_ += c;
+            }
+            text_ += '"';
+        }
+        text_ += '}';
+    }
+    text_ += ' ';
+}
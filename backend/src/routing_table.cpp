@@ -0,0 +1,233 @@
+#include "routing_table.h"
+#include <algorithm>
+
+void SlotIndex::Set(int slot_number, int position) {
+    if (!IsValidSlot(slot_number)) {
+        return;
+    }
+    if (static_cast<size_t>(slot_number) >= positions_.size()) {
+        positions_.resize(slot_number + 1, kNone);
+    }
+    positions_[slot_number] = position;
+}
+
+void SlotIndex::Erase(int slot_number) {
+    if (slot_number > 0 && static_cast<size_t>(slot_number) < positions_.size()) {
+        positions_[slot_number] = kNone;
+    }
+}
+
+const RoutingSnapshot::SourceFanout* RoutingSnapshot::FindSource(uint32_t source_id, const std::string& source_name) const {
+    size_t chunk = source_id / kChunkSize;
+    if (source_id == kNoSource || chunk >= chunks.size() || !chunks[chunk]) {
+        return nullptr;
+    }
+    const SourceFanout* fanout = (*chunks[chunk])[source_id % kChunkSize].get();
+    return fanout && fanout->source_name == source_name ? fanout : nullptr;
+}
+
+void RoutingTableBuilder::Rebuild(
+    const std::vector<MatrixSourceSlot>& source_slots, const SlotIndex& source_slot_index,
+    const std::vector<MatrixDestination>& destinations, const SlotIndex& destination_index,
+    const std::vector<MatrixRoute>& routes) {
+    // Several slots may carry the same NDI source; they share one fan-out so the
+    // source is still captured once. Index fan-outs by source slot while building
+    // to avoid hashing the source name per route.
+    std::vector<std::shared_ptr<Fanout>> fanouts;
+    std::vector<int> fanout_by_slot;
+    std::unordered_map<std::string, size_t> fanout_by_name;
+
+    for (const auto& route : routes) {
+        if (!route.is_active) continue;
+
+        int src_pos = source_slot_index.Find(route.source_slot);
+        if (src_pos == SlotIndex::kNone) continue;
+        const MatrixSourceSlot& src_slot = source_slots[src_pos];
+        if (!src_slot.is_assigned) continue;
+
+        int dest_pos = destination_index.Find(route.destination_slot);
+        if (dest_pos == SlotIndex::kNone) continue;
+        const MatrixDestination& dest = destinations[dest_pos];
+        if (!dest.ndi_sender) continue;
+
+        if (static_cast<size_t>(route.source_slot) >= fanout_by_slot.size()) {
+            fanout_by_slot.resize(route.source_slot + 1, SlotIndex::kNone);
+        }
+        int& fanout_pos = fanout_by_slot[route.source_slot];
+        if (fanout_pos == SlotIndex::kNone) {
+            auto inserted = fanout_by_name.emplace(src_slot.assigned_ndi_source, fanouts.size());
+            if (inserted.second) {
+                fanouts.push_back(std::make_shared<Fanout>());
+                fanouts.back()->source_name = src_slot.assigned_ndi_source;
+            }
+            fanout_pos = static_cast<int>(inserted.first->second);
+        }
+
+        Fanout& fanout = *fanouts[fanout_pos];
+        fanout.senders.push_back(dest.ndi_sender);
+        fanout.destination_slots.push_back(dest.slot_number);
+        fanout.route_stats.push_back(route.stats);
+    }
+
+    // Every sender loses its route here and the new fan-outs give it back
+    ClearRoutedFlags();
+    for (const auto& fanout : fanouts) {
+        for (const auto& sender : fanout->senders) {
+            sender->routed.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // Keep the ids of sources that stay routed so running workers find them
+    for (auto it = source_ids_.begin(); it != source_ids_.end();) {
+        if (fanout_by_name.count(it->first) == 0) {
+            free_source_ids_.push_back(it->second);
+            it = source_ids_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    std::fill(chunk_shared_.begin(), chunk_shared_.end(), false);
+    for (auto& chunk : chunks_) {
+        chunk.reset();
+    }
+    source_count_ = 0;
+    for (auto& fanout : fanouts) {
+        uint32_t source_id = AcquireSourceId(fanout->source_name);
+        SetFanout(source_id, std::move(fanout));
+    }
+}
+
+void RoutingTableBuilder::AddRoute(const std::string& source_name, int destination_slot,
+                                   const NDISenderHandle& sender, const std::shared_ptr<RouteStats>& stats) {
+    if (!sender) {
+        return;
+    }
+    sender->routed.store(true, std::memory_order_relaxed);
+    uint32_t source_id = AcquireSourceId(source_name);
+    const Fanout* current = GetFanout(source_id);
+    auto fanout = current ? std::make_shared<Fanout>(*current) : std::make_shared<Fanout>();
+    fanout->source_name = source_name;
+    fanout->senders.push_back(sender);
+    fanout->destination_slots.push_back(destination_slot);
+    fanout->route_stats.push_back(stats);
+    SetFanout(source_id, std::move(fanout));
+}
+
+bool RoutingTableBuilder::RemoveRoute(const std::string& source_name, int destination_slot) {
+    auto id_it = source_ids_.find(source_name);
+    if (id_it == source_ids_.end()) {
+        return false;
+    }
+    uint32_t source_id = id_it->second;
+    const Fanout* current = GetFanout(source_id);
+    if (!current) {
+        return false;
+    }
+    auto slot_it = std::find(current->destination_slots.begin(), current->destination_slots.end(), destination_slot);
+    if (slot_it == current->destination_slots.end()) {
+        return false;
+    }
+    size_t position = static_cast<size_t>(slot_it - current->destination_slots.begin());
+    current->senders[position]->routed.store(false, std::memory_order_relaxed);
+    if (current->senders.size() == 1) {
+        SetFanout(source_id, nullptr);
+        ReleaseSourceId(source_name, source_id);
+        return true;
+    }
+
+    // Fan-out order is not significant, so swap-remove
+    auto fanout = std::make_shared<Fanout>(*current);
+    size_t last = fanout->senders.size() - 1;
+    fanout->senders[position] = std::move(fanout->senders[last]);
+    fanout->destination_slots[position] = fanout->destination_slots[last];
+    fanout->route_stats[position] = std::move(fanout->route_stats[last]);
+    fanout->senders.pop_back();
+    fanout->destination_slots.pop_back();
+    fanout->route_stats.pop_back();
+    SetFanout(source_id, std::move(fanout));
+    return true;
+}
+
+void RoutingTableBuilder::Clear() {
+    ClearRoutedFlags();
+    source_ids_.clear();
+    free_source_ids_.clear();
+    next_source_id_ = 0;
+    chunks_.clear();
+    chunk_shared_.clear();
+    source_count_ = 0;
+}
+
+std::shared_ptr<RoutingSnapshot> RoutingTableBuilder::Build() {
+    auto snapshot = std::make_shared<RoutingSnapshot>();
+    snapshot->source_count = source_count_;
+    snapshot->chunks.assign(chunks_.begin(), chunks_.end());
+    // The snapshot now shares every chunk; the next change to one copies it
+    std::fill(chunk_shared_.begin(), chunk_shared_.end(), true);
+    return snapshot;
+}
+
+void RoutingTableBuilder::ClearRoutedFlags() {
+    for (const auto& chunk : chunks_) {
+        if (!chunk) continue;
+        for (const auto& fanout : *chunk) {
+            if (!fanout) continue;
+            for (const auto& sender : fanout->senders) {
+                sender->routed.store(false, std::memory_order_relaxed);
+            }
+        }
+    }
+}
+
+uint32_t RoutingTableBuilder::AcquireSourceId(const std::string& source_name) {
+    auto it = source_ids_.find(source_name);
+    if (it != source_ids_.end()) {
+        return it->second;
+    }
+    uint32_t source_id;
+    if (!free_source_ids_.empty()) {
+        source_id = free_source_ids_.back();
+        free_source_ids_.pop_back();
+    } else {
+        source_id = next_source_id_++;
+    }
+    source_ids_.emplace(source_name, source_id);
+    return source_id;
+}
+
+void RoutingTableBuilder::ReleaseSourceId(const std::string& source_name, uint32_t source_id) {
+    source_ids_.erase(source_name);
+    free_source_ids_.push_back(source_id);
+}
+
+const RoutingTableBuilder::Fanout* RoutingTableBuilder::GetFanout(uint32_t source_id) const {
+    size_t chunk = source_id / RoutingSnapshot::kChunkSize;
+    if (chunk >= chunks_.size() || !chunks_[chunk]) {
+        return nullptr;
+    }
+    return (*chunks_[chunk])[source_id % RoutingSnapshot::kChunkSize].get();
+}
+
+void RoutingTableBuilder::SetFanout(uint32_t source_id, std::shared_ptr<const Fanout> fanout) {
+    auto& entry = MutableChunk(source_id / RoutingSnapshot::kChunkSize)[source_id % RoutingSnapshot::kChunkSize];
+    if (entry && !fanout) {
+        source_count_--;
+    } else if (!entry && fanout) {
+        source_count_++;
+    }
+    entry = std::move(fanout);
+}
+
+RoutingSnapshot::Chunk& RoutingTableBuilder::MutableChunk(size_t chunk) {
+    if (chunk >= chunks_.size()) {
+        chunks_.resize(chunk + 1);
+        chunk_shared_.resize(chunk + 1, false);
+    }
+    if (!chunks_[chunk]) {
+        chunks_[chunk] = std::make_shared<RoutingSnapshot::Chunk>();
+    } else if (chunk_shared_[chunk]) {
+        chunks_[chunk] = std::make_shared<RoutingSnapshot::Chunk>(*chunks_[chunk]);
+    }
+    chunk_shared_[chunk] = false;
+    return *chunks_[chunk];
+}
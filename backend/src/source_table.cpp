@@ -0,0 +1,126 @@
+#include "source_table.h"
+#include <algorithm>
+#include <cctype>
+
+const NDISource* SourceTableSnapshot::FindSource(const std::string& name) const {
+    auto it = source_positions.find(name);
+    return it != source_positions.end() ? &sources[it->second] : nullptr;
+}
+
+SourceTable::SourceTable() : snapshot_(std::make_shared<SourceTableSnapshot>()) {}
+
+bool SourceTable::IsStudioMonitorName(const std::string& name) {
+    static const std::string kNeedle = "studio monitor";
+    auto it = std::search(name.begin(), name.end(), kNeedle.begin(), kNeedle.end(), [](char a, char b) {
+        return std::tolower(static_cast<unsigned char>(a)) == b;
+    });
+    return it != name.end();
+}
+
+bool SourceTable::Update(const std::vector<NDISource>& announced, SourceTableChanges& changes) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    changes.added.clear();
+    changes.removed.clear();
+    ++update_count_;
+
+    bool order_changed = announced.size() != order_.size();
+    for (size_t i = 0; i < announced.size(); ++i) {
+        const NDISource& source = announced[i];
+        auto it = entries_.find(source.name);
+        if (it == entries_.end()) {
+            entries_.emplace(source.name, Entry{source.url, IsStudioMonitorName(source.name), update_count_});
+            changes.added.push_back(source);
+        } else {
+            if (it->second.url != source.url) {
+                it->second.url = source.url;
+                changes.added.push_back(source);
+            }
+            it->second.seen = update_count_;
+        }
+        if (!order_changed && order_[i] != source.name) {
+            order_changed = true;
+        }
+    }
+
+    for (auto it = entries_.begin(); it != entries_.end();) {
+        if (it->second.seen != update_count_) {
+            changes.removed.push_back(it->first);
+            it = entries_.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    if (changes.added.empty() && changes.removed.empty() && !order_changed) {
+        return false;
+    }
+
+    order_.clear();
+    for (const auto& source : announced) {
+        order_.push_back(source.name);
+    }
+    PublishLocked();
+    changes.snapshot = std::atomic_load(&snapshot_);
+    return true;
+}
+
+void SourceTable::SetOwnOutputs(const std::vector<std::string>& names) {
+    std::unordered_map<std::string, uint32_t> own_outputs;
+    for (const auto& name : names) {
+        own_outputs[name]++;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (own_outputs == own_outputs_) {
+        return;
+    }
+    own_outputs_.swap(own_outputs);
+    PublishLocked();
+}
+
+void SourceTable::AddOwnOutput(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    // Only the first output with a name can hide an announced source
+    if (own_outputs_[name]++ == 0 && entries_.count(name) != 0) {
+        PublishLocked();
+    }
+}
+
+void SourceTable::RemoveOwnOutput(const std::string& name) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = own_outputs_.find(name);
+    if (it == own_outputs_.end() || --it->second > 0) {
+        return;
+    }
+    own_outputs_.erase(it);
+    if (entries_.count(name) != 0) {
+        PublishLocked();
+    }
+}
+
+std::shared_ptr<const SourceTableSnapshot> SourceTable::Load() const {
+    return std::atomic_load(&snapshot_);
+}
+
+void SourceTable::PublishLocked() {
+    auto snapshot = std::make_shared<SourceTableSnapshot>();
+    snapshot->generation = ++generation_;
+    snapshot->sources.reserve(order_.size());
+    snapshot->source_positions.reserve(order_.size());
+
+    for (const auto& name : order_) {
+        const Entry& entry = entries_.at(name);
+        NDISource source;
+        source.name = name;
+        source.url = entry.url;
+        source.is_connected = true;
+        if (entry.is_studio_monitor) {
+            snapshot->studio_monitors.push_back(source);
+        }
+        if (own_outputs_.count(name) == 0 && snapshot->source_positions.count(name) == 0) {
+            snapshot->source_positions.emplace(name, static_cast<uint32_t>(snapshot->sources.size()));
+            snapshot->sources.push_back(std::move(source));
+        }
+    }
+
+    std::atomic_store(&snapshot_, std::shared_ptr<const SourceTableSnapshot>(std::move(snapshot)));
+}
@@ -1,25 +1,271 @@
 #include "web_server.h"
-#include <iostream>
-#include <sstream>
+#include "http_parser.h"
+#include "http_router.h"
+#include "json.h"
+#include "logger.h"
+#include "prometheus.h"
+#include <ctime>
+#include <algorithm>
+#include <cstring>
+#include <chrono>
+#include <set>
+#include <vector>
+
+#ifdef _WIN32
 #include <winsock2.h>
 #include <ws2tcpip.h>
-#include <ctime>
 
 #pragma comment(lib, "ws2_32.lib")
+#else
+#include <arpa/inet.h>
+#include <cerrno>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#include <unordered_map>
+#endif
+
+namespace {
+// Default number of I/O threads; each runs its own epoll loop (Linux)
+constexpr size_t kDefaultIoThreads = 4;
+// A connection buffering more unanswered input than this is dropped
+constexpr size_t kMaxBufferedInput = 2 * 1024 * 1024;
+// An event stream subscriber that falls this far behind is dropped; it reconnects and resyncs
+constexpr size_t kMaxEventBacklog = 1024 * 1024;
+// Comment sent to idle event streams so dead clients and proxies time out
+constexpr auto kEventKeepAlive = std::chrono::seconds(15);
+
+const char* kCorsHeaders =
+    "Access-Control-Allow-Origin: *\r\n"
+    "Access-Control-Allow-Methods: GET, POST, DELETE, OPTIONS\r\n"
+    "Access-Control-Allow-Headers: Content-Type, Authorization, If-None-Match\r\n"
+    "Access-Control-Expose-Headers: ETag\r\n";
+
+const char* StatusText(int status_code) {
+    switch (status_code) {
+        case 200: return "OK";
+        case 204: return "No Content";
+        case 304: return "Not Modified";
+        case 400: return "Bad Request";
+        case 404: return "Not Found";
+        case 405: return "Method Not Allowed";
+        case 413: return "Payload Too Large";
+        case 431: return "Request Header Fields Too Large";
+        case 501: return "Not Implemented";
+        default: return "Internal Server Error";
+    }
+}
+
+// Full response with CORS headers and an exact Content-Length, so the
+// connection can stay open for the next request. extra_headers must end in CRLF.
+std::string BuildResponse(int status_code, const char* content_type, const std::string& body,
+                          const std::string& extra_headers = std::string()) {
+    std::string response;
+    response.reserve(256 + body.size());
+    response += "HTTP/1.1 ";
+    response += std::to_string(status_code);
+    response += ' ';
+    response += StatusText(status_code);
+    response += "\r\n";
+    response += kCorsHeaders;
+    response += extra_headers;
+    if (content_type) {
+        response += "Content-Type: ";
+        response += content_type;
+        response += "\r\n";
+    }
+    if (status_code != 204 && status_code != 304) {
+        response += "Content-Length: ";
+        response += std::to_string(body.size());
+        response += "\r\n";
+    }
+    response += "\r\n";
+    response += body;
+    return response;
+}
+
+// Ask the client to close after this response
+void MarkConnectionClose(std::string& response) {
+    response.insert(response.find("\r\n") + 2, "Connection: close\r\n");
+}
+
+// Response head for GET /api/events; the stream has no length and stays open
+std::string BuildEventStreamHead() {
+    std::string head = "HTTP/1.1 200 OK\r\n";
+    head += kCorsHeaders;
+    head += "Content-Type: text/event-stream\r\n"
+            "Cache-Control: no-cache\r\n"
+            "X-Accel-Buffering: no\r\n"
+            "\r\n"
+            "retry: 2000\n\n";
+    return head;
+}
+
+// True if an If-None-Match header lists etag (or is "*")
+bool IfNoneMatch(std::string_view header, std::string_view etag) {
+    while (!header.empty()) {
+        size_t comma = header.find(',');
+        std::string_view candidate = header.substr(0, comma);
+        while (!candidate.empty() && candidate.front() == ' ') candidate.remove_prefix(1);
+        while (!candidate.empty() && candidate.back() == ' ') candidate.remove_suffix(1);
+        if (candidate.substr(0, 2) == "W/") candidate.remove_prefix(2);
+        if (candidate == etag || candidate == "*") return true;
+        if (comma == std::string_view::npos) break;
+        header.remove_prefix(comma + 1);
+    }
+    return false;
+}
+
+// Value of name in a query string, e.g. QueryParam("since=12&x=1", "since") == "12"
+std::string_view QueryParam(std::string_view query, std::string_view name) {
+    while (!query.empty()) {
+        size_t amp = query.find('&');
+        std::string_view pair = query.substr(0, amp);
+        size_t equals = pair.find('=');
+        if (pair.substr(0, equals) == name) {
+            return equals == std::string_view::npos ? std::string_view() : pair.substr(equals + 1);
+        }
+        if (amp == std::string_view::npos) break;
+        query.remove_prefix(amp + 1);
+    }
+    return {};
+}
+
+// Per-thread writer for response bodies. Its buffer keeps its capacity
+// between requests; finish one body before starting the next on a thread.
+JsonWriter& ResponseWriter() {
+    thread_local JsonWriter writer(4096);
+    writer.Clear();
+    return writer;
+}
+
+// Shared by the list endpoints, the state snapshot and the change feed
+void WriteJson(JsonWriter& json, const MatrixSourceSlot& slot) {
+    json.BeginObject()
+        .Key("slotNumber").Int(slot.slot_number)
+        .Key("assignedNdiSource").String(slot.assigned_ndi_source)
+        .Key("displayName").String(slot.display_name)
+        .Key("isAssigned").Bool(slot.is_assigned)
+        .EndObject();
+}
+
+void WriteJson(JsonWriter& json, const MatrixDestination& destination) {
+    json.BeginObject()
+        .Key("slotNumber").Int(destination.slot_number)
+        .Key("name").String(destination.name)
+        .Key("description").String(destination.description)
+        .Key("enabled").Bool(destination.is_enabled)
+        .Key("currentSourceSlot").Int(destination.current_source_slot)
+        .Key("frameSync").Bool(destination.output_clock.enabled);
+    if (destination.output_clock.enabled) {
+        json.Key("frameRateN").Int(destination.output_clock.frame_rate_N)
+            .Key("frameRateD").Int(destination.output_clock.frame_rate_D)
+            .Key("audioSampleRate").Int(destination.output_clock.audio_sample_rate);
+    }
+    json.EndObject();
+}
+
+void WriteJson(JsonWriter& json, const MatrixRoute& route) {
+    json.BeginObject()
+        .Key("id").String(route.id)
+        .Key("sourceSlot").Int(route.source_slot)
+        .Key("destinationSlot").Int(route.destination_slot)
+        .Key("active").Bool(route.is_active)
+        .EndObject();
+}
+
+void WriteJson(JsonWriter& json, const NDISource& source) {
+    json.BeginObject()
+        .Key("name").String(source.name)
+        .Key("url").String(source.url)
+        .Key("connected").Bool(source.is_connected)
+        .EndObject();
+}
+
+void WriteJson(JsonWriter& json, int value) {
+    json.Int(value);
+}
+
+void WriteJson(JsonWriter& json, const LatencyHistogram::Summary& latency) {
+    json.BeginObject()
+        .Key("count").UInt(latency.count)
+        .Key("meanMs").Double(latency.mean_ms)
+        .Key("p50Ms").Double(latency.p50_ms)
+        .Key("p99Ms").Double(latency.p99_ms)
+        .Key("p999Ms").Double(latency.p999_ms)
+        .Key("maxMs").Double(latency.max_ms)
+        .EndObject();
+}
+
+// Quantile, _sum and _count samples of a Prometheus summary for one route
+void WriteRouteLatency(PrometheusWriter& metrics, const std::string& name, const std::string& source_slot,
+                       const std::string& destination_slot, const LatencyHistogram::Summary& latency) {
+    const std::pair<const char*, double> quantiles[] = {
+        {"0.5", latency.p50_ms}, {"0.99", latency.p99_ms}, {"0.999", latency.p999_ms}};
+    for (const auto& quantile : quantiles) {
+        metrics.Sample(name, {{"source_slot", source_slot}, {"destination_slot", destination_slot}, {"quantile", quantile.first}},
+                       quantile.second / 1000.0);
+    }
+    metrics.Sample(name + "_sum", {{"source_slot", source_slot}, {"destination_slot", destination_slot}}, latency.sum_ms / 1000.0);
+    metrics.SampleInt(name + "_count", {{"source_slot", source_slot}, {"destination_slot", destination_slot}}, latency.count);
+}
+
+template <typename T>
+void WriteJsonArray(JsonWriter& json, const std::vector<T>& items) {
+    json.BeginArray();
+    for (const auto& item : items) {
+        WriteJson(json, item);
+    }
+    json.EndArray();
+}
+
+// {"success":true,"message":...}
+std::string SuccessMessage(std::string_view message) {
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("success").Bool(true).Key("message").String(message).EndObject();
+    return json.str();
+}
+
+std::string ErrorMessage(std::string_view error) {
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("error").String(error).EndObject();
+    return json.str();
+}
+
+bool IsEventStreamRequest(const HttpRequest& request) {
+    return request.method == "GET" && request.path == "/api/events";
+}
+}
 
 WebServer::WebServer(int port, std::shared_ptr<NDIManager> ndi_manager)
-    : port_(port), is_running_(false), ndi_manager_(ndi_manager) {
+    : port_(port), is_running_(false), ndi_manager_(ndi_manager), io_thread_count_(kDefaultIoThreads),
+      event_subscribers_(0) {
+    // Versions restart at zero with the process; the prefix keeps old ETags from matching
+    auto boot_time = std::chrono::system_clock::now().time_since_epoch();
+    etag_prefix_ = std::to_string(std::chrono::duration_cast<std::chrono::milliseconds>(boot_time).count()) + "-";
+    RegisterRoutes();
+    ndi_manager_->SetStateChangeCallback([this](uint32_t changes) { QueueStateEvents(changes); });
     // auth_manager_ = std::make_unique<AuthManager>();  // Temporarily disabled for build
 }
 
 WebServer::~WebServer() {
+    ndi_manager_->SetStateChangeCallback(nullptr);
     Stop();
 }
 
+void WebServer::SetIoThreadCount(size_t thread_count) {
+    io_thread_count_ = std::max<size_t>(1, thread_count);
+}
+
+#ifdef _WIN32
 bool WebServer::Start() {
     WSADATA wsaData;
     if (WSAStartup(MAKEWORD(2, 2), &wsaData) != 0) {
-        std::cerr << "WSAStartup failed" << std::endl;
+        LOG_ERROR("WSAStartup failed");
         return false;
     }
 
@@ -46,7 +292,7 @@ void WebServer::Stop() {
 void WebServer::ServerThreadFunction() {
     SOCKET listen_socket = socket(AF_INET, SOCK_STREAM, IPPROTO_TCP);
     if (listen_socket == INVALID_SOCKET) {
-        std::cerr << "Failed to create socket" << std::endl;
+        LOG_ERROR("Failed to create socket");
         return;
     }
 
@@ -56,13 +302,13 @@ void WebServer::ServerThreadFunction() {
     server_addr.sin_port = htons(port_);
 
     if (bind(listen_socket, (sockaddr*)&server_addr, sizeof(server_addr)) == SOCKET_ERROR) {
-        std::cerr << "Bind failed" << std::endl;
+        LOG_ERROR("Bind failed");
         closesocket(listen_socket);
         return;
     }
 
     if (listen(listen_socket, SOMAXCONN) == SOCKET_ERROR) {
-        std::cerr << "Listen failed" << std::endl;
+        LOG_ERROR("Listen failed");
         closesocket(listen_socket);
         return;
     }
@@ -79,610 +325,1310 @@ void WebServer::ServerThreadFunction() {
 }
 
 void WebServer::HandleRequest(int client_socket) {
+    // One request per connection here; keep-alive is served by the Linux backend
+    std::string input;
+    HttpRequestParser parser;
+    HttpRequest request;
     char buffer[4096];
-    int bytes_received = recv(client_socket, buffer, sizeof(buffer) - 1, 0);
-    
-    if (bytes_received > 0) {
-        buffer[bytes_received] = '\0';
-        std::string request(buffer);
-        
-        std::string response;
-        std::string cors_headers = "Access-Control-Allow-Origin: *\r\nAccess-Control-Allow-Methods: GET, POST, DELETE, OPTIONS\r\nAccess-Control-Allow-Headers: Content-Type, Authorization\r\n";
-        
-        if (request.find("OPTIONS") == 0) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "\r\n";
-        } else if (request.find("GET /api/health") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n{\"status\":\"ok\",\"timestamp\":" + std::to_string(std::time(nullptr)) + "}";
-        } else if (request.find("GET /api/sources") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetSources();
-        } else if (request.find("GET /api/studio-monitors") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetStudioMonitors();
-        } else if (request.find("POST /api/studio-monitors/reset") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleResetStudioMonitors();
-        } else if (request.find("GET /api/matrix/source-slots") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetMatrixSourceSlots();
-        } else if (request.find("GET /api/matrix/destinations") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetMatrixDestinations();
-        } else if (request.find("GET /api/matrix/routes") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetMatrixRoutes();
-        } else if (request.find("POST /api/matrix/source-slots/assign") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleAssignSourceToSlot(body);
-        } else if (request.find("DELETE /api/matrix/source-slots/") != std::string::npos) {
-            try {
-                
-                // Extract slot number from URL
-                size_t slot_pos = request.find("/api/matrix/source-slots/");
-                if (slot_pos != std::string::npos) {
-                    slot_pos += 25; // length of "/api/matrix/source-slots/"
-                    // Find the end of the URL path (space before HTTP, newline, or end of path)
-                    size_t space_pos = request.find(" ", slot_pos);
-                    size_t newline_pos = request.find("\r", slot_pos);
-                    
-                    // Use the earliest valid terminator
-                    size_t end_pos = std::string::npos;
-                    
-                    if (space_pos != std::string::npos) {
-                        end_pos = space_pos;
+
+    while (true) {
+        int bytes_received = recv(client_socket, buffer, sizeof(buffer), 0);
+        if (bytes_received <= 0) {
+            return;
+        }
+        input.append(buffer, bytes_received);
+
+        HttpRequestParser::Result result = parser.Parse(input.data(), input.size(), request);
+        if (result == HttpRequestParser::Result::Incomplete) {
+            continue;
+        }
+
+        std::string response = result == HttpRequestParser::Result::Complete
+            ? ProcessRequest(request)
+            : CreateErrorResponse(parser.error(), parser.error_status());
+        MarkConnectionClose(response);
+        send(client_socket, response.c_str(), static_cast<int>(response.length()), 0);
+        return;
+    }
+}
+#else
+bool WebServer::Start() {
+    listen_fd_ = socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listen_fd_ < 0) {
+        LOG_ERROR("Failed to create socket");
+        return false;
+    }
+
+    int reuse = 1;
+    setsockopt(listen_fd_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+    sockaddr_in server_addr = {};
+    server_addr.sin_family = AF_INET;
+    server_addr.sin_addr.s_addr = INADDR_ANY;
+    server_addr.sin_port = htons(port_);
+
+    if (bind(listen_fd_, (sockaddr*)&server_addr, sizeof(server_addr)) < 0) {
+        LOG_ERROR("Bind failed: " << std::strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    if (listen(listen_fd_, SOMAXCONN) < 0) {
+        LOG_ERROR("Listen failed: " << std::strerror(errno));
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    // Stop() signals this to wake every I/O thread
+    wake_fd_ = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (wake_fd_ < 0) {
+        LOG_ERROR("Failed to create eventfd");
+        close(listen_fd_);
+        listen_fd_ = -1;
+        return false;
+    }
+
+    is_running_ = true;
+    event_thread_ = std::make_unique<std::thread>(&WebServer::EventThreadFunction, this);
+    for (size_t i = 0; i < io_thread_count_; ++i) {
+        io_threads_.push_back(std::make_unique<std::thread>(&WebServer::IoThreadFunction, this));
+    }
+    LOG_INFO("HTTP server using " << io_thread_count_ << " I/O threads");
+    return true;
+}
+
+void WebServer::Stop() {
+    if (!is_running_.exchange(false)) {
+        return;
+    }
+
+    uint64_t one = 1;
+    if (write(wake_fd_, &one, sizeof(one)) < 0) {
+        LOG_ERROR("Failed to wake I/O threads");
+    }
+    for (auto& thread : io_threads_) {
+        if (thread->joinable()) {
+            thread->join();
+        }
+    }
+    io_threads_.clear();
+
+    {
+        std::lock_guard<std::mutex> lock(event_mutex_);
+        event_wakeup_.notify_all();
+    }
+    if (event_thread_ && event_thread_->joinable()) {
+        event_thread_->join();
+    }
+    event_thread_.reset();
+
+    close(listen_fd_);
+    close(wake_fd_);
+    listen_fd_ = -1;
+    wake_fd_ = -1;
+}
+
+void WebServer::IoThreadFunction() {
+    // Each I/O thread has its own epoll set. The listening socket is shared with
+    // EPOLLEXCLUSIVE so one thread takes each new connection and then owns it.
+    int epoll_fd = epoll_create1(EPOLL_CLOEXEC);
+    if (epoll_fd < 0) {
+        LOG_ERROR("Failed to create epoll instance");
+        return;
+    }
+
+    epoll_event listen_event = {};
+    listen_event.events = EPOLLIN | EPOLLEXCLUSIVE;
+    listen_event.data.fd = listen_fd_;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, listen_fd_, &listen_event);
+
+    epoll_event wake_event = {};
+    wake_event.events = EPOLLIN;
+    wake_event.data.fd = wake_fd_;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, wake_fd_, &wake_event);
+
+    // Signalled by the broadcaster whenever a new event is published
+    int events_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    epoll_event events_event = {};
+    events_event.events = EPOLLIN;
+    events_event.data.fd = events_fd;
+    epoll_ctl(epoll_fd, EPOLL_CTL_ADD, events_fd, &events_event);
+    int listener_id = events_.AddListener([events_fd] {
+        uint64_t one = 1;
+        if (write(events_fd, &one, sizeof(one)) < 0) {
+            LOG_ERROR("Failed to signal event stream thread");
+        }
+    });
+
+    struct Connection {
+        std::string input;
+        size_t input_offset = 0;      // Start of the request being parsed
+        HttpRequestParser parser;
+        std::string output;
+        size_t output_offset = 0;
+        bool close_after_output = false;
+        bool peer_closed = false;
+        bool event_stream = false;     // Switched to GET /api/events; only receives events
+        uint64_t event_sequence = 0;   // Last broadcaster frame queued for this subscriber
+    };
+    std::unordered_map<int, Connection> connections;
+    HttpRequest request;
+
+    auto close_connection = [&](int fd) {
+        auto it = connections.find(fd);
+        if (it != connections.end() && it->second.event_stream) {
+            event_subscribers_--;
+        }
+        epoll_ctl(epoll_fd, EPOLL_CTL_DEL, fd, nullptr);
+        close(fd);
+        connections.erase(fd);
+    };
+
+    // Returns false if the socket failed
+    auto flush_output = [&](int fd, Connection& connection) {
+        while (connection.output_offset < connection.output.size()) {
+            ssize_t sent = send(fd, connection.output.data() + connection.output_offset,
+                                connection.output.size() - connection.output_offset, MSG_NOSIGNAL);
+            if (sent < 0) {
+                return errno == EAGAIN || errno == EWOULDBLOCK;
+            }
+            connection.output_offset += static_cast<size_t>(sent);
+        }
+        connection.output.clear();
+        connection.output_offset = 0;
+        return true;
+    };
+
+    // Answer every complete (possibly pipelined) request in the buffer, in order
+    auto process_input = [&](Connection& connection) {
+        while (!connection.close_after_output && !connection.event_stream) {
+            const char* data = connection.input.data() + connection.input_offset;
+            size_t size = connection.input.size() - connection.input_offset;
+            HttpRequestParser::Result result = connection.parser.Parse(data, size, request);
+            if (result == HttpRequestParser::Result::Incomplete) {
+                break;
+            }
+
+            std::string response;
+            if (result == HttpRequestParser::Result::Complete && IsEventStreamRequest(request)) {
+                // Subscribers start from the next event and fetch current state themselves
+                response = BuildEventStreamHead();
+                connection.event_stream = true;
+                connection.event_sequence = events_.LatestSequence();
+                if (event_subscribers_++ == 0) {
+                    QueueStateEvents(kSourcesChanged);   // Re-baseline the source list for added/removed
+                }
+                connection.input_offset += connection.parser.consumed();
+            } else if (result == HttpRequestParser::Result::Complete) {
+                try {
+                    response = ProcessRequest(request);
+                } catch (const std::exception& e) {
+                    LOG_ERROR("Request handler failed: " << e.what());
+                    response = CreateErrorResponse("Internal server error", 500);
+                }
+                connection.input_offset += connection.parser.consumed();
+                connection.close_after_output = !request.keep_alive;
+            } else {
+                response = CreateErrorResponse(connection.parser.error(), connection.parser.error_status());
+                connection.close_after_output = true;
+            }
+            if (connection.close_after_output) {
+                MarkConnectionClose(response);
+            }
+            connection.output += response;
+            connection.parser.Reset();
+        }
+
+        // Drop consumed requests; the request views are dead past this point.
+        // Event streams ignore anything the client sends after subscribing.
+        if (connection.event_stream) {
+            connection.input.clear();
+            connection.input_offset = 0;
+        } else if (connection.input_offset > 0) {
+            connection.input.erase(0, connection.input_offset);
+            connection.input_offset = 0;
+        }
+    };
+
+    std::vector<epoll_event> events(64);
+    char buffer[16384];
+
+    while (is_running_) {
+        int ready = epoll_wait(epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+        if (ready < 0) {
+            if (errno == EINTR) continue;
+            LOG_ERROR("epoll_wait failed: " << std::strerror(errno));
+            break;
+        }
+
+        for (int i = 0; i < ready; ++i) {
+            int fd = events[i].data.fd;
+
+            if (fd == wake_fd_) {
+                continue;  // Level-triggered and never drained, so it wakes every thread
+            }
+
+            if (fd == events_fd) {
+                uint64_t count;
+                while (read(events_fd, &count, sizeof(count)) > 0) {
+                }
+                std::vector<int> lagging;
+                for (auto& pair : connections) {
+                    Connection& connection = pair.second;
+                    if (!connection.event_stream) continue;
+                    bool complete = events_.AppendSince(connection.event_sequence, connection.output);
+                    if (!complete || !flush_output(pair.first, connection) ||
+                        connection.output.size() > kMaxEventBacklog) {
+                        lagging.push_back(pair.first);
                     }
-                    if (newline_pos != std::string::npos && (end_pos == std::string::npos || newline_pos < end_pos)) {
-                        end_pos = newline_pos;
+                }
+                for (int lagging_fd : lagging) {
+                    close_connection(lagging_fd);
+                }
+                continue;
+            }
+
+            if (fd == listen_fd_) {
+                while (true) {
+                    int client_fd = accept4(listen_fd_, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+                    if (client_fd < 0) {
+                        break;
                     }
-                    
-                    if (end_pos != std::string::npos && end_pos > slot_pos) {
-                        std::string slot_str = request.substr(slot_pos, end_pos - slot_pos);
-                        
-                        if (!slot_str.empty()) {
-                            int slot_num = std::stoi(slot_str);
-                            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleUnassignSourceSlot(slot_num);
-                        } else {
-                            response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nEmpty slot number";
-                        }
-                    } else {
-                        response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid slot number format";
+                    int no_delay = 1;
+                    setsockopt(client_fd, IPPROTO_TCP, TCP_NODELAY, &no_delay, sizeof(no_delay));
+
+                    epoll_event client_event = {};
+                    client_event.events = EPOLLIN | EPOLLOUT | EPOLLRDHUP | EPOLLET;
+                    client_event.data.fd = client_fd;
+                    if (epoll_ctl(epoll_fd, EPOLL_CTL_ADD, client_fd, &client_event) < 0) {
+                        close(client_fd);
+                        continue;
                     }
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request";
+                    connections[client_fd];
                 }
-            } catch (const std::exception& e) {
-                response = "HTTP/1.1 500 Internal Server Error\r\n" + cors_headers + "\r\nParsing error";
-            } catch (...) {
-                response = "HTTP/1.1 500 Internal Server Error\r\n" + cors_headers + "\r\nUnknown parsing error";
+                continue;
             }
-        } else if (request.find("POST /api/matrix/destinations/") != std::string::npos && request.find("/unassign") != std::string::npos) {
-            // Extract destination slot from URL like /api/matrix/destinations/1/unassign
-            size_t dest_pos = request.find("/api/matrix/destinations/");
-            if (dest_pos != std::string::npos) {
-                dest_pos += 25; // length of "/api/matrix/destinations/"
-                size_t unassign_pos = request.find("/unassign", dest_pos);
-                if (unassign_pos != std::string::npos) {
-                    int dest_slot = std::stoi(request.substr(dest_pos, unassign_pos - dest_pos));
-                    response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleUnassignDestination(dest_slot);
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid destination slot";
-                }
-            } else {
-                response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request";
+
+            auto it = connections.find(fd);
+            if (it == connections.end()) {
+                continue;
             }
-        } else if (request.find("POST /api/matrix/destinations") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleCreateMatrixDestination(body);
-        } else if (request.find("DELETE /api/matrix/destinations/") != std::string::npos) {
-            // Extract destination slot from URL
-            size_t dest_pos = request.find("/api/matrix/destinations/");
-            if (dest_pos != std::string::npos) {
-                dest_pos += 25; // length of "/api/matrix/destinations/"
-                size_t space_pos = request.find(" ", dest_pos);
-                if (space_pos != std::string::npos) {
-                    int dest_slot = std::stoi(request.substr(dest_pos, space_pos - dest_pos));
-                    response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleRemoveMatrixDestination(dest_slot);
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid destination slot";
+            Connection& connection = it->second;
+
+            // Edge-triggered: read everything that is available
+            while (!connection.peer_closed) {
+                ssize_t received = recv(fd, buffer, sizeof(buffer), 0);
+                if (received > 0) {
+                    connection.input.append(buffer, static_cast<size_t>(received));
+                    continue;
                 }
-            } else {
-                response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request";
-            }
-        } else if (request.find("POST /api/matrix/routes/multiple") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleCreateMultipleRoutes(body);
-        } else if (request.find("POST /api/matrix/routes") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleCreateMatrixRoute(body);
-        } else if (request.find("DELETE /api/matrix/routes/source/") != std::string::npos) {
-            // Extract source slot number from URL
-            size_t slot_pos = request.find("/api/matrix/routes/source/");
-            if (slot_pos != std::string::npos) {
-                slot_pos += 26; // length of "/api/matrix/routes/source/"
-                size_t space_pos = request.find(" ", slot_pos);
-                if (space_pos != std::string::npos) {
-                    std::string slot_str = request.substr(slot_pos, space_pos - slot_pos);
-                    int source_slot = std::stoi(slot_str);
-                    response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleRemoveAllRoutesFromSource(source_slot);
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request format";
+                if (received == 0 || (errno != EAGAIN && errno != EWOULDBLOCK)) {
+                    connection.peer_closed = true;
                 }
-            } else {
-                response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request format";
+                break;
             }
-        } else if (request.find("GET /api/matrix/routes/source/") != std::string::npos) {
-            // Extract source slot number from URL for getting destinations
-            size_t slot_pos = request.find("/api/matrix/routes/source/");
-            if (slot_pos != std::string::npos) {
-                slot_pos += 26; // length of "/api/matrix/routes/source/"
-                size_t space_pos = request.find(" ", slot_pos);
-                if (space_pos != std::string::npos) {
-                    std::string slot_str = request.substr(slot_pos, space_pos - slot_pos);
-                    int source_slot = std::stoi(slot_str);
-                    response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetDestinationsForSource(source_slot);
-                } else {
-                    response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request format";
+
+            process_input(connection);
+
+            if (!flush_output(fd, connection)) {
+                close_connection(fd);
+                continue;
+            }
+            bool output_done = connection.output.empty();
+            if (output_done && (connection.close_after_output || connection.peer_closed)) {
+                close_connection(fd);
+            } else if (connection.input.size() > kMaxBufferedInput) {
+                close_connection(fd);
+            }
+        }
+    }
+
+    events_.RemoveListener(listener_id);
+    for (auto& pair : connections) {
+        if (pair.second.event_stream) {
+            event_subscribers_--;
+        }
+        close(pair.first);
+    }
+    close(events_fd);
+    close(epoll_fd);
+}
+#endif
+
+void WebServer::QueueStateEvents(uint32_t changes) {
+    {
+        std::lock_guard<std::mutex> lock(event_mutex_);
+        pending_changes_ |= changes;
+    }
+    event_wakeup_.notify_one();
+}
+
+void WebServer::EventThreadFunction() {
+    // Bursts of changes (e.g. a multi-route take) coalesce into one event per kind
+    std::set<std::string> known_sources;
+    auto next_keep_alive = std::chrono::steady_clock::now() + kEventKeepAlive;
+
+    while (is_running_) {
+        uint32_t changes = 0;
+        {
+            std::unique_lock<std::mutex> lock(event_mutex_);
+            event_wakeup_.wait_until(lock, next_keep_alive, [this] { return !is_running_ || pending_changes_ != 0; });
+            if (!is_running_) {
+                break;
+            }
+            changes = pending_changes_;
+            pending_changes_ = 0;
+        }
+
+        auto now = std::chrono::steady_clock::now();
+        if (event_subscribers_ == 0) {
+            // New subscribers fetch full state on connect, so nothing is lost
+            next_keep_alive = now + kEventKeepAlive;
+            continue;
+        }
+
+        // The discovery thread reports source changes; diff against what subscribers last saw
+        if (changes & kSourcesChanged) {
+            auto table = ndi_manager_->GetSourceTable();
+            std::set<std::string> current;
+            for (const auto& source : table->sources) {
+                current.insert(source.name);
+            }
+            if (current != known_sources) {
+                JsonWriter& json = ResponseWriter();
+                json.BeginObject().Key("sources");
+                WriteJsonArray(json, table->sources);
+                json.Key("added").BeginArray();
+                for (const auto& name : current) {
+                    if (!known_sources.count(name)) json.String(name);
                 }
-            } else {
-                response = "HTTP/1.1 400 Bad Request\r\n" + cors_headers + "\r\nInvalid request format";
+                json.EndArray().Key("removed").BeginArray();
+                for (const auto& name : known_sources) {
+                    if (!current.count(name)) json.String(name);
+                }
+                json.EndArray().EndObject();
+                known_sources.swap(current);
+                events_.Publish("sources", json.str());
             }
-        } else if (request.find("DELETE /api/matrix/routes") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleRemoveMatrixRoute(body);
-        } else if (request.find("POST /api/studio-monitors/set-source") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleSetStudioMonitorSource(body);
-        } else if (request.find("GET /api/studio-monitors/current-source") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetStudioMonitorSource();
-        } else if (request.find("POST /api/preview/set-source") != std::string::npos) {
-            size_t body_pos = request.find("\r\n\r\n");
-            std::string body = (body_pos != std::string::npos) ? request.substr(body_pos + 4) : "";
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleSetPreviewSource(body);
-        } else if (request.find("GET /api/preview/current-source") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetPreviewSource();
-        } else if (request.find("GET /api/preview/image") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleGetPreviewImage();
-        } else if (request.find("POST /api/preview/clear") != std::string::npos) {
-            response = "HTTP/1.1 200 OK\r\n" + cors_headers + "Content-Type: application/json\r\n\r\n" + HandleClearPreview();
-        } else {
-            response = "HTTP/1.1 404 Not Found\r\n" + cors_headers + "\r\nEndpoint not found";
         }
-        
-        send(client_socket, response.c_str(), response.length(), 0);
+
+        if (changes & kSourceSlotsChanged) {
+            events_.Publish("source-slots", HandleGetMatrixSourceSlots());
+        }
+        if (changes & kDestinationsChanged) {
+            events_.Publish("destinations", HandleGetMatrixDestinations());
+        }
+        if (changes & kRoutesChanged) {
+            events_.Publish("routes", HandleGetMatrixRoutes());
+        }
+        if (changes & kStudioMonitorChanged) {
+            events_.Publish("studio-monitor", HandleGetStudioMonitorSource());
+        }
+        if (changes & kPreviewChanged) {
+            events_.Publish("preview", HandleGetPreviewSource());
+        }
+
+        if (changes != 0) {
+            next_keep_alive = now + kEventKeepAlive;
+        } else if (now >= next_keep_alive) {
+            events_.PublishComment("keep-alive");
+            next_keep_alive = now + kEventKeepAlive;
+        }
     }
 }
 
-std::string WebServer::HandleGetSources() {
-    std::cout << "Handling GET /api/sources request" << std::endl;
-    auto sources = ndi_manager_->DiscoverSources();
-    std::cout << "Found " << sources.size() << " NDI sources" << std::endl;
-    
-    std::ostringstream json;
-    json << "[";
-    
-    for (size_t i = 0; i < sources.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{\"name\":\"" << sources[i].name << "\",\"url\":\"" << sources[i].url 
-             << "\",\"connected\":" << (sources[i].is_connected ? "true" : "false") << "}";
+void WebServer::RegisterRoutes() {
+    // Handlers receive the parsed request and integer path parameters, and
+    // return the full response. Registration order does not affect matching.
+
+    router_.Add("GET", "/api/health", [this](const HttpRequest&, const RouteParams&) {
+        JsonWriter& json = ResponseWriter();
+        json.BeginObject().Key("status").String("ok").Key("timestamp").Int(std::time(nullptr)).EndObject();
+        return CreateJSONResponse(json.str());
+    });
+    router_.Add("GET", "/api/sources", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetSources());
+    });
+
+    // Studio monitors
+    router_.Add("GET", "/api/studio-monitors", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetStudioMonitors());
+    });
+    router_.Add("POST", "/api/studio-monitors/reset", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleResetStudioMonitors());
+    });
+    router_.Add("POST", "/api/studio-monitors/set-source", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleSetStudioMonitorSource(request.body));
+    });
+    router_.Add("GET", "/api/studio-monitors/current-source", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetStudioMonitorSource());
+    });
+
+    // Whole-matrix snapshot and the delta feed behind it
+    router_.Add("GET", "/api/matrix/state", [this](const HttpRequest& request, const RouteParams&) {
+        return ServeVersioned(request, state_response_, &WebServer::HandleGetMatrixState);
+    });
+    router_.Add("GET", "/api/matrix/changes", [this](const HttpRequest& request, const RouteParams&) {
+        std::string_view since = QueryParam(request.query, "since");
+        if (since.empty() || since.size() > 19 ||
+            since.find_first_not_of("0123456789") != std::string_view::npos) {
+            return CreateErrorResponse("Missing or invalid since version", 400);
+        }
+        return CreateJSONResponse(HandleGetMatrixChanges(std::stoull(std::string(since))));
+    });
+
+    // Matrix size
+    router_.Add("GET", "/api/matrix/size", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetMatrixSize());
+    });
+    router_.Add("POST", "/api/matrix/size", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleSetMatrixSize(request.body));
+    });
+
+    // Matrix source slots
+    router_.Add("GET", "/api/matrix/source-slots", [this](const HttpRequest& request, const RouteParams&) {
+        return ServeVersioned(request, source_slots_response_, &WebServer::HandleGetMatrixSourceSlots);
+    });
+    router_.Add("POST", "/api/matrix/source-slots/assign", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleAssignSourceToSlot(request.body));
+    });
+    router_.Add("DELETE", "/api/matrix/source-slots/{slot}", [this](const HttpRequest&, const RouteParams& params) {
+        return CreateJSONResponse(HandleUnassignSourceSlot(params.Get("slot")));
+    });
+
+    // Matrix destinations
+    router_.Add("GET", "/api/matrix/destinations", [this](const HttpRequest& request, const RouteParams&) {
+        return ServeVersioned(request, destinations_response_, &WebServer::HandleGetMatrixDestinations);
+    });
+    router_.Add("POST", "/api/matrix/destinations", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleCreateMatrixDestination(request.body));
+    });
+    router_.Add("DELETE", "/api/matrix/destinations/{slot}", [this](const HttpRequest&, const RouteParams& params) {
+        return CreateJSONResponse(HandleRemoveMatrixDestination(params.Get("slot")));
+    });
+    router_.Add("POST", "/api/matrix/destinations/{slot}/unassign", [this](const HttpRequest&, const RouteParams& params) {
+        return CreateJSONResponse(HandleUnassignDestination(params.Get("slot")));
+    });
+
+    // Matrix routes
+    router_.Add("GET", "/api/matrix/routes", [this](const HttpRequest& request, const RouteParams&) {
+        return ServeVersioned(request, routes_response_, &WebServer::HandleGetMatrixRoutes);
+    });
+    router_.Add("POST", "/api/matrix/routes", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleCreateMatrixRoute(request.body));
+    });
+    router_.Add("DELETE", "/api/matrix/routes", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleRemoveMatrixRoute(request.body));
+    });
+    router_.Add("POST", "/api/matrix/salvo", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleApplySalvo(request.body));
+    });
+    router_.Add("POST", "/api/matrix/routes/multiple", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleCreateMultipleRoutes(request.body));
+    });
+    router_.Add("GET", "/api/matrix/routes/source/{slot}", [this](const HttpRequest&, const RouteParams& params) {
+        return CreateJSONResponse(HandleGetDestinationsForSource(params.Get("slot")));
+    });
+    router_.Add("DELETE", "/api/matrix/routes/source/{slot}", [this](const HttpRequest&, const RouteParams& params) {
+        return CreateJSONResponse(HandleRemoveAllRoutesFromSource(params.Get("slot")));
+    });
+
+    // Preview
+    router_.Add("POST", "/api/preview/set-source", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleSetPreviewSource(request.body));
+    });
+    router_.Add("GET", "/api/preview/current-source", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetPreviewSource());
+    });
+    router_.Add("GET", "/api/preview/image", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetPreviewImage());
+    });
+    router_.Add("POST", "/api/preview/clear", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleClearPreview());
+    });
+
+    // Routing diagnostics
+    router_.Add("GET", "/api/routing/receive-mode", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetReceiveMode());
+    });
+    router_.Add("POST", "/api/routing/receive-mode", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleSetReceiveMode(request.body));
+    });
+    router_.Add("GET", "/api/routing/workers", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetRoutingWorkers());
+    });
+    router_.Add("GET", "/api/routing/latency", [this](const HttpRequest&, const RouteParams&) {
+        return CreateJSONResponse(HandleGetRouteLatency());
+    });
+    router_.Add("POST", "/api/routing/latency/reset", [this](const HttpRequest& request, const RouteParams&) {
+        return CreateJSONResponse(HandleResetRouteLatency(request.body));
+    });
+    router_.Add("GET", "/api/metrics", [this](const HttpRequest&, const RouteParams&) {
+        return BuildResponse(200, "text/plain; version=0.0.4; charset=utf-8", HandleGetMetrics(),
+                             "Cache-Control: no-cache\r\n");
+    });
+}
+
+std::string WebServer::ProcessRequest(const HttpRequest& http_request) {
+    if (http_request.method == "OPTIONS") {
+        return BuildResponse(204, nullptr, "");
+    }
+
+    const RouteHandler* handler = nullptr;
+    RouteParams params;
+    switch (router_.Find(http_request.method, http_request.path, handler, params)) {
+        case HttpRouter::Result::NotFound:
+            return CreateErrorResponse("Endpoint not found", 404);
+        case HttpRouter::Result::MethodNotAllowed:
+            return CreateErrorResponse("Method not allowed", 405);
+        case HttpRouter::Result::Found:
+            break;
+    }
+
+    if (!params.valid()) {
+        return CreateErrorResponse("Invalid " + std::string(params.invalid_name()) + " number", 400);
     }
+    return (*handler)(http_request, params);
+}
+
+std::string WebServer::ServeVersioned(const HttpRequest& request, VersionedResponse& cache,
+                                      std::string (WebServer::*build_body)()) {
+    // Read the version first so the body built below is never older than its ETag
+    uint64_t version = ndi_manager_->GetStateVersion();
+    std::string etag = "\"" + etag_prefix_ + std::to_string(version) + "\"";
+
+    if (IfNoneMatch(request.Header("If-None-Match"), etag)) {
+        return BuildResponse(304, nullptr, "", "ETag: " + etag + "\r\nCache-Control: no-cache\r\n");
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (cache.valid && cache.version == version) {
+            return cache.response;
+        }
+    }
+
+    std::string response = BuildResponse(200, "application/json", (this->*build_body)(),
+                                         "ETag: " + etag + "\r\nCache-Control: no-cache\r\n");
+    {
+        std::lock_guard<std::mutex> lock(cache.mutex);
+        if (!cache.valid || version >= cache.version) {
+            cache.valid = true;
+            cache.version = version;
+            cache.response = response;
+        }
+    }
+    return response;
+}
+
+std::string WebServer::HandleGetSources() {
+    LOG_DEBUG("Handling GET /api/sources request");
+    auto table = ndi_manager_->GetSourceTable();
     
-    json << "]";
+    JsonWriter& json = ResponseWriter();
+    WriteJsonArray(json, table->sources);
     return json.str();
 }
 
 std::string WebServer::HandleGetMatrixRoutes() {
-    auto routes = ndi_manager_->GetMatrixRoutes();
-    std::ostringstream json;
-    json << "[";
-    
-    for (size_t i = 0; i < routes.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{\"id\":\"" << routes[i].id << "\",\"sourceSlot\":" << routes[i].source_slot
-             << ",\"destinationSlot\":" << routes[i].destination_slot
-             << ",\"active\":" << (routes[i].is_active ? "true" : "false") << "}";
-    }
-    
-    json << "]";
+    JsonWriter& json = ResponseWriter();
+    WriteJsonArray(json, ndi_manager_->GetMatrixRoutes());
     return json.str();
 }
 
 std::string WebServer::HandleGetStudioMonitors() {
-    auto studio_monitors = ndi_manager_->DiscoverStudioMonitors();
-    std::ostringstream json;
-    json << "[";
-    
-    for (size_t i = 0; i < studio_monitors.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{\"name\":\"" << studio_monitors[i].name << "\",\"url\":\"" << studio_monitors[i].url 
-             << "\",\"connected\":" << (studio_monitors[i].is_connected ? "true" : "false") << "}";
-    }
-    
-    json << "]";
+    auto table = ndi_manager_->GetSourceTable();
+    JsonWriter& json = ResponseWriter();
+    WriteJsonArray(json, table->studio_monitors);
     return json.str();
 }
 
 std::string WebServer::HandleResetStudioMonitors() {
-    auto studio_monitors = ndi_manager_->DiscoverStudioMonitors();
+    auto table = ndi_manager_->GetSourceTable();
+    const auto& studio_monitors = table->studio_monitors;
     
     // For each studio monitor, we would send a command to set their source to "None"
     // Since this is a demonstration and we can't actually control studio monitors directly,
     // we'll return the list of monitors that would be reset
-    std::ostringstream json;
-    json << "{\"success\":true,\"message\":\"Studio monitors reset to None\",\"monitors\":[";
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject()
+        .Key("success").Bool(true)
+        .Key("message").String("Studio monitors reset to None")
+        .Key("monitors").BeginArray();
     
-    for (size_t i = 0; i < studio_monitors.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "\"" << studio_monitors[i].name << "\"";
+    for (const auto& monitor : studio_monitors) {
+        json.String(monitor.name);
     }
     
-    json << "],\"count\":" << studio_monitors.size() << "}";
+    json.EndArray().Key("count").UInt(studio_monitors.size()).EndObject();
     return json.str();
 }
 
 std::string WebServer::HandleGetMatrixSourceSlots() {
-    auto slots = ndi_manager_->GetSourceSlots();
-    std::ostringstream json;
-    json << "[";
-    
-    for (size_t i = 0; i < slots.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{\"slotNumber\":" << slots[i].slot_number
-             << ",\"assignedNdiSource\":\"" << slots[i].assigned_ndi_source << "\""
-             << ",\"displayName\":\"" << slots[i].display_name << "\""
-             << ",\"isAssigned\":" << (slots[i].is_assigned ? "true" : "false") << "}";
-    }
-    
-    json << "]";
+    JsonWriter& json = ResponseWriter();
+    WriteJsonArray(json, ndi_manager_->GetSourceSlots());
     return json.str();
 }
 
 std::string WebServer::HandleGetMatrixDestinations() {
-    auto destinations = ndi_manager_->GetMatrixDestinations();
-    std::ostringstream json;
-    json << "[";
-    
-    for (size_t i = 0; i < destinations.size(); ++i) {
-        if (i > 0) json << ",";
-        json << "{\"slotNumber\":" << destinations[i].slot_number
-             << ",\"name\":\"" << destinations[i].name << "\""
-             << ",\"description\":\"" << destinations[i].description << "\""
-             << ",\"enabled\":" << (destinations[i].is_enabled ? "true" : "false")
-             << ",\"currentSourceSlot\":" << destinations[i].current_source_slot << "}";
+    JsonWriter& json = ResponseWriter();
+    WriteJsonArray(json, ndi_manager_->GetMatrixDestinations());
+    return json.str();
+}
+
+std::string WebServer::HandleGetMatrixState() {
+    MatrixStateSnapshot state = ndi_manager_->GetMatrixState();
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("version").UInt(state.version).Key("sourceSlots");
+    WriteJsonArray(json, state.source_slots);
+    json.Key("destinations");
+    WriteJsonArray(json, state.destinations);
+    json.Key("routes");
+    WriteJsonArray(json, state.routes);
+    json.Key("studioMonitorSource").StringOrNull(state.studio_monitor_source)
+        .Key("previewSource").StringOrNull(state.preview_source)
+        .EndObject();
+    return json.str();
+}
+
+std::string WebServer::HandleGetMatrixChanges(uint64_t since_version) {
+    MatrixChanges changes = ndi_manager_->GetMatrixChangesSince(since_version);
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("version").UInt(changes.version).Key("since").UInt(since_version);
+    if (changes.resync) {
+        json.Key("resync").Bool(true).EndObject();
+        return json.str();
     }
-    
-    json << "]";
+
+    json.Key("resync").Bool(false).Key("sourceSlots");
+    WriteJsonArray(json, changes.source_slots);
+    json.Key("destinations");
+    WriteJsonArray(json, changes.destinations);
+    json.Key("removedDestinations");
+    WriteJsonArray(json, changes.removed_destinations);
+    json.Key("routes");
+    WriteJsonArray(json, changes.routes);
+    json.Key("removedRoutes");
+    WriteJsonArray(json, changes.removed_routes);
+    if (changes.studio_monitor_changed) {
+        json.Key("studioMonitorSource").StringOrNull(changes.studio_monitor_source);
+    }
+    if (changes.preview_changed) {
+        json.Key("previewSource").StringOrNull(changes.preview_source);
+    }
+    json.EndObject();
+    return json.str();
+}
+
+std::string WebServer::HandleGetMatrixSize() {
+    MatrixSize size = ndi_manager_->GetMatrixSize();
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject()
+        .Key("sourceSlots").Int(size.source_slots)
+        .Key("destinationSlots").Int(size.destination_slots)
+        .EndObject();
     return json.str();
 }
 
-std::string WebServer::HandleAssignSourceToSlot(const std::string& request_body) {
-    size_t slot_pos = request_body.find("\"slotNumber\":");
-    size_t source_pos = request_body.find("\"ndiSourceName\":\"");
-    size_t name_pos = request_body.find("\"displayName\":\"");
+std::string WebServer::HandleSetMatrixSize(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
+    }
     
-    if (slot_pos == std::string::npos || source_pos == std::string::npos) {
-        return "{\"error\":\"Invalid request format - missing slotNumber or ndiSourceName\"}";
+    // Either dimension may be left out to keep its current size
+    MatrixSize size = ndi_manager_->GetMatrixSize();
+    if ((body.Has("sourceSlots") && !body.GetInt("sourceSlots", size.source_slots)) ||
+        (body.Has("destinationSlots") && !body.GetInt("destinationSlots", size.destination_slots))) {
+        return ErrorMessage("Invalid request format - sourceSlots and destinationSlots must be integers");
     }
     
-    // Extract slot number
-    slot_pos += 13; // length of "slotNumber":
-    size_t slot_end = request_body.find(",", slot_pos);
-    if (slot_end == std::string::npos) slot_end = request_body.find("}", slot_pos);
-    int slot_num = std::stoi(request_body.substr(slot_pos, slot_end - slot_pos));
+    if (!ndi_manager_->SetMatrixSize(size.source_slots, size.destination_slots)) {
+        return ErrorMessage("Failed to resize matrix - size out of range or a slot beyond it is in use");
+    }
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject()
+        .Key("success").Bool(true)
+        .Key("sourceSlots").Int(size.source_slots)
+        .Key("destinationSlots").Int(size.destination_slots)
+        .EndObject();
+    return json.str();
+}
+
+std::string WebServer::HandleAssignSourceToSlot(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
+    }
     
-    // Extract NDI source name
-    source_pos += 17; // length of "ndiSourceName":"
-    size_t source_end = request_body.find("\"", source_pos);
-    std::string ndi_source = request_body.substr(source_pos, source_end - source_pos);
+    int slot_num = 0;
+    std::string ndi_source;
+    if (!body.GetInt("slotNumber", slot_num) || !body.GetString("ndiSourceName", ndi_source)) {
+        return ErrorMessage("Invalid request format - missing slotNumber or ndiSourceName");
+    }
     
-    // Extract display name (optional)
-    std::string display_name = "Slot " + std::to_string(slot_num);
-    if (name_pos != std::string::npos) {
-        name_pos += 16; // length of "displayName":"
-        size_t name_end = request_body.find("\"", name_pos);
-        if (name_end != std::string::npos) {
-            display_name = request_body.substr(name_pos, name_end - name_pos);
-        }
+    // Display name is optional
+    std::string display_name;
+    if (!body.GetString("displayName", display_name)) {
+        display_name = "Slot " + std::to_string(slot_num);
     }
     
     if (ndi_manager_->AssignSourceToSlot(slot_num, ndi_source, display_name)) {
-        return "{\"success\":true,\"message\":\"Source assigned to slot successfully\"}";
+        return SuccessMessage("Source assigned to slot successfully");
     } else {
-        return "{\"error\":\"Failed to assign source to slot\"}";
+        return ErrorMessage("Failed to assign source to slot");
     }
 }
 
 std::string WebServer::HandleUnassignSourceSlot(int slot_number) {
     try {
-        std::cout << "=== WEB SERVER: Handling unassign source slot request for slot " << slot_number << " ===" << std::endl;
-        std::cout << "WEB SERVER: About to call ndi_manager_->UnassignSourceSlot(" << slot_number << ")" << std::endl;
+        LOG_DEBUG("Handling unassign source slot request for slot " << slot_number);
+        LOG_DEBUG("About to call ndi_manager_->UnassignSourceSlot(" << slot_number << ")");
         
         bool result = ndi_manager_->UnassignSourceSlot(slot_number);
         
-        std::cout << "WEB SERVER: UnassignSourceSlot returned: " << (result ? "true" : "false") << std::endl;
+        LOG_DEBUG("UnassignSourceSlot returned: " << (result ? "true" : "false"));
         
         if (result) {
-            std::cout << "WEB SERVER: Source slot " << slot_number << " unassigned successfully" << std::endl;
-            return "{\"success\":true,\"message\":\"Source slot unassigned successfully\"}";
+            LOG_DEBUG("Source slot " << slot_number << " unassigned successfully");
+            return SuccessMessage("Source slot unassigned successfully");
         } else {
-            std::cout << "WEB SERVER: Failed to unassign source slot " << slot_number << std::endl;
-            return "{\"error\":\"Failed to unassign source slot\"}";
+            LOG_WARN("Failed to unassign source slot " << slot_number);
+            return ErrorMessage("Failed to unassign source slot");
         }
     } catch (const std::exception& e) {
-        std::cout << "=== WEB SERVER ERROR in HandleUnassignSourceSlot: " << e.what() << " ===" << std::endl;
-        return "{\"error\":\"Server error during unassign\"}";
+        LOG_ERROR("HandleUnassignSourceSlot failed: " << e.what());
+        return ErrorMessage("Server error during unassign");
     } catch (...) {
-        std::cout << "=== WEB SERVER UNKNOWN ERROR in HandleUnassignSourceSlot ===" << std::endl;
-        return "{\"error\":\"Unknown server error during unassign\"}";
+        LOG_ERROR("Unknown error in HandleUnassignSourceSlot");
+        return ErrorMessage("Unknown server error during unassign");
     }
 }
 
-std::string WebServer::HandleCreateMatrixRoute(const std::string& request_body) {
-    size_t source_pos = request_body.find("\"sourceSlot\":");
-    size_t dest_pos = request_body.find("\"destinationSlot\":");
-    
-    if (source_pos == std::string::npos || dest_pos == std::string::npos) {
-        return "{\"error\":\"Invalid request format - missing sourceSlot or destinationSlot\"}";
+std::string WebServer::HandleCreateMatrixRoute(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    // Extract source slot
-    source_pos += 13; // length of "sourceSlot":
-    size_t source_end = request_body.find(",", source_pos);
-    if (source_end == std::string::npos) source_end = request_body.find("}", source_pos);
-    int source_slot = std::stoi(request_body.substr(source_pos, source_end - source_pos));
-    
-    // Extract destination slot
-    dest_pos += 18; // length of "destinationSlot":
-    size_t dest_end = request_body.find(",", dest_pos);
-    if (dest_end == std::string::npos) dest_end = request_body.find("}", dest_pos);
-    int dest_slot = std::stoi(request_body.substr(dest_pos, dest_end - dest_pos));
+    int source_slot = 0;
+    int dest_slot = 0;
+    if (!body.GetInt("sourceSlot", source_slot) || !body.GetInt("destinationSlot", dest_slot)) {
+        return ErrorMessage("Invalid request format - missing sourceSlot or destinationSlot");
+    }
     
     if (ndi_manager_->CreateMatrixRoute(source_slot, dest_slot)) {
-        return "{\"success\":true,\"message\":\"Matrix route created successfully\"}";
+        return SuccessMessage("Matrix route created successfully");
     } else {
-        return "{\"error\":\"Failed to create matrix route\"}";
+        return ErrorMessage("Failed to create matrix route");
     }
 }
 
 
-std::string WebServer::HandleCreateMatrixDestination(const std::string& request_body) {
-    size_t name_pos = request_body.find("\"name\":\"");
-    size_t desc_pos = request_body.find("\"description\":\"");
-    
-    if (name_pos == std::string::npos) {
-        return "{\"error\":\"Missing name field\"}";
+std::string WebServer::HandleCreateMatrixDestination(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    name_pos += 8;
-    size_t name_end = request_body.find("\"", name_pos);
-    
-    if (name_end == std::string::npos) {
-        return "{\"error\":\"Invalid name format\"}";
+    std::string name;
+    if (!body.Has("name")) {
+        return ErrorMessage("Missing name field");
+    }
+    if (!body.GetString("name", name)) {
+        return ErrorMessage("Invalid name format");
     }
     
-    std::string name = request_body.substr(name_pos, name_end - name_pos);
-    std::string description = "";
+    // Description is optional
+    std::string description;
+    body.GetString("description", description);
     
-    if (desc_pos != std::string::npos) {
-        desc_pos += 14;
-        size_t desc_end = request_body.find("\"", desc_pos);
-        if (desc_end != std::string::npos) {
-            description = request_body.substr(desc_pos, desc_end - desc_pos);
+    // A frame rate puts the destination on a fixed output clock
+    OutputClock output_clock;
+    if (body.Has("frameRateN") || body.Has("frameRateD")) {
+        output_clock.enabled = true;
+        output_clock.frame_rate_D = 1;
+        if (!body.GetInt("frameRateN", output_clock.frame_rate_N) ||
+            (body.Has("frameRateD") && !body.GetInt("frameRateD", output_clock.frame_rate_D))) {
+            return ErrorMessage("Invalid frame rate format");
+        }
+        if (body.Has("audioSampleRate") && !body.GetInt("audioSampleRate", output_clock.audio_sample_rate)) {
+            return ErrorMessage("Invalid audio sample rate format");
         }
     }
     
-    if (ndi_manager_->CreateMatrixDestination(name, description)) {
-        return "{\"success\":true,\"message\":\"Matrix destination created successfully\"}";
+    if (ndi_manager_->CreateMatrixDestination(name, description, output_clock)) {
+        return SuccessMessage("Matrix destination created successfully");
     } else {
-        return "{\"error\":\"Failed to create matrix destination\"}";
+        return ErrorMessage("Failed to create matrix destination");
     }
 }
 
 std::string WebServer::HandleRemoveMatrixDestination(int slot_number) {
     if (ndi_manager_->RemoveMatrixDestination(slot_number)) {
-        return "{\"success\":true,\"message\":\"Matrix destination removed successfully\"}";
+        return SuccessMessage("Matrix destination removed successfully");
     } else {
-        return "{\"error\":\"Failed to remove matrix destination\"}";
+        return ErrorMessage("Failed to remove matrix destination");
     }
 }
 
-std::string WebServer::HandleRemoveMatrixRoute(const std::string& request_body) {
-    size_t source_pos = request_body.find("\"sourceSlot\":");
-    size_t dest_pos = request_body.find("\"destinationSlot\":");
-    
-    if (source_pos == std::string::npos || dest_pos == std::string::npos) {
-        return "{\"error\":\"Invalid request format - missing sourceSlot or destinationSlot\"}";
+std::string WebServer::HandleRemoveMatrixRoute(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    // Extract source slot
-    source_pos += 13; // length of "sourceSlot":
-    size_t source_end = request_body.find(",", source_pos);
-    if (source_end == std::string::npos) source_end = request_body.find("}", source_pos);
-    int source_slot = std::stoi(request_body.substr(source_pos, source_end - source_pos));
-    
-    // Extract destination slot
-    dest_pos += 18; // length of "destinationSlot":
-    size_t dest_end = request_body.find(",", dest_pos);
-    if (dest_end == std::string::npos) dest_end = request_body.find("}", dest_pos);
-    int dest_slot = std::stoi(request_body.substr(dest_pos, dest_end - dest_pos));
+    int source_slot = 0;
+    int dest_slot = 0;
+    if (!body.GetInt("sourceSlot", source_slot) || !body.GetInt("destinationSlot", dest_slot)) {
+        return ErrorMessage("Invalid request format - missing sourceSlot or destinationSlot");
+    }
     
     if (ndi_manager_->RemoveMatrixRoute(source_slot, dest_slot)) {
-        return "{\"success\":true,\"message\":\"Matrix route removed successfully\"}";
+        return SuccessMessage("Matrix route removed successfully");
     } else {
-        return "{\"error\":\"Failed to remove matrix route\"}";
+        return ErrorMessage("Failed to remove matrix route");
     }
 }
 
 std::string WebServer::HandleUnassignDestination(int destination_slot) {
-    std::cout << "Handling unassign destination request for slot " << destination_slot << std::endl;
+    LOG_DEBUG("Handling unassign destination request for slot " << destination_slot);
     if (ndi_manager_->UnassignDestination(destination_slot)) {
-        std::cout << "Destination slot " << destination_slot << " unassigned successfully" << std::endl;
-        return "{\"success\":true,\"message\":\"Destination unassigned successfully\"}";
+        LOG_DEBUG("Destination slot " << destination_slot << " unassigned successfully");
+        return SuccessMessage("Destination unassigned successfully");
     } else {
-        std::cout << "Failed to unassign destination slot " << destination_slot << std::endl;
-        return "{\"error\":\"Failed to unassign destination\"}";
+        LOG_WARN("Failed to unassign destination slot " << destination_slot);
+        return ErrorMessage("Failed to unassign destination");
     }
 }
 
-std::string WebServer::HandleSetStudioMonitorSource(const std::string& request_body) {
-    std::cout << "Handling set studio monitor source request" << std::endl;
+std::string WebServer::HandleSetStudioMonitorSource(std::string_view request_body) {
+    LOG_DEBUG("Handling set studio monitor source request");
     
-    // Parse JSON to extract source name
-    size_t name_pos = request_body.find("\"sourceName\":");
-    if (name_pos == std::string::npos) {
-        return "{\"error\":\"Missing sourceName field\"}";
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    name_pos = request_body.find("\"", name_pos + 13);
-    if (name_pos == std::string::npos) {
-        return "{\"error\":\"Invalid sourceName format\"}";
+    std::string source_name;
+    if (!body.Has("sourceName")) {
+        return ErrorMessage("Missing sourceName field");
     }
-    
-    size_t name_end = request_body.find("\"", name_pos + 1);
-    if (name_end == std::string::npos) {
-        return "{\"error\":\"Invalid sourceName format\"}";
+    if (!body.GetString("sourceName", source_name)) {
+        return ErrorMessage("Invalid sourceName format");
     }
     
-    std::string source_name = request_body.substr(name_pos + 1, name_end - name_pos - 1);
-    
     if (ndi_manager_->SetStudioMonitorSource(source_name)) {
-        return "{\"success\":true,\"message\":\"Studio monitor source set successfully\"}";
+        return SuccessMessage("Studio monitor source set successfully");
     } else {
-        return "{\"error\":\"Failed to set studio monitor source\"}";
+        return ErrorMessage("Failed to set studio monitor source");
     }
 }
 
 std::string WebServer::HandleGetStudioMonitorSource() {
-    std::string current_source = ndi_manager_->GetStudioMonitorSource();
-    if (current_source.empty()) {
-        return "{\"source\":null}";
-    } else {
-        return "{\"source\":\"" + current_source + "\"}";
-    }
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("source").StringOrNull(ndi_manager_->GetStudioMonitorSource()).EndObject();
+    return json.str();
 }
 
 // Preview API Handlers
-std::string WebServer::HandleSetPreviewSource(const std::string& request_body) {
-    std::cout << "Handling set preview source request" << std::endl;
+std::string WebServer::HandleSetPreviewSource(std::string_view request_body) {
+    LOG_DEBUG("Handling set preview source request");
     
-    // Parse JSON to extract source name
-    size_t name_pos = request_body.find("\"sourceName\":");
-    if (name_pos == std::string::npos) {
-        return "{\"error\":\"Missing sourceName field\"}";
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    name_pos = request_body.find("\"", name_pos + 13);
-    if (name_pos == std::string::npos) {
-        return "{\"error\":\"Invalid sourceName format\"}";
+    std::string source_name;
+    if (!body.Has("sourceName")) {
+        return ErrorMessage("Missing sourceName field");
     }
-    
-    size_t name_end = request_body.find("\"", name_pos + 1);
-    if (name_end == std::string::npos) {
-        return "{\"error\":\"Invalid sourceName format\"}";
+    if (!body.GetString("sourceName", source_name)) {
+        return ErrorMessage("Invalid sourceName format");
     }
     
-    std::string source_name = request_body.substr(name_pos + 1, name_end - name_pos - 1);
-    
     if (ndi_manager_->SetPreviewSource(source_name)) {
-        return "{\"success\":true,\"message\":\"Preview source set to " + source_name + "\"}";
+        return SuccessMessage("Preview source set to " + source_name);
     } else {
-        return "{\"error\":\"Failed to set preview source\"}";
+        return ErrorMessage("Failed to set preview source");
     }
 }
 
 std::string WebServer::HandleGetPreviewSource() {
-    std::string current_source = ndi_manager_->GetPreviewSource();
-    if (current_source.empty()) {
-        return "{\"source\":null}";
-    } else {
-        return "{\"source\":\"" + current_source + "\"}";
-    }
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("source").StringOrNull(ndi_manager_->GetPreviewSource()).EndObject();
+    return json.str();
 }
 
 std::string WebServer::HandleGetPreviewImage() {
-    std::string image_data = ndi_manager_->GetPreviewImage();
-    if (image_data.empty()) {
-        return "{\"image\":null}";
-    } else {
-        return "{\"image\":\"" + image_data + "\"}";
-    }
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("image").StringOrNull(ndi_manager_->GetPreviewImage()).EndObject();
+    return json.str();
 }
 
 std::string WebServer::HandleClearPreview() {
     ndi_manager_->ClearPreviewSource();
-    return "{\"success\":true,\"message\":\"Preview cleared\"}";
+    return SuccessMessage("Preview cleared");
 }
 
 // Bulk routing operations
-std::string WebServer::HandleCreateMultipleRoutes(const std::string& request_body) {
-    size_t source_pos = request_body.find("\"sourceSlot\":");
-    size_t dest_array_pos = request_body.find("\"destinationSlots\":");
-    
-    if (source_pos == std::string::npos || dest_array_pos == std::string::npos) {
-        return "{\"error\":\"Invalid request format - missing sourceSlot or destinationSlots\"}";
+std::string WebServer::HandleCreateMultipleRoutes(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    // Extract source slot
-    source_pos += 13; // length of "sourceSlot":
-    size_t source_end = request_body.find(",", source_pos);
-    if (source_end == std::string::npos) source_end = request_body.find("}", source_pos);
-    int source_slot = std::stoi(request_body.substr(source_pos, source_end - source_pos));
+    int source_slot = 0;
+    if (!body.GetInt("sourceSlot", source_slot) || !body.Has("destinationSlots")) {
+        return ErrorMessage("Invalid request format - missing sourceSlot or destinationSlots");
+    }
     
-    // Extract destination slots array
-    dest_array_pos += 19; // length of "destinationSlots":
-    size_t array_start = request_body.find("[", dest_array_pos);
-    size_t array_end = request_body.find("]", array_start);
+    std::vector<int> destination_slots;
+    if (!body.GetIntArray("destinationSlots", destination_slots)) {
+        return ErrorMessage("Invalid destinationSlots array format");
+    }
     
-    if (array_start == std::string::npos || array_end == std::string::npos) {
-        return "{\"error\":\"Invalid destinationSlots array format\"}";
+    if (ndi_manager_->CreateMultipleRoutes(source_slot, destination_slots)) {
+        return SuccessMessage("Created " + std::to_string(destination_slots.size()) +
+                              " routes from source slot " + std::to_string(source_slot));
+    } else {
+        return ErrorMessage("Failed to create some or all routes");
+    }
+}
+
+std::string WebServer::HandleApplySalvo(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
     }
     
-    std::string array_content = request_body.substr(array_start + 1, array_end - array_start - 1);
-    std::vector<int> destination_slots;
+    std::vector<JsonReader> items;
+    if (!body.GetObjectArray("crosspoints", items)) {
+        return ErrorMessage("Invalid request format - crosspoints must be an array of objects");
+    }
     
-    // Parse the comma-separated destination slot numbers
-    std::istringstream ss(array_content);
-    std::string token;
-    while (std::getline(ss, token, ',')) {
-        // Remove whitespace
-        token.erase(0, token.find_first_not_of(" \t"));
-        token.erase(token.find_last_not_of(" \t") + 1);
-        if (!token.empty()) {
-            destination_slots.push_back(std::stoi(token));
+    std::vector<Crosspoint> crosspoints(items.size());
+    for (size_t i = 0; i < items.size(); ++i) {
+        // sourceSlot 0 clears the destination
+        if (!items[i].GetInt("sourceSlot", crosspoints[i].source_slot) ||
+            !items[i].GetInt("destinationSlot", crosspoints[i].destination_slot)) {
+            return ErrorMessage("Invalid request format - each crosspoint needs sourceSlot and destinationSlot");
         }
     }
     
-    if (ndi_manager_->CreateMultipleRoutes(source_slot, destination_slots)) {
-        std::ostringstream json;
-        json << "{\"success\":true,\"message\":\"Created " << destination_slots.size() 
-             << " routes from source slot " << source_slot << "\"}";
-        return json.str();
-    } else {
-        return "{\"error\":\"Failed to create some or all routes\"}";
+    std::vector<CrosspointResult> results;
+    bool applied = ndi_manager_->ApplySalvo(crosspoints, results);
+    
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("success").Bool(applied);
+    if (!applied) {
+        json.Key("error").String("Salvo not applied - one or more crosspoints are invalid");
+    }
+    json.Key("results").BeginArray();
+    for (const auto& result : results) {
+        json.BeginObject()
+            .Key("sourceSlot").Int(result.source_slot)
+            .Key("destinationSlot").Int(result.destination_slot)
+            .Key("changed").Bool(applied && result.changed);
+        if (!result.error.empty()) {
+            json.Key("error").String(result.error);
+        }
+        json.EndObject();
     }
+    json.EndArray().EndObject();
+    return json.str();
 }
 
 std::string WebServer::HandleRemoveAllRoutesFromSource(int source_slot) {
     if (ndi_manager_->RemoveAllRoutesFromSource(source_slot)) {
-        std::ostringstream json;
-        json << "{\"success\":true,\"message\":\"Removed all routes from source slot " 
-             << source_slot << "\"}";
-        return json.str();
+        return SuccessMessage("Removed all routes from source slot " + std::to_string(source_slot));
     } else {
-        return "{\"error\":\"No routes found for source slot or removal failed\"}";
+        return ErrorMessage("No routes found for source slot or removal failed");
     }
 }
 
 std::string WebServer::HandleGetDestinationsForSource(int source_slot) {
-    auto destinations = ndi_manager_->GetDestinationsForSource(source_slot);
-    std::ostringstream json;
-    json << "{\"sourceSlot\":" << source_slot << ",\"destinations\":[";
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("sourceSlot").Int(source_slot).Key("destinations");
+    WriteJsonArray(json, ndi_manager_->GetDestinationsForSource(source_slot));
+    json.EndObject();
+    return json.str();
+}
+
+std::string WebServer::HandleGetRoutingWorkers() {
+    auto workers = ndi_manager_->GetRoutingWorkerStats();
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject()
+        .Key("threadCount").UInt(workers.size())
+        .Key("maxWorkers").UInt(ndi_manager_->GetMaxSourceWorkers())
+        .Key("pendingSources").UInt(ndi_manager_->GetPendingSourceCount())
+        .Key("warmReceivers").UInt(ndi_manager_->GetWarmReceiverCount())
+        .Key("warmReceiverBudget").UInt(ndi_manager_->GetWarmReceiverBudget())
+        .Key("workers").BeginArray();
+    
+    for (const auto& worker : workers) {
+        json.BeginObject()
+            .Key("source").String(worker.source_name)
+            .Key("warm").Bool(worker.warm)
+            .Key("destinations").UInt(worker.destination_count)
+            .Key("loopIterations").UInt(worker.loop_iterations)
+            .Key("framesForwarded").UInt(worker.frames_forwarded)
+            .Key("lastLoopMs").Double(worker.last_loop_ms)
+            .Key("avgLoopMs").Double(worker.avg_loop_ms)
+            .Key("maxLoopMs").Double(worker.max_loop_ms)
+            .EndObject();
+    }
+    
+    json.EndArray().EndObject();
+    return json.str();
+}
+
+std::string WebServer::HandleGetMetrics() {
+    thread_local PrometheusWriter metrics;
+    metrics.Clear();
+    
+    auto workers = ndi_manager_->GetRoutingWorkerStats();
+    auto routes = ndi_manager_->GetRouteMetrics();
+    auto destinations = ndi_manager_->GetDestinationMetrics();
+    auto table = ndi_manager_->GetSourceTable();
+    
+    metrics.Family("ndi_router_state_version", "gauge", "Matrix state version")
+        .SampleInt("ndi_router_state_version", {}, ndi_manager_->GetStateVersion());
+    metrics.Family("ndi_router_discovered_sources", "gauge", "NDI sources announced on the network, excluding our outputs")
+        .SampleInt("ndi_router_discovered_sources", {}, table->sources.size());
+    metrics.Family("ndi_router_capture_workers", "gauge", "Capture worker threads running")
+        .SampleInt("ndi_router_capture_workers", {}, workers.size());
+    metrics.Family("ndi_router_pending_sources", "gauge", "Routed sources waiting for a capture worker")
+        .SampleInt("ndi_router_pending_sources", {}, ndi_manager_->GetPendingSourceCount());
+    metrics.Family("ndi_router_warm_receivers", "gauge", "Receivers kept connected for sources without a route")
+        .SampleInt("ndi_router_warm_receivers", {}, ndi_manager_->GetWarmReceiverCount());
+    metrics.Family("ndi_router_log_dropped_total", "counter", "Log lines dropped because the log queue was full")
+        .SampleInt("ndi_router_log_dropped_total", {}, Logger::Instance().dropped());
+    
+    // Per routed source (one capture worker each)
+    metrics.Family("ndi_router_source_destinations", "gauge", "Destinations fed by the source");
+    for (const auto& w : workers) {
+        metrics.SampleInt("ndi_router_source_destinations", {{"source", w.source_name}}, w.destination_count);
+    }
+    metrics.Family("ndi_router_source_frames_total", "counter", "Frames captured and fanned out");
+    for (const auto& w : workers) {
+        metrics.SampleInt("ndi_router_source_frames_total", {{"source", w.source_name}, {"type", "video"}}, w.video_frames);
+        metrics.SampleInt("ndi_router_source_frames_total", {{"source", w.source_name}, {"type", "audio"}}, w.audio_frames);
+    }
+    metrics.Family("ndi_router_source_audio_samples_total", "counter", "Audio samples per channel captured and fanned out");
+    for (const auto& w : workers) {
+        metrics.SampleInt("ndi_router_source_audio_samples_total", {{"source", w.source_name}}, w.audio_samples);
+    }
+    metrics.Family("ndi_router_source_dropped_frames_total", "counter", "Frames the receiver dropped (NDIlib_recv_get_performance)");
+    for (const auto& w : workers) {
+        metrics.SampleInt("ndi_router_source_dropped_frames_total", {{"source", w.source_name}, {"type", "video"}}, w.dropped_video_frames);
+        metrics.SampleInt("ndi_router_source_dropped_frames_total", {{"source", w.source_name}, {"type", "audio"}}, w.dropped_audio_frames);
+    }
+    metrics.Family("ndi_router_source_queue_depth", "gauge", "Frames waiting in the receiver queue");
+    for (const auto& w : workers) {
+        metrics.SampleInt("ndi_router_source_queue_depth", {{"source", w.source_name}, {"type", "video"}}, w.queued_video_frames);
+        metrics.SampleInt("ndi_router_source_queue_depth", {{"source", w.source_name}, {"type", "audio"}}, w.queued_audio_frames);
+    }
+    metrics.Family("ndi_router_source_fanout_seconds", "summary", "Capture return to fan-out complete, per frame");
+    for (const auto& w : workers) {
+        metrics.Sample("ndi_router_source_fanout_seconds_sum", {{"source", w.source_name}}, w.total_loop_ms / 1000.0);
+        metrics.SampleInt("ndi_router_source_fanout_seconds_count", {{"source", w.source_name}}, w.frames_forwarded);
+    }
+    metrics.Family("ndi_router_source_fanout_max_seconds", "gauge", "Longest capture return to fan-out complete");
+    for (const auto& w : workers) {
+        metrics.Sample("ndi_router_source_fanout_max_seconds", {{"source", w.source_name}}, w.max_loop_ms / 1000.0);
+    }
+    metrics.Family("ndi_router_source_loop_iteration_seconds", "summary", "Capture loop iteration including the wait for a frame");
+    for (const auto& w : workers) {
+        metrics.Sample("ndi_router_source_loop_iteration_seconds_sum", {{"source", w.source_name}}, w.total_iteration_ms / 1000.0);
+        metrics.SampleInt("ndi_router_source_loop_iteration_seconds_count", {{"source", w.source_name}}, w.loop_iterations);
+    }
+    
+    // Per route; counters restart when a destination is routed to a new source
+    std::vector<std::string> source_slots;
+    std::vector<std::string> destination_slots;
+    source_slots.reserve(routes.size());
+    destination_slots.reserve(routes.size());
+    for (const auto& r : routes) {
+        source_slots.push_back(std::to_string(r.source_slot));
+        destination_slots.push_back(std::to_string(r.destination_slot));
+    }
+    metrics.Family("ndi_router_route_info", "gauge", "Current routes, with the source and destination names");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        metrics.SampleInt("ndi_router_route_info",
+                          {{"source_slot", source_slots[i]}, {"destination_slot", destination_slots[i]},
+                           {"source", routes[i].source_name}, {"destination", routes[i].destination_name}}, 1);
+    }
+    metrics.Family("ndi_router_route_frames_total", "counter", "Frames sent on the route");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        metrics.SampleInt("ndi_router_route_frames_total",
+                          {{"source_slot", source_slots[i]}, {"destination_slot", destination_slots[i]}, {"type", "video"}},
+                          routes[i].video_frames);
+        metrics.SampleInt("ndi_router_route_frames_total",
+                          {{"source_slot", source_slots[i]}, {"destination_slot", destination_slots[i]}, {"type", "audio"}},
+                          routes[i].audio_frames);
+    }
+    metrics.Family("ndi_router_route_audio_samples_total", "counter", "Audio samples per channel sent on the route");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        metrics.SampleInt("ndi_router_route_audio_samples_total",
+                          {{"source_slot", source_slots[i]}, {"destination_slot", destination_slots[i]}}, routes[i].audio_samples);
+    }
+    // Quantiles cover the samples since the route was made or its latency was reset
+    const std::string send_latency = "ndi_router_route_send_latency_seconds";
+    metrics.Family(send_latency, "summary", "Capture return to send return, per frame");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        WriteRouteLatency(metrics, send_latency, source_slots[i], destination_slots[i], routes[i].send_latency);
+    }
+    metrics.Family("ndi_router_route_send_latency_max_seconds", "gauge", "Longest capture return to send return");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        metrics.Sample("ndi_router_route_send_latency_max_seconds",
+                       {{"source_slot", source_slots[i]}, {"destination_slot", destination_slots[i]}}, routes[i].send_latency.max_ms / 1000.0);
+    }
+    const std::string source_latency = "ndi_router_route_source_latency_seconds";
+    metrics.Family(source_latency, "summary", "Sender's NDI frame timestamp to send return, for frames that carry one");
+    for (size_t i = 0; i < routes.size(); ++i) {
+        WriteRouteLatency(metrics, source_latency, source_slots[i], destination_slots[i], routes[i].source_latency);
+    }
     
+    // Per destination (NDI sender)
+    std::vector<std::string> slots;
+    slots.reserve(destinations.size());
+    for (const auto& d : destinations) {
+        slots.push_back(std::to_string(d.slot_number));
+    }
+    metrics.Family("ndi_router_destination_connections", "gauge", "Receivers connected to the output (NDIlib_send_get_no_connections)");
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        metrics.Sample("ndi_router_destination_connections",
+                       {{"slot", slots[i]}, {"destination", destinations[i].name}}, destinations[i].connections);
+    }
+    metrics.Family("ndi_router_destination_frames_total", "counter", "Frames sent by the output, routed and slate");
     for (size_t i = 0; i < destinations.size(); ++i) {
-        if (i > 0) json << ",";
-        json << destinations[i];
+        const DestinationMetrics& d = destinations[i];
+        metrics.SampleInt("ndi_router_destination_frames_total",
+                          {{"slot", slots[i]}, {"destination", d.name}, {"type", "video"}}, d.video_frames);
+        metrics.SampleInt("ndi_router_destination_frames_total",
+                          {{"slot", slots[i]}, {"destination", d.name}, {"type", "audio"}}, d.audio_frames);
+    }
+    metrics.Family("ndi_router_destination_slate_frames_total", "counter", "Idle slate frames sent by the output");
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        metrics.SampleInt("ndi_router_destination_slate_frames_total",
+                          {{"slot", slots[i]}, {"destination", destinations[i].name}}, destinations[i].slate_frames);
+    }
+    metrics.Family("ndi_router_destination_cuts_total", "counter", "Times a newly routed source took the output over");
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        metrics.SampleInt("ndi_router_destination_cuts_total",
+                          {{"slot", slots[i]}, {"destination", destinations[i].name}}, destinations[i].cuts);
     }
     
-    json << "]}";
+    // Frame synchronizers, clocked destinations only
+    metrics.Family("ndi_router_destination_sync_frames_total", "counter",
+                   "Source frames the output clock showed again (repeated) or never showed (dropped)");
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        const DestinationMetrics& d = destinations[i];
+        if (!d.frame_sync) continue;
+        metrics.SampleInt("ndi_router_destination_sync_frames_total",
+                          {{"slot", slots[i]}, {"destination", d.name}, {"type", "repeated"}}, d.repeated_frames);
+        metrics.SampleInt("ndi_router_destination_sync_frames_total",
+                          {{"slot", slots[i]}, {"destination", d.name}, {"type", "dropped"}}, d.dropped_frames);
+    }
+    metrics.Family("ndi_router_destination_sync_late_ticks_total", "counter", "Output clock ticks missed by the output thread");
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        if (!destinations[i].frame_sync) continue;
+        metrics.SampleInt("ndi_router_destination_sync_late_ticks_total",
+                          {{"slot", slots[i]}, {"destination", destinations[i].name}}, destinations[i].late_ticks);
+    }
+    metrics.Family("ndi_router_destination_sync_audio_samples_total", "counter",
+                   "Audio samples per channel the output clock filled with silence (filled) or discarded (dropped)");
+    for (size_t i = 0; i < destinations.size(); ++i) {
+        const DestinationMetrics& d = destinations[i];
+        if (!d.frame_sync) continue;
+        metrics.SampleInt("ndi_router_destination_sync_audio_samples_total",
+                          {{"slot", slots[i]}, {"destination", d.name}, {"type", "filled"}}, d.audio_fill_samples);
+        metrics.SampleInt("ndi_router_destination_sync_audio_samples_total",
+                          {{"slot", slots[i]}, {"destination", d.name}, {"type", "dropped"}}, d.audio_dropped_samples);
+    }
+    
+    return metrics.str();
+}
+
+std::string WebServer::HandleGetRouteLatency() {
+    auto routes = ndi_manager_->GetRouteMetrics();
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("routes").BeginArray();
+    for (const auto& route : routes) {
+        json.BeginObject()
+            .Key("sourceSlot").Int(route.source_slot)
+            .Key("destinationSlot").Int(route.destination_slot)
+            .Key("source").String(route.source_name)
+            .Key("destination").String(route.destination_name)
+            .Key("sendLatency");
+        WriteJson(json, route.send_latency);
+        json.Key("sourceLatency");
+        WriteJson(json, route.source_latency);
+        json.EndObject();
+    }
+    json.EndArray().EndObject();
     return json.str();
 }
 
+std::string WebServer::HandleResetRouteLatency(std::string_view request_body) {
+    // An empty body resets every route
+    int destination_slot = 0;
+    if (!request_body.empty()) {
+        JsonReader body;
+        if (!body.Parse(request_body)) {
+            return ErrorMessage("Invalid JSON body");
+        }
+        if (body.Has("destinationSlot") && !body.GetInt("destinationSlot", destination_slot)) {
+            return ErrorMessage("Invalid destinationSlot format");
+        }
+    }
+    if (!ndi_manager_->ResetRouteLatency(destination_slot)) {
+        return ErrorMessage("No route to destination slot");
+    }
+    return SuccessMessage("Route latency reset");
+}
+
+std::string WebServer::HandleGetReceiveMode() {
+    bool passthrough = ndi_manager_->GetReceiveMode() == ReceiveMode::Passthrough;
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("mode").String(passthrough ? "passthrough" : "bgra").EndObject();
+    return json.str();
+}
+
+std::string WebServer::HandleSetReceiveMode(std::string_view request_body) {
+    JsonReader body;
+    if (!body.Parse(request_body)) {
+        return ErrorMessage("Invalid JSON body");
+    }
+    
+    std::string mode;
+    if (!body.Has("mode")) {
+        return ErrorMessage("Missing mode field");
+    }
+    if (!body.GetString("mode", mode)) {
+        return ErrorMessage("Invalid mode format");
+    }
+    
+    if (mode == "passthrough") {
+        ndi_manager_->SetReceiveMode(ReceiveMode::Passthrough);
+    } else if (mode == "bgra") {
+        ndi_manager_->SetReceiveMode(ReceiveMode::BGRA);
+    } else {
+        return ErrorMessage("Unknown mode, expected passthrough or bgra");
+    }
+    JsonWriter& json = ResponseWriter();
+    json.BeginObject().Key("success").Bool(true).Key("mode").String(mode).EndObject();
+    return json.str();
+}
+
+std::string WebServer::CreateJSONResponse(const std::string& data, int status_code) {
+    return BuildResponse(status_code, "application/json", data);
+}
+
+std::string WebServer::CreateErrorResponse(const std::string& error, int status_code) {
+    return BuildResponse(status_code, "application/json", ErrorMessage(error));
+}
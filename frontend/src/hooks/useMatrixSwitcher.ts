@@ -1,5 +1,6 @@
 import { useState, useEffect, useCallback } from 'react';
 import { NDIApi } from '@/lib/api';
+import { MatrixEvents } from '@/lib/events';
 import { useServerConnection } from './useServerConnection';
 import { 
   NDISource, 
@@ -20,6 +21,7 @@ export const useMatrixSwitcher = () => {
   const [routes, setRoutes] = useState<MatrixRoute[]>([]);
   const [loading, setLoading] = useState(false);
   const [error, setError] = useState<string | null>(null);
+  const [streamConnected, setStreamConnected] = useState(MatrixEvents.isConnected());
 
   // Fetch all data
   const fetchAllData = useCallback(async () => {
@@ -37,17 +39,16 @@ export const useMatrixSwitcher = () => {
     setError(null);
     
     try {
-      const [sourcesData, sourceSlotsData, destinationsData, routesData] = await Promise.all([
+      // Slots, destinations and routes come from one snapshot so they always agree
+      const [sourcesData, state] = await Promise.all([
         NDIApi.getSources(),
-        NDIApi.getMatrixSourceSlots(),
-        NDIApi.getMatrixDestinations(),
-        NDIApi.getMatrixRoutes()
+        NDIApi.getMatrixState()
       ]);
       
       setSources(sourcesData);
-      setSourceSlots(sourceSlotsData);
-      setDestinations(destinationsData);
-      setRoutes(routesData);
+      setSourceSlots(state.sourceSlots);
+      setDestinations(state.destinations);
+      setRoutes(state.routes);
     } catch (err) {
       console.error('Failed to fetch matrix data:', err);
       setError(err instanceof Error ? err.message : 'Failed to fetch matrix data');
@@ -266,16 +267,31 @@ export const useMatrixSwitcher = () => {
     }
   }, [isConnected, fetchAllData]);
 
-  // Auto-refresh data every 5 seconds
+  // Apply pushed state changes as they happen
+  useEffect(() => {
+    const unsubscribers = [
+      MatrixEvents.onStatus(setStreamConnected),
+      MatrixEvents.on('sources', data => setSources(data.sources)),
+      MatrixEvents.on('source-slots', setSourceSlots),
+      MatrixEvents.on('destinations', setDestinations),
+      MatrixEvents.on('routes', setRoutes),
+    ];
+    return () => unsubscribers.forEach(unsubscribe => unsubscribe());
+  }, []);
+
+  // Fetch everything on (re)connect; poll every 5 seconds only while the event stream is down
   useEffect(() => {
     fetchAllData();
+    if (streamConnected) {
+      return;
+    }
     
     const interval = setInterval(() => {
       fetchAllData();
     }, 5000);
     
     return () => clearInterval(interval);
-  }, [fetchAllData]);
+  }, [fetchAllData, streamConnected]);
 
   return {
     sources,
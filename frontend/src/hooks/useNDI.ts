@@ -1,6 +1,7 @@
 import { useState, useEffect, useCallback } from 'react';
 import { NDISource, NDIRoute, NDIDestination, CreateRouteRequest, CreateDestinationRequest } from '@/types/ndi';
 import { NDIApi } from '@/lib/api';
+import { MatrixEvents } from '@/lib/events';
 
 export const useNDI = () => {
   const [sources, setSources] = useState<NDISource[]>([]);
@@ -8,6 +9,7 @@ export const useNDI = () => {
   const [routes, setRoutes] = useState<NDIRoute[]>([]);
   const [loading, setLoading] = useState(false);
   const [error, setError] = useState<string | null>(null);
+  const [streamConnected, setStreamConnected] = useState(MatrixEvents.isConnected());
 
   const refreshSources = useCallback(async () => {
     try {
@@ -96,12 +98,27 @@ export const useNDI = () => {
     await Promise.all([refreshSources(), refreshDestinations(), refreshRoutes()]);
   }, [refreshSources, refreshDestinations, refreshRoutes]);
 
+  // Sources arrive pushed; route and destination events trigger a refetch
+  useEffect(() => {
+    const unsubscribers = [
+      MatrixEvents.onStatus(setStreamConnected),
+      MatrixEvents.on('sources', data => setSources(data.sources)),
+      MatrixEvents.on('routes', () => refreshRoutes()),
+      MatrixEvents.on('destinations', () => refreshDestinations()),
+    ];
+    return () => unsubscribers.forEach(unsubscribe => unsubscribe());
+  }, [refreshRoutes, refreshDestinations]);
+
+  // Poll only while the event stream is down
   useEffect(() => {
     refresh();
+    if (streamConnected) {
+      return;
+    }
     
     const interval = setInterval(refresh, 5000);
     return () => clearInterval(interval);
-  }, [refresh]);
+  }, [refresh, streamConnected]);
 
   return {
     sources,
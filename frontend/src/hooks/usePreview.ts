@@ -1,5 +1,6 @@
 import { useState, useEffect, useRef } from 'react';
 import { NDIApi } from '@/lib/api';
+import { MatrixEvents } from '@/lib/events';
 
 export const usePreview = () => {
   const [currentSource, setCurrentSource] = useState<string | null>(null);
@@ -24,6 +25,20 @@ export const usePreview = () => {
     loadCurrentSource();
   }, []);
 
+  // Follow preview source changes made from other stations
+  useEffect(() => {
+    return MatrixEvents.on('preview', data => {
+      if (data.source) {
+        setCurrentSource(data.source);
+        startImagePolling();
+      } else {
+        setCurrentSource(null);
+        setPreviewImage(null);
+        stopImagePolling();
+      }
+    });
+  }, []);
+
   const startImagePolling = () => {
     if (intervalRef.current) {
       clearInterval(intervalRef.current);
@@ -32,7 +47,7 @@ export const usePreview = () => {
     intervalRef.current = setInterval(async () => {
       try {
         const image = await NDIApi.getPreviewImage();
-        if (image && image !== 'FRAME_DATA_PLACEHOLDER') {
+        if (image) {
           setPreviewImage(image);
         }
       } catch (error) {
@@ -1,11 +1,13 @@
 import { useState, useEffect, useCallback, useRef } from 'react';
 import { NDIApi } from '@/lib/api';
+import { MatrixEvents } from '@/lib/events';
 
 export const useServerConnection = () => {
   const [isConnected, setIsConnected] = useState(false);
   const [isChecking, setIsChecking] = useState(true);
   const [lastConnected, setLastConnected] = useState<number | null>(null);
   const [error, setError] = useState<string | null>(null);
+  const [streamConnected, setStreamConnected] = useState(MatrixEvents.isConnected());
   const intervalRef = useRef<NodeJS.Timeout | null>(null);
 
   const checkConnection = useCallback(async () => {
@@ -33,8 +35,24 @@ export const useServerConnection = () => {
     }
   }, []);
 
-  // Start connection monitoring
+  // An open event stream proves the server is up
   useEffect(() => {
+    return MatrixEvents.onStatus(connected => {
+      setStreamConnected(connected);
+      if (connected) {
+        setIsConnected(true);
+        setLastConnected(Math.floor(Date.now() / 1000));
+        setError(null);
+      }
+    });
+  }, []);
+
+  // Start connection monitoring; health is only polled while the event stream is down
+  useEffect(() => {
+    if (streamConnected) {
+      return;
+    }
+
     // Initial check
     checkConnection();
     
@@ -47,7 +65,7 @@ export const useServerConnection = () => {
         intervalRef.current = null;
       }
     };
-  }, [checkConnection]);
+  }, [checkConnection, streamConnected]);
 
   // Manual reconnect function
   const reconnect = useCallback(() => {
@@ -1,5 +1,6 @@
 import { useState, useEffect } from 'react';
 import { NDIApi } from '@/lib/api';
+import { MatrixEvents } from '@/lib/events';
 
 export const useStudioMonitor = () => {
   const [currentSource, setCurrentSource] = useState<string | null>(null);
@@ -20,6 +21,14 @@ export const useStudioMonitor = () => {
     loadCurrentSource();
   }, []);
 
+  // Follow studio monitor changes made from other stations
+  useEffect(() => {
+    return MatrixEvents.on('studio-monitor', data => {
+      setCurrentSource(data.source);
+      setIsVisible(!!data.source);
+    });
+  }, []);
+
   const setStudioMonitorSource = async (sourceName: string) => {
     try {
       await NDIApi.setStudioMonitorSource(sourceName);
@@ -8,6 +8,7 @@ import {
   MatrixSourceSlot,
   MatrixDestination,
   MatrixRoute,
+  MatrixState,
   AssignSourceToSlotRequest,
   CreateMatrixDestinationRequest,
   CreateMatrixRouteRequest,
@@ -26,7 +27,7 @@ const getApiBaseUrl = () => {
   return `${protocol}//${hostname}:8080`;
 };
 
-const API_BASE_URL = getApiBaseUrl();
+export const API_BASE_URL = getApiBaseUrl();
 
 const api = axios.create({
   baseURL: API_BASE_URL,
@@ -122,6 +123,16 @@ export class NDIApi {
   }
 
   // Matrix Switcher API Methods
+  static async getMatrixState(): Promise<MatrixState> {
+    try {
+      const response = await api.get('/api/matrix/state');
+      return response.data;
+    } catch (error) {
+      console.error('Failed to fetch matrix state:', error);
+      throw new Error('Failed to fetch matrix state');
+    }
+  }
+
   static async getMatrixSourceSlots(): Promise<MatrixSourceSlot[]> {
     try {
       const response = await api.get('/api/matrix/source-slots');
@@ -0,0 +1,81 @@
+import { API_BASE_URL } from './api';
+
+// Matrix state pushed by GET /api/events. One EventSource is shared by every
+// hook and closed when the last subscriber goes away.
+export type MatrixEventName =
+  | 'sources'
+  | 'source-slots'
+  | 'destinations'
+  | 'routes'
+  | 'studio-monitor'
+  | 'preview';
+
+type EventHandler = (data: any) => void;
+type StatusHandler = (connected: boolean) => void;
+
+const eventHandlers = new Map<MatrixEventName, Set<EventHandler>>();
+const statusHandlers = new Set<StatusHandler>();
+let source: EventSource | null = null;
+let connected = false;
+
+const setConnected = (value: boolean) => {
+  if (connected === value) return;
+  connected = value;
+  statusHandlers.forEach(handler => handler(value));
+};
+
+const dispatch = (name: MatrixEventName) => (event: MessageEvent) => {
+  try {
+    const data = JSON.parse(event.data);
+    eventHandlers.get(name)?.forEach(handler => handler(data));
+  } catch (err) {
+    console.error(`Invalid ${name} event:`, err);
+  }
+};
+
+const ensureSource = () => {
+  if (source || typeof EventSource === 'undefined') return;
+
+  source = new EventSource(`${API_BASE_URL}/api/events`);
+  source.onopen = () => setConnected(true);
+  // EventSource reconnects on its own; subscribers fall back to polling meanwhile
+  source.onerror = () => setConnected(false);
+  const names: MatrixEventName[] = ['sources', 'source-slots', 'destinations', 'routes', 'studio-monitor', 'preview'];
+  names.forEach(name => source!.addEventListener(name, dispatch(name) as EventListener));
+};
+
+const releaseSource = () => {
+  const subscribers = statusHandlers.size +
+    Array.from(eventHandlers.values()).reduce((count, handlers) => count + handlers.size, 0);
+  if (subscribers === 0 && source) {
+    source.close();
+    source = null;
+    setConnected(false);
+  }
+};
+
+export const MatrixEvents = {
+  isConnected: () => connected,
+
+  on(name: MatrixEventName, handler: EventHandler): () => void {
+    if (!eventHandlers.has(name)) {
+      eventHandlers.set(name, new Set());
+    }
+    eventHandlers.get(name)!.add(handler);
+    ensureSource();
+    return () => {
+      eventHandlers.get(name)?.delete(handler);
+      releaseSource();
+    };
+  },
+
+  // Called on every connect and disconnect of the stream
+  onStatus(handler: StatusHandler): () => void {
+    statusHandlers.add(handler);
+    ensureSource();
+    return () => {
+      statusHandlers.delete(handler);
+      releaseSource();
+    };
+  },
+};
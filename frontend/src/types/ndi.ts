@@ -18,6 +18,10 @@ export interface MatrixDestination {
   description: string;
   enabled: boolean;
   currentSourceSlot: number; // 0 means no source assigned
+  frameSync: boolean; // Re-timed to a fixed output clock
+  frameRateN?: number; // Output clock, present when frameSync is set
+  frameRateD?: number;
+  audioSampleRate?: number;
 }
 
 export interface MatrixRoute {
@@ -27,9 +31,22 @@ export interface MatrixRoute {
   active: boolean;
 }
 
+// GET /api/matrix/state: one consistent snapshot
+export interface MatrixState {
+  version: number;
+  sourceSlots: MatrixSourceSlot[];
+  destinations: MatrixDestination[];
+  routes: MatrixRoute[];
+  studioMonitorSource: string | null;
+  previewSource: string | null;
+}
+
 export interface CreateMatrixDestinationRequest {
   name: string;
   description?: string;
+  frameRateN?: number; // Setting a frame rate enables the frame synchronizer
+  frameRateD?: number;
+  audioSampleRate?: number;
 }
 
 export interface AssignSourceToSlotRequest {